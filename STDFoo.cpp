@@ -1,14 +1,24 @@
 // with recent compiler (default: C++17 or up)
 // g++ -O3 -DNDEBUG -o STDFoo.exe -static STDFoo.cpp -lz
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <condition_variable>
+#include <cstring>  // memcpy
+#include <deque>
 #include <fstream>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <list>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <random>
 #include <set>
 #include <sstream>
-#include <string>  // memcpy
+#include <string>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
@@ -16,17 +26,34 @@
 #ifndef NO_LIBZ
 #include <zlib.h>
 #endif
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef WITH_LZ4
+#include <lz4frame.h>
+#endif
 #include <stdint.h>
 #include <stdlib.h>
 
 #include <cassert>
 #include <string>
 #include <type_traits>  // std::is_same<T1,T2>::value
+
+#include "STDFooCodec.hpp"
+#include "STDFooInflate.hpp"
+#include "STDFooReader.hpp"
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>  // getrusage
+#include <unistd.h>
+#endif
 using std::cerr;
 using std::cout;
 using std::endl;
 using std::string;
-void fail(const char *msg) {
+[[noreturn]] void fail(const char *msg) {
     cerr << msg << endl;
     cerr << "exiting" << endl;
     exit(EXIT_FAILURE);
@@ -43,6 +70,21 @@ static T decode(unsigned char *&ptr) {
     return retval;
 }
 
+//* extracts an STDF string (length byte, then characters). Empty string returns "null" */
+static string decodeString(unsigned char *&ptr) {
+    // note: STDF string may use less space than advertised by len byte, if null-terminated
+    char buf[255 + 1];
+    uint8_t len = *(ptr++);
+    for (unsigned int ix = 0; ix < len; ++ix) {
+        buf[ix] = *(ptr++);
+    }
+    buf[len] = 0;
+    if (buf[0] == 0)
+        return std::string("null");
+    else
+        return std::string(&buf[0]);
+}
+
 // check for C++ standard
 #define PRE_CPP17 (__cplusplus < 201703L)
 
@@ -50,19 +92,52 @@ static T decode(unsigned char *&ptr) {
 // === Directory creation ===
 // ==========================
 // Note: could omit the std::filesystem variant entirely as POSIX works just fine but it seems cleaner in the long run
-#ifdef PRE_CPP17
+#if PRE_CPP17
+#include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 static void createDirectory(string dirname) {
     struct stat st = {0};
     if (stat(dirname.c_str(), &st) == -1) {
+#ifdef _WIN32
         int val = mkdir(dirname.c_str());
+#else
+        int val = mkdir(dirname.c_str(), 0777);
+#endif
         if (val != 0) {
             fail("directory creation failed");
         }
     }
 }
+
+//* returns the names (not paths) of all regular entries in a directory */
+static std::vector<string> listDirectory(string dirname) {
+    std::vector<string> retVal;
+    DIR *d = opendir(dirname.c_str());
+    if (!d)
+        return retVal;
+    while (struct dirent *e = readdir(d)) {
+        string name(e->d_name);
+        if ((name != ".") && (name != ".."))
+            retVal.push_back(name);
+    }
+    closedir(d);
+    return retVal;
+}
+
+//* deletes a directory with its (flat) contents */
+static void removeDirectory(string dirname) {
+    std::vector<string> names = listDirectory(dirname);
+    for (auto it = names.begin(); it != names.end(); ++it)
+        remove((dirname + "/" + *it).c_str());
+    rmdir(dirname.c_str());
+}
+
+//* renames src to dest, replacing dest if it exists (atomic on POSIX). Returns false on failure */
+static bool replaceFile(string src, string dest) {
+    return rename(src.c_str(), dest.c_str()) == 0;
+}
 #else
 #include <filesystem>
 static void createDirectory(string dirname) {
@@ -70,6 +145,28 @@ static void createDirectory(string dirname) {
     // e.g. -lstdc++fs or -lc++fs.
     std::filesystem::create_directory(dirname);
 }
+
+//* returns the names (not paths) of all regular entries in a directory */
+static std::vector<string> listDirectory(string dirname) {
+    std::vector<string> retVal;
+    std::error_code ec;
+    for (auto &e : std::filesystem::directory_iterator(dirname, ec))
+        retVal.push_back(e.path().filename().string());
+    return retVal;
+}
+
+//* deletes a directory with its (flat) contents */
+static void removeDirectory(string dirname) {
+    std::error_code ec;
+    std::filesystem::remove_all(dirname, ec);
+}
+
+//* renames src to dest, replacing dest if it exists (atomic on POSIX). Returns false on failure */
+static bool replaceFile(string src, string dest) {
+    std::error_code ec;
+    std::filesystem::rename(src, dest, ec);
+    return !ec;
+}
 #endif
 
 // ===============
@@ -104,8 +201,27 @@ class circBuf {
     /** after preparing data entry with "getLargestPossiblePush" and copying the data, register the data here */
     void reportPush(unsigned int n) {
         assert(n <= this->nCirc - this->nData);
-        assert(n <= this->nCirc + this->nContigRead - 1 - this->ixPush);
+        this->advancePush(n);
+        this->nData += n;
+    }
+
+    //* returns max. number of bytes to take from data, to be reported afterwards via reportPop() */
+    void getLargestPossiblePop(unsigned int *nBytesMax, unsigned char **src) {
+        *nBytesMax = std::min(this->nData, this->nContigRead);
+        *src = this->buf + this->ixPop;
+    }
+
+    //* after using the data acquired by "getLargestPossiblePop()", remove part or all of it */
+    void pop(unsigned int n) {
+        assert(n <= this->nData);
+        this->advancePop(n);
+        this->nData -= n;
+    }
 
+   protected:
+    //* moves the push position by n bytes, maintaining the replica (touches only free space and the new data)
+    void advancePush(unsigned int n) {
+        assert(n <= this->nCirc + this->nContigRead - 1 - this->ixPush);
         if (this->ixPush < this->nContigRead) {
             // we wrote to the head of the regular buffer.
             // Replicate into the circular extension (which is of length nContigRead-1)
@@ -130,18 +246,10 @@ class circBuf {
         if (this->ixPush >= this->nCirc) {
             this->ixPush -= this->nCirc;
         }
-        this->nData += n;
-    }
-
-    //* returns max. number of bytes to take from data, to be reported afterwards via reportPop() */
-    void getLargestPossiblePop(unsigned int *nBytesMax, unsigned char **src) {
-        *nBytesMax = std::min(this->nData, this->nContigRead);
-        *src = this->buf + this->ixPop;
     }
 
-    //* after using the data acquired by "getLargestPossiblePop()", remove part or all of it */
-    void pop(unsigned int n) {
-        assert(n <= this->nData);
+    //* moves the pop position by n bytes
+    void advancePop(unsigned int n) {
         this->ixPop += n;
 
         // did we reach the end of the regular buffer?
@@ -149,10 +257,8 @@ class circBuf {
             // continue from the replica at the buffer head
             this->ixPop -= this->nCirc;
         }
-        this->nData -= n;
     }
 
-   protected:
     /** circular buffer */
     unsigned char *buf;
     /** size of the circular buffer (maximum read-ahead) */
@@ -174,7 +280,49 @@ class circBuf {
 // =======================
 // === blockingCircBuf ===
 // =======================
-/** multithreading layer over circBuf for parallel data input / output */
+//* number and total duration of the waits of one side of a blockingCircBuf. Written by that side only, may be read by any thread
+struct waitCounter {
+    std::atomic<uint64_t> n{0};
+    std::atomic<uint64_t> ns{0};
+};
+
+//* scope guard: counts one wait and its duration into a waitCounter
+class waitTimer {
+   public:
+    waitTimer(waitCounter &counter) : counter(counter), tStart(std::chrono::steady_clock::now()) {
+    }
+    ~waitTimer() {
+        uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->tStart).count();
+        this->counter.n.store(this->counter.n.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        this->counter.ns.store(this->counter.ns.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    }
+
+   protected:
+    waitCounter &counter;
+    std::chrono::steady_clock::time_point tStart;
+};
+
+//* snapshot of the blocking of a blockingCircBuf (see getWaits())
+struct ringWaits {
+    //* producer blocked on a full buffer (consumer is the bottleneck)
+    uint64_t nPushWaits = 0;
+    uint64_t pushWaitNs = 0;
+    //* consumer blocked on an empty buffer (producer is the bottleneck)
+    uint64_t nPopWaits = 0;
+    uint64_t popWaitNs = 0;
+    //* highest fill level at a push (bytes)
+    uint64_t peakBytes = 0;
+    void add(const ringWaits &other) {
+        this->nPushWaits += other.nPushWaits;
+        this->pushWaitNs += other.pushWaitNs;
+        this->nPopWaits += other.nPopWaits;
+        this->popWaitNs += other.popWaitNs;
+        this->peakBytes = std::max(this->peakBytes, other.peakBytes);
+    }
+};
+
+#ifdef BLOCKINGCIRCBUF_MUTEX
+/** multithreading layer over circBuf for parallel data input / output (reference implementation: one lock / notify per call) */
 class blockingCircBuf : circBuf {
    public:
     blockingCircBuf(unsigned int nCirc, unsigned int nContigRead) : circBuf(nCirc, nContigRead) {
@@ -192,12 +340,14 @@ class blockingCircBuf : circBuf {
             this->circBuf::getLargestPossiblePush(nBytesMax, readDest);
             if (*nBytesMax >= nBytesMin)
                 return false;
+            waitTimer timer(this->pushWaits);
             cvPop.wait(lk);
         }
     }
     void reportPush(unsigned int n) {
         std::lock_guard<std::mutex> lk(this->m);
         this->circBuf::reportPush(n);
+        this->peakBytes = std::max(this->peakBytes, (uint64_t)this->nData);
         this->cvPush.notify_one();
     }
     /** blocks until at least nBytesMin are available. Returns true (eos) in shutdown once all data has been consumed (non-zero nBytesMax < nBytesMin if trailing bytes) */
@@ -211,6 +361,7 @@ class blockingCircBuf : circBuf {
                 return false;  // note: even on shutdown, keep delivering data until empty
             if (this->isShutdown)
                 return true;  //
+            waitTimer timer(this->popWaits);
             cvPush.wait(lk);
         }
         return true;
@@ -228,6 +379,17 @@ class blockingCircBuf : circBuf {
             cvPop.notify_one();
         }
     }
+    //* blocking so far
+    ringWaits getWaits() {
+        std::lock_guard<std::mutex> lk(this->m);
+        ringWaits retVal;
+        retVal.nPushWaits = this->pushWaits.n.load();
+        retVal.pushWaitNs = this->pushWaits.ns.load();
+        retVal.nPopWaits = this->popWaits.n.load();
+        retVal.popWaitNs = this->popWaits.ns.load();
+        retVal.peakBytes = this->peakBytes;
+        return retVal;
+    }
 
    protected:
     /** thread protection of all internals */
@@ -238,6 +400,377 @@ class blockingCircBuf : circBuf {
     std::condition_variable cvPop;
     /** indicates that no new data will arrive (and no new data will be accepted) */
     bool isShutdown;
+    /** see getWaits() */
+    waitCounter pushWaits;
+    waitCounter popWaits;
+    uint64_t peakBytes = 0;
+};
+#else
+/** multithreading layer over circBuf for parallel data input / output. Single producer, single consumer.
+ * Lock-free: Each side owns its position and publishes a running byte count through an atomic. The consumer publishes pops in batches.
+ * A side that runs out of data (space) spins, then yields, then parks on a condition variable. The lock is only taken to park / wake up. */
+class blockingCircBuf : circBuf {
+   public:
+    blockingCircBuf(unsigned int nCirc, unsigned int nContigRead) : circBuf(nCirc, nContigRead) {
+        this->nPushed.store(0);
+        this->nPopped.store(0);
+        this->nPoppedLocal = 0;
+        this->nPushedSeen = 0;
+        this->nPoppedBatch = std::max(nCirc / 16, 1u);
+        this->isShutdown.store(false);
+        this->isPushParked.store(false);
+        this->isPopParked.store(false);
+    }
+
+    /* allows push of up to nBytesMax (which will be at least nBytesMin). Returns true if shutdown. */
+    bool getLargestPossiblePush(unsigned int nBytesMin, unsigned int *nBytesMax,
+                                unsigned char **readDest) {
+        assert(nBytesMin <= this->nContigRead);
+        bool isShutdown = false;
+        this->waitUntil(this->isPushParked, this->pushWaits, [&]() {
+            isShutdown = this->isShutdown.load(std::memory_order_acquire);
+            unsigned int nData = (unsigned int)(this->nPushed.load(std::memory_order_relaxed) - this->nPopped.load(std::memory_order_acquire));
+            *nBytesMax = std::min(this->nCirc - nData, this->nCirc + this->nContigRead - 1 - this->ixPush);
+            *readDest = this->buf + this->ixPush;
+            return (*nBytesMax >= nBytesMin) || isShutdown;
+        });
+        return isShutdown;
+    }
+    void reportPush(unsigned int n) {
+        this->advancePush(n);
+        uint64_t nPushed = this->nPushed.load(std::memory_order_relaxed) + n;
+        this->nPushed.store(nPushed, std::memory_order_release);
+        this->wake(this->isPopParked);
+        // fill level (upper bound: pops are published in batches)
+        uint64_t nData = nPushed - this->nPopped.load(std::memory_order_relaxed);
+        if (nData > this->peakBytes.load(std::memory_order_relaxed))
+            this->peakBytes.store(nData, std::memory_order_relaxed);
+    }
+    /** blocks until at least nBytesMin are available. Returns true (eos) in shutdown once all data has been consumed (non-zero nBytesMax < nBytesMin if trailing bytes) */
+    bool getLargestPossiblePop(unsigned int nBytesMin, unsigned int *nBytesMax,
+                               unsigned char **readDest) {
+        assert(nBytesMin <= this->nContigRead);
+        // fast path: enough data already seen (no shared memory access)
+        *readDest = this->buf + this->ixPop;
+        *nBytesMax = (unsigned int)std::min(this->nPushedSeen - this->nPoppedLocal, (uint64_t)this->nContigRead);
+        if (*nBytesMax >= nBytesMin)
+            return false;
+
+        // release space to the producer before waiting (it may be waiting for us)
+        this->publishPop();
+        bool isShutdown = false;
+        this->waitUntil(this->isPopParked, this->popWaits, [&]() {
+            // note: read shutdown before data so that no data pushed before shutdown is missed
+            isShutdown = this->isShutdown.load(std::memory_order_acquire);
+            this->nPushedSeen = this->nPushed.load(std::memory_order_acquire);
+            *nBytesMax = (unsigned int)std::min(this->nPushedSeen - this->nPoppedLocal, (uint64_t)this->nContigRead);
+            return (*nBytesMax >= nBytesMin) || isShutdown;
+        });
+        // note: even on shutdown, keep delivering data until empty
+        return *nBytesMax < nBytesMin;
+    }
+    void pop(unsigned int n) {
+        assert(n <= this->nPushedSeen - this->nPoppedLocal);
+        this->advancePop(n);
+        this->nPoppedLocal += n;
+        if (this->nPoppedLocal - this->nPopped.load(std::memory_order_relaxed) >= this->nPoppedBatch)
+            this->publishPop();
+    }
+    void setShutdown(bool shutdown) {
+        this->isShutdown.store(shutdown, std::memory_order_release);
+        if (shutdown) {
+            this->wake(this->isPushParked);
+            this->wake(this->isPopParked);
+        }
+    }
+    //* blocking so far
+    ringWaits getWaits() {
+        ringWaits retVal;
+        retVal.nPushWaits = this->pushWaits.n.load(std::memory_order_relaxed);
+        retVal.pushWaitNs = this->pushWaits.ns.load(std::memory_order_relaxed);
+        retVal.nPopWaits = this->popWaits.n.load(std::memory_order_relaxed);
+        retVal.popWaitNs = this->popWaits.ns.load(std::memory_order_relaxed);
+        retVal.peakBytes = this->peakBytes.load(std::memory_order_relaxed);
+        return retVal;
+    }
+
+   protected:
+    //* makes the consumer's pops visible to the producer
+    void publishPop() {
+        if (this->nPopped.load(std::memory_order_relaxed) == this->nPoppedLocal)
+            return;
+        this->nPopped.store(this->nPoppedLocal, std::memory_order_release);
+        this->wake(this->isPushParked);
+    }
+
+    /** returns once isReady() returns true: spin, then yield, then sleep on the condition variable until woken by the other side.
+     * Counts the time into "waits" unless ready right away */
+    template <class F>
+    bool waitUntil(std::atomic<bool> &isParked, waitCounter &waits, F isReady) {
+        if (isReady())
+            return true;
+        waitTimer timer(waits);
+        for (unsigned int ix = 0; ix < nSpin; ++ix)
+            if (isReady())
+                return true;
+        for (unsigned int ix = 0; ix < nYield; ++ix) {
+            std::this_thread::yield();
+            if (isReady())
+                return true;
+        }
+        std::unique_lock<std::mutex> lk(this->m);
+        // announce parking _before_ the final check. The other side publishes, then checks the flag (both seq_cst) so one of them sees the other
+        isParked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!isReady())
+            this->cv.wait(lk);
+        isParked.store(false, std::memory_order_relaxed);
+        return true;
+    }
+
+    //* wakes up the other side if parked (call after publishing)
+    void wake(std::atomic<bool> &isParked) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (isParked.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lk(this->m);
+            this->cv.notify_all();
+        }
+    }
+
+    static const unsigned int nSpin = 256;
+    static const unsigned int nYield = 16;
+
+    //* total number of bytes pushed (written by producer)
+    alignas(64) std::atomic<uint64_t> nPushed;
+    //* total number of bytes popped, as published to the producer (written by consumer)
+    alignas(64) std::atomic<uint64_t> nPopped;
+    //* total number of bytes popped (consumer only)
+    alignas(64) uint64_t nPoppedLocal;
+    //* last value of nPushed read by the consumer (consumer only)
+    uint64_t nPushedSeen;
+    //* number of popped bytes to accumulate before publishing
+    unsigned int nPoppedBatch;
+    std::atomic<bool> isShutdown;
+    std::atomic<bool> isPushParked;
+    std::atomic<bool> isPopParked;
+    //* see getWaits(). Each written by one side only
+    waitCounter pushWaits;
+    waitCounter popWaits;
+    std::atomic<uint64_t> peakBytes{0};
+    //* protects parking only
+    std::mutex m;
+    std::condition_variable cv;
+};
+#endif
+
+// ====================
+// === input format ===
+// ====================
+//* input file formats, identified by their leading "magic" bytes (file extension does not matter) */
+enum inputFormat_e {
+    FORMAT_PLAIN,
+    FORMAT_GZIP,
+    FORMAT_BGZF,
+    FORMAT_ZSTD,
+    FORMAT_LZ4
+};
+
+//* identifies the format from the first (up to) 18 bytes of a file
+static inputFormat_e detectFormat(const unsigned char *hdr, size_t n) {
+    if ((n >= 4) && (hdr[0] == 0x28) && (hdr[1] == 0xB5) && (hdr[2] == 0x2F) && (hdr[3] == 0xFD))
+        return FORMAT_ZSTD;
+    if ((n >= 4) && (hdr[0] == 0x04) && (hdr[1] == 0x22) && (hdr[2] == 0x4D) && (hdr[3] == 0x18))
+        return FORMAT_LZ4;
+    if ((n >= 3) && (hdr[0] == 0x1f) && (hdr[1] == 0x8b) && (hdr[2] == 8)) {
+        // BGZF: FEXTRA with XLEN=6 holding the single "BC" subfield of length 2
+        if ((n >= 18) && (hdr[3] & 4) && (hdr[10] == 6) && (hdr[11] == 0) && (hdr[12] == 'B') && (hdr[13] == 'C') && (hdr[14] == 2) && (hdr[15] == 0))
+            return FORMAT_BGZF;
+        return FORMAT_GZIP;
+    }
+    return FORMAT_PLAIN;
+}
+
+// =================
+// === mappedBuf ===
+// =================
+/** memory-mapped uncompressed input file with the "pop" interface of blockingCircBuf. Records are parsed in place (no reader thread, no copy, no locking) */
+class mappedBuf {
+   public:
+    //* maps the file if possible (regular file, non-empty, POSIX). Otherwise isMapped() returns false and the file is streamed instead.
+    mappedBuf(const string &filename) {
+        this->data = NULL;
+        this->size = 0;
+        this->pos = 0;
+        this->nextAdvise = 0;
+#ifndef _WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0)) {
+            void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                this->data = (unsigned char *)p;
+                this->size = st.st_size;
+                madvise(p, this->size, MADV_SEQUENTIAL);
+#ifdef POSIX_FADV_SEQUENTIAL
+                posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+                this->readAhead();
+            }
+        }
+        close(fd);  // mapping remains valid
+#endif
+    }
+
+    bool isMapped() {
+        return this->data != NULL;
+    }
+
+    inputFormat_e getFormat() {
+        return detectFormat(this->data, std::min(this->size, (size_t)18));
+    }
+
+    //* the whole file (if isMapped())
+    const unsigned char *getData() {
+        return this->data;
+    }
+    size_t getSize() {
+        return this->size;
+    }
+
+    /** returns true (eos) if less than nBytesMin remain (nBytesMax then gives the trailing byte count) */
+    bool getLargestPossiblePop(unsigned int nBytesMin, unsigned int *nBytesMax,
+                               unsigned char **readDest) {
+        size_t nRemaining = this->size - this->pos;
+        *nBytesMax = (unsigned int)std::min(nRemaining, (size_t)nMaxPop);
+        *readDest = this->data + this->pos;
+        return nRemaining < nBytesMin;
+    }
+
+    void pop(unsigned int n) {
+        assert(n <= this->size - this->pos);
+        this->pos += n;
+        if (this->pos >= this->nextAdvise)
+            this->readAhead();
+    }
+
+    ~mappedBuf() {
+#ifndef _WIN32
+        if (this->data)
+            munmap(this->data, this->size);
+#endif
+    }
+
+   protected:
+    //* asks the OS to prefetch the next readAheadSize bytes (in addition to MADV_SEQUENTIAL)
+    void readAhead() {
+#ifndef _WIN32
+        size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+        size_t start = (this->pos / pageSize) * pageSize;
+        if (start < this->size)
+            madvise(this->data + start, std::min((size_t)readAheadSize, this->size - start), MADV_WILLNEED);
+#endif
+        this->nextAdvise = this->pos + readAheadSize / 2;
+    }
+    static const size_t readAheadSize = 64 << 20;
+    //* any value above the maximum STDF record size will do
+    static const unsigned int nMaxPop = 1 << 20;
+    unsigned char *data;
+    size_t size;
+    //* position of next pop
+    size_t pos;
+    //* position where readAhead() is called next
+    size_t nextAdvise;
+};
+
+// ======================
+// === fileHandlePool ===
+// ======================
+/** keeps up to nMax output files open between writes, closing the least recently used one when full (e.g. 512 stdio streams by default on Windows).
+ * Single-threaded use (background writer thread, or the main thread once it has finished) */
+class fileHandlePool {
+   public:
+    fileHandlePool(unsigned int nMax) {
+        this->nMax = std::max(nMax, 1u);
+    }
+
+    //* returns an open handle for appending to "filename". "create" truncates (first write) */
+    FILE *get(const string &filename, bool create) {
+        auto it = this->open.find(filename);
+        if (it != this->open.end()) {
+            // === move to front (most recently used) ===
+            this->lru.splice(this->lru.begin(), this->lru, it->second);
+            return it->second->second;
+        }
+
+        if (this->open.size() >= this->nMax) {
+            // === close least recently used ===
+            this->closeHandle(this->lru.back().second, this->lru.back().first);
+            this->open.erase(this->lru.back().first);
+            this->lru.pop_back();
+        }
+
+        FILE *h = fopen(filename.c_str(), create ? "wb" : "ab");
+        if (!h) {
+            cerr << "Failed to open '" << filename << "' for write" << endl;
+            fail("");
+        }
+        ++this->nOpens;
+        this->lru.push_front(std::make_pair(filename, h));
+        this->open[filename] = this->lru.begin();
+        return h;
+    }
+
+    //* writes n bytes to h
+    void write(FILE *h, const void *data, size_t n, const string &filename) {
+        if (n == 0)
+            return;
+        if (fwrite(data, 1, n, h) != n) {
+            cerr << "Failed to write '" << filename << "'" << endl;
+            fail("");
+        }
+        ++this->nWrites;
+        this->nBytes += n;
+    }
+
+    void closeAll() {
+        for (auto it = this->lru.begin(); it != this->lru.end(); ++it)
+            this->closeHandle(it->second, it->first);
+        this->lru.clear();
+        this->open.clear();
+    }
+
+    uint64_t getNOpens() const {
+        return this->nOpens;
+    }
+    uint64_t getNWrites() const {
+        return this->nWrites;
+    }
+    uint64_t getNBytes() const {
+        return this->nBytes;
+    }
+
+    ~fileHandlePool() {
+        this->closeAll();
+    }
+
+   protected:
+    void closeHandle(FILE *h, const string &filename) {
+        if (fclose(h) != 0) {
+            cerr << "Failed to write '" << filename << "'" << endl;
+            fail("");
+        }
+    }
+    //* maximum number of open files
+    unsigned int nMax;
+    //* open files, most recently used first
+    std::list<std::pair<string, FILE *>> lru;
+    //* lookup into lru
+    std::unordered_map<string, std::list<std::pair<string, FILE *>>::iterator> open;
+    uint64_t nOpens = 0;
+    uint64_t nWrites = 0;
+    uint64_t nBytes = 0;
 };
 
 // =================
@@ -250,65 +783,73 @@ class doubleBuf {
     doubleBuf(string filename) {
         this->filename = filename;
     }
+    //* writes to the end of the existing file, instead of creating it
+    void setAppend() {
+        this->createFile = false;
+    }
+    //* writes a block-encoded column (see STDFooCodec.hpp) to filename + ".blk" instead. Not with setAppend()
+    void setCompress() {
+        this->filename += ".blk";
+        this->encoder.reset(new stdfooCodec::blockEncoder<T>());
+    }
     void input(T val) {
         std::lock_guard<std::mutex> lk(this->m);
         this->buffer[this->bufPrimary].push_back(val);
     }
+    void input(const T *vals, size_t n) {
+        std::lock_guard<std::mutex> lk(this->m);
+        this->buffer[this->bufPrimary].insert(this->buffer[this->bufPrimary].end(), vals, vals + n);
+    }
 
-    //* writes contents to file, possibly from an external thread (at most one additional thread). Returns false if idle */
-    bool writeToFile() {
-        // === open file ===
-        std::ofstream fhandle = std::ofstream();
-        if (this->createFile) {
-            fhandle.open(this->filename,
-                         std::ofstream::out | std::ofstream::binary);
-            // check for empty buffer only _after_ the file was created (which may take some time)
-            std::lock_guard<std::mutex> lk(this->m);
-            if (this->buffer[this->bufPrimary].size() < 1)
-                return false;
-
-        } else {
-            // check for empty buffer _before_ opening the file
-            {
-                std::lock_guard<std::mutex> lk(this->m);
-                if (this->buffer[this->bufPrimary].size() < 1)
-                    return false;
-            }  // RAII lock ends: Release while opening the file
-            fhandle.open(this->filename,
-                         std::ofstream::out | std::ofstream::binary | std::ofstream::app);
-        }
-        if (!fhandle.is_open()) {
-            cerr << "Failed to open '" << this->filename << "' for write"
-                 << endl;
-            fail("");
-        }
-        this->createFile = false;
-
+    /** writes contents to file, possibly from an external thread (at most one additional thread). Returns false if idle.
+     * Waits for at least nMin elements to write larger chunks (nMin = 0: write all, create file even if empty). */
+    bool writeToFile(fileHandlePool &pool, size_t nMin) {
         std::vector<T> *b;
-
         {  // === swap buffers. Former primary buffer b becomes secondary ===
             std::lock_guard<std::mutex> lk(this->m);
             b = &this->buffer[this->bufPrimary];
+            bool createEmpty = this->createFile && (nMin == 0);
+            if ((b->size() < std::max(nMin, (size_t)1)) && !createEmpty)
+                return false;
             this->bufPrimary = (this->bufPrimary + 1) & 1;
         }  // RAII lock ends
 
+        FILE *h = pool.get(this->filename, this->createFile);
+        this->createFile = false;
+
         //=== write data ===
         if (std::is_same<T, std::string>::value) {
             // write as string + newline
-            for (auto it = b->begin(); it != b->end(); ++it) {
-                fhandle << *it << "\n";
-            }
-        } else {
+            std::stringstream ss;
+            for (auto it = b->begin(); it != b->end(); ++it)
+                ss << *it << "\n";
+            string tmp = ss.str();
+            pool.write(h, tmp.data(), tmp.size(), this->filename);
+        } else if (this->encoder) {
+            // write completed blocks
+            this->encoder->add(b->data(), b->size(), this->encoded);
+            pool.write(h, this->encoded.data(), this->encoded.size(), this->filename);
+            this->encoded.clear();
+        } else if (b->size() > 0) {
             // write binary
             T *pFirstElem = &((*b)[0]);
-            fhandle.write((const char *)pFirstElem, b->size() * sizeof(T));
+            pool.write(h, pFirstElem, b->size() * sizeof(T), this->filename);
         }
 
         b->clear();
-        fhandle.close();
         return true;
     }
 
+    //* writes all remaining data. Creates the file, if not yet done
+    void close(fileHandlePool &pool) {
+        this->writeToFile(pool, 0);
+        if (this->encoder) {
+            this->encoder->finish(this->encoded);
+            pool.write(pool.get(this->filename, false), this->encoded.data(), this->encoded.size(), this->filename);
+            this->encoded.clear();
+        }
+    }
+
    protected:
     /** where to write the data to */
     string filename;
@@ -320,6 +861,9 @@ class doubleBuf {
     unsigned int bufPrimary = 0;
     /** startup flag */
     bool createFile = true;
+    /** see setCompress() (NULL: write as is) */
+    std::unique_ptr<stdfooCodec::blockEncoder<T>> encoder;
+    std::vector<unsigned char> encoded;
 };
 
 // =====================
@@ -403,14 +947,19 @@ class perItemLogger {
         }
     }
 
-    /** optional write-to-file of buffered data from background thread. Returns true if data was written */
-    bool flush() {
-        return this->buf.writeToFile();
+    /** optional write-to-file of buffered data (at least nMin elements) from background thread. Returns true if data was written */
+    bool flush(fileHandlePool &pool, size_t nMin) {
+        return this->buf.writeToFile(pool, nMin);
     }
 
-    /** write-to-file from background thread. Possibly redundant with flush() but does no harm. */
-    void close() {
-        this->buf.writeToFile();
+    /** write-to-file of all remaining data. Creates the file, if not yet done. */
+    void close(fileHandlePool &pool) {
+        this->buf.close(pool);
+    }
+
+    //* block-encoded output (see doubleBuf::setCompress())
+    void setCompress() {
+        this->buf.setCompress();
     }
 
    protected:
@@ -437,687 +986,5202 @@ class perItemLogger {
     T defVal;
 };
 
-// ====================
-// === commonLogger ===
-// ====================
-/** writes items common to all DUTs (testnumber, testnames, limits, units). Can afford one filehandle per item. */
-class commonLogger {
+// ========================
+// === stringHeapLogger ===
+// ========================
+/** per-DUT string data (e.g. PART_ID), written as (name).heap and (name).offsets.uint64.
+ * The heap holds entries of one length byte followed by the characters. Offsets give the heap position of each DUT's entry.
+ * Repeated values share one entry (dictionary, up to maxDictEntries different values). Empty STDF strings are stored as "null", invalid data as empty entry.
+ * Same data validity logic as perItemLogger, but copies from the STDF record without per-DUT allocations */
+class stringHeapLogger {
    public:
-    commonLogger(string dirname) {
-        this->directory = dirname;
+    stringHeapLogger(std::string name) : heap(name + ".heap"), offsets(name + ".offsets.uint64") {
+        this->name = name;
+        this->nWritten = 0;
+        this->heapSize = 0;
     }
 
-    //* checks for first occurrence of testnum PTR
-    bool isLogged(unsigned int testnum) {
-        // STDF standard: "The first occurrence of this record also establishes the default values for all semi-static information about the test, such as limits, units, and scaling."
-        // Performance-critical, as "first occurrence" of testnum needs to be checked for every PTR record.
-        return this->loggedTests.find(testnum) != this->loggedTests.end();
+    /** continues existing files with nDuts entries (e.g. --append). The dictionary is restored from the start of the heap:
+     * entries are added in order of first appearance, and the dictionary takes all of them until full */
+    void resume(unsigned int nDuts) {
+        std::ifstream is(this->name + ".heap", std::ifstream::binary | std::ifstream::ate);
+        if (!is.is_open()) {
+            cerr << "Failed to open '" << this->name << ".heap' for read" << endl;
+            fail("");
+        }
+        this->heapSize = (uint64_t)is.tellg();
+        std::vector<char> prefix((size_t)std::min(this->heapSize, (uint64_t)maxDictEntries * 256));
+        is.seekg(0);
+        is.read(prefix.data(), prefix.size());
+        size_t pos = 0;
+        while ((this->dict.size() < maxDictEntries) && (pos < prefix.size())) {
+            size_t len = (uint8_t)prefix[pos];
+            if (pos + 1 + len > prefix.size())
+                break;
+            this->dict[string(&prefix[pos + 1], len)] = pos;
+            pos += 1 + len;
+        }
+        this->nWritten = nDuts;
+        this->heap.setAppend();
+        this->offsets.setAppend();
     }
 
-    //* records default values from first occurrence of PTR record
-    void log(unsigned int testnum, float lowLim, float highLim, string testname,
-             string unit) {
-        this->lowLim[testnum] = lowLim;
-        this->highLim[testnum] = highLim;
-        this->testname[testnum] = testname;
-        this->unit[testnum] = unit;
-        this->loggedTests.insert(testnum);
+    /** sets data with timestamp from STDF string (length byte, then characters) */
+    void setData(unsigned int site, unsigned int validCode, const unsigned char *stdfString) {
+        this->addSiteIfMissing(site);
+        // note: STDF string may use less space than advertised by len byte, if null-terminated
+        uint8_t len = stdfString[0];
+        const char *first = (const char *)stdfString + 1;
+        size_t n = std::find(first, first + len, '\0') - first;
+        if (n == 0)
+            this->sitedata[site].assign("null");
+        else
+            this->sitedata[site].assign(first, n);
+        this->validCode[site] = validCode;
     }
 
-    //* writes collected data to files */
-    void close() {
-        // === copy testnums to sorted set ===
-        std::set<unsigned int> testnums;
-        for (auto it = this->loggedTests.begin(); it != this->loggedTests.end();
-             ++it) {
-            testnums.insert(*it);
-        }
+    /** write this item for given site. Fill missing data in file with empty entries. */
+    void write(unsigned int site, unsigned int dutCountBaseZero, unsigned int validCode) {
+        this->addSiteIfMissing(site);
+        bool dataIsValid = this->validCode[site] == validCode;
 
-        this->openHandle(this->directory + "/testnums.uint32");
-        for (auto it = testnums.begin(); it != testnums.end(); ++it) {
-            uint32_t tmp = *it;
-            this->h.write((const char *)&tmp, sizeof(tmp));
-        }
-        this->closeHandle();
+        // === write invalid entries ===
+        unsigned int firstUnpadded = dataIsValid ? dutCountBaseZero : dutCountBaseZero + 1;
+        while (this->nWritten < firstUnpadded)
+            this->append(string());
 
-        this->openHandle(this->directory + "/testnames.txt");
-        for (auto it = testnums.begin(); it != testnums.end(); ++it)
-            this->h << this->testname[*it] << "\n";
-        this->closeHandle();
+        // === write valid entry ===
+        if (dataIsValid)
+            this->append(this->sitedata[site]);
+    }
 
-        this->openHandle(this->directory + "/units.txt");
-        for (auto it = testnums.begin(); it != testnums.end(); ++it)
-            this->h << this->unit[*it] << "\n";
-        this->closeHandle();
+    //* writes val as entry for the next DUT (at most 255 characters)
+    void append(const string &val) {
+        this->offsets.input(this->getEntry(val));
+        ++this->nWritten;
+    }
 
-        this->openHandle(this->directory + "/lowLim.float");
-        for (auto it = testnums.begin(); it != testnums.end(); ++it) {
-            float tmp = this->lowLim[*it];
-            this->h.write((const char *)&tmp, sizeof(tmp));
-        }
-        this->closeHandle();
+    /** optional write-to-file of buffered data (at least nMinBytes) from background thread. Returns true if data was written */
+    bool flush(fileHandlePool &pool, size_t nMinBytes) {
+        bool retVal = this->heap.writeToFile(pool, nMinBytes);
+        retVal |= this->offsets.writeToFile(pool, nMinBytes / sizeof(uint64_t));
+        return retVal;
+    }
 
-        this->openHandle(this->directory + "/highLim.float");
-        for (auto it = testnums.begin(); it != testnums.end(); ++it) {
-            float tmp = this->highLim[*it];
-            this->h.write((const char *)&tmp, sizeof(tmp));
-        }
-        this->closeHandle();
+    /** write-to-file of all remaining data. Creates the files, if not yet done. */
+    void close(fileHandlePool &pool) {
+        this->heap.writeToFile(pool, 0);
+        this->offsets.writeToFile(pool, 0);
+    }
 
-        this->openHandle(this->directory + "/filenames.txt");
-        for (auto it = this->filenames.begin(); it != this->filenames.end();
-             ++it)
-            this->h << *it << "\n";
-        this->closeHandle();
+   protected:
+    //* returns the heap offset of val, appending it if needed
+    uint64_t getEntry(const string &val) {
+        auto it = this->dict.find(val);
+        if (it != this->dict.end())
+            return it->second;
 
-        this->openHandle(this->directory + "/dutsPerFile.uint32");
-        for (auto it = this->dutsPerFile.begin(); it != this->dutsPerFile.end();
-             ++it) {
-            uint32_t tmp = *it;
-            this->h.write((const char *)&tmp, sizeof(tmp));
+        uint64_t offset = this->heapSize;
+        uint8_t len = (uint8_t)val.size();
+        this->heap.input(&len, 1);
+        this->heap.input((const uint8_t *)val.data(), len);
+        this->heapSize += 1 + len;
+        if (this->dict.size() < maxDictEntries)
+            this->dict[val] = offset;
+        return offset;
+    }
+
+    void addSiteIfMissing(unsigned int site) {
+        if (site >= this->sitedata.size()) {
+            this->sitedata.resize(site + 1);
+            this->validCode.resize(site + 1, 0);  // 0 is never valid
         }
-        this->closeHandle();
+    }
 
-        // human-readable file / lot summary in csv format
-        this->openHandle(this->directory + "/filelist.txt");
-        this->h << "filename\tnDuts\n";
-        for (unsigned int ix = 0; ix < this->filenames.size(); ++ix)
-            this->h << this->filenames[ix] << "\t" << this->dutsPerFile[ix]
-                    << "\n";
-        this->closeHandle();
+    //* output files without extension
+    string name;
+    //* collected data per site (capacity is reused between DUTs) */
+    std::vector<string> sitedata;
+    //* timestamp of data per site */
+    std::vector<unsigned int> validCode;
+    //* how many DUTs have been recorded (to pad the output file for missing item */
+    unsigned int nWritten;
+    //* bytes appended to heap so far
+    uint64_t heapSize;
+    //* heap offset of known values. Limited size, as e.g. PART_ID is typically unique
+    std::unordered_map<string, uint64_t> dict;
+    static const size_t maxDictEntries = 4096;
+    doubleBuf<uint8_t> heap;
+    doubleBuf<uint64_t> offsets;
+};
 
-        // human-readable summary in csv format
-        this->openHandle(this->directory + "/testlist.txt");
-        this->h.precision(9);
-        this->h << "TEST_NUM\tTEST_TXT\tUNITS\tLO_LIMIT\tHI_LIMIT\n";
-        for (auto it = testnums.begin(); it != testnums.end(); ++it) {
-            this->h << (*it) << "\t"                //
-                    << this->testname[*it] << "\t"  //
-                    << this->unit[*it] << "\t"      //
-                    << this->lowLim[*it] << "\t"    //
-                    << this->highLim[*it] << "\n";
-        }
-        this->closeHandle();
+// ==================
+// === tileWriter ===
+// ==================
+/** DUT-major tiled copy of all results, for fast access to all tests of a DUT (the column files need one seek per test).
+ * Each tile holds K DUTs x M tests (row of M floats per DUT), tiles.float stores all tiles of DUTs 0..K-1, then DUTs K..2K-1 etc.
+ * Tests are assigned to slots in the order of first appearance (tileTestOrder.uint32); tile g holds slots g*M..(g+1)*M-1.
+ * tiles.index.uint64 gives the first tile of each block of K DUTs. Blocks can have more tiles than earlier ones, as tests appear. */
+class tileWriter {
+   public:
+    tileWriter(string dirname, unsigned int nDutsPerTile, unsigned int nTestsPerTile)
+        : tiles(dirname + "/tiles.float"), index(dirname + "/tiles.index.uint64") {
+        this->directory = dirname;
+        this->K = nDutsPerTile;
+        this->M = nTestsPerTile;
+        this->rows.resize(this->K);
+        this->ixRow = 0;
+        this->nTilesWritten = 0;
     }
 
-    //* reports the end of an input file, how many DUTs it contains
-    void reportFile(string filename, unsigned int dutsPerFile) {
-        this->filenames.push_back(filename);
-        this->dutsPerFile.push_back(dutsPerFile);
+    //* adds results of one DUT, by slot
+    void addRow(const float *vals, size_t n) {
+        this->rows[this->ixRow].assign(vals, vals + n);
+        if (++this->ixRow == this->K)
+            this->writeBlock();
     }
 
-   protected:
-    void openHandle(string fname) {
-        this->h.open(fname, std::ofstream::out | std::ofstream::binary);
-        if (!this->h.is_open()) {
-            cerr << "Failed to open '" << fname << "' for write" << endl;
+    bool flush(fileHandlePool &pool, size_t nMin) {
+        bool retVal = this->tiles.writeToFile(pool, nMin);
+        retVal |= this->index.writeToFile(pool, std::max(nMin / (this->K * this->M), (size_t)1));
+        return retVal;
+    }
+
+    //* writes remaining data (last block is padded with NaN DUTs) and the test slot assignment
+    void close(fileHandlePool &pool, const std::vector<unsigned int> &testnumBySlot, const std::vector<uint32_t> &pinBySlot) {
+        if (this->ixRow > 0)
+            this->writeBlock();
+        this->tiles.writeToFile(pool, 0);
+        this->index.writeToFile(pool, 0);
+        writeTileInfo(this->directory, this->K, this->M, testnumBySlot, pinBySlot);
+    }
+
+    //* writes tileDims.uint32 (K, M), tileTestOrder.uint32 (TEST_NUM per slot) and tilePinOrder.uint32 (MPR pin per slot, 0xFFFFFFFF for PTR)
+    static void writeTileInfo(const string &dirname, unsigned int K, unsigned int M, const std::vector<unsigned int> &testnumBySlot, const std::vector<uint32_t> &pinBySlot) {
+        std::ofstream h(dirname + "/tileDims.uint32", std::ofstream::out | std::ofstream::binary);
+        uint32_t dims[2] = {K, M};
+        h.write((const char *)dims, sizeof(dims));
+        std::ofstream h2(dirname + "/tileTestOrder.uint32", std::ofstream::out | std::ofstream::binary);
+        for (auto it = testnumBySlot.begin(); it != testnumBySlot.end(); ++it) {
+            uint32_t tmp = *it;
+            h2.write((const char *)&tmp, sizeof(tmp));
+        }
+        std::ofstream h3(dirname + "/tilePinOrder.uint32", std::ofstream::out | std::ofstream::binary);
+        h3.write((const char *)pinBySlot.data(), pinBySlot.size() * sizeof(uint32_t));
+        if (!h || !h2 || !h3) {
+            cerr << "Failed to write tile information into '" << dirname << "'" << endl;
             fail("");
         }
     }
-    void closeHandle() {
-        this->h.close();
+
+   protected:
+    //* transposes collected rows into tiles
+    void writeBlock() {
+        size_t nSlots = 0;
+        for (auto it = this->rows.begin(); it != this->rows.end(); ++it)
+            nSlots = std::max(nSlots, it->size());
+        size_t nTiles = (nSlots + this->M - 1) / this->M;
+
+        this->index.input(this->nTilesWritten);
+        this->tile.resize(this->K * this->M);
+        for (size_t ixTile = 0; ixTile < nTiles; ++ixTile) {
+            std::fill(this->tile.begin(), this->tile.end(), std::nanf(""));
+            for (unsigned int ixDut = 0; ixDut < this->ixRow; ++ixDut) {
+                const std::vector<float> &row = this->rows[ixDut];
+                // note: rows may be shorter than nSlots (tests that appeared later)
+                size_t first = ixTile * this->M;
+                if (first < row.size())
+                    std::copy(row.begin() + first, row.begin() + std::min(row.size(), first + this->M), this->tile.begin() + ixDut * this->M);
+            }
+            this->tiles.input(this->tile.data(), this->tile.size());
+        }
+        this->nTilesWritten += nTiles;
+        this->ixRow = 0;
     }
-    std::ofstream h;
+
     string directory;
-    std::unordered_map<unsigned int, float> lowLim;
-    std::unordered_map<unsigned int, float> highLim;
-    std::unordered_map<unsigned int, string> testname;
-    std::unordered_map<unsigned int, string> unit;
-    std::unordered_set<unsigned int> loggedTests;
-    std::vector<string> filenames;
-    std::vector<unsigned int> dutsPerFile;
+    //* DUTs per tile
+    unsigned int K;
+    //* tests per tile
+    unsigned int M;
+    //* results of the current block of DUTs, by slot
+    std::vector<std::vector<float>> rows;
+    //* current DUT within the block
+    unsigned int ixRow;
+    //* transposition buffer
+    std::vector<float> tile;
+    uint64_t nTilesWritten;
+    doubleBuf<float> tiles;
+    doubleBuf<uint64_t> index;
 };
 
-// ==================
-// === stdfWriter ===
-// ==================
-/** takes one input STDF record at a time, extracts detailed data and routes to various writers */
-class stdfWriter {
+// =======================
+// === testnumResolver ===
+// =======================
+/** maps TEST_NUM to dense ordinals (order of first appearance). Performance-critical, as this is needed for every PTR record.
+ * Test programs run tests in a nearly fixed order. Each site predicts the next TEST_NUM from the test that followed the previous one
+ * last time (typically one compare, no hashing). Otherwise, a flat open-addressing hash table is used. */
+class testnumResolver {
    public:
-    stdfWriter(string dirname) : cmLog(dirname) {
-        this->directory = dirname;
-        this->nextValidCode = 1;  // 0 is "invalid"
-        this->loggerSite = new perItemLogger<uint8_t>(
-            dirname + "/" + "site.uint8", 255);
-        this->loggerHardbin = new perItemLogger<uint16_t>(
-            dirname + "/" + "hardbin.uint16", 65535);
-        this->loggerSoftbin = new perItemLogger<uint16_t>(
-            dirname + "/" + "softbin.uint16", 65535);
-        this->loggerPartId = new perItemLogger<string>(
-            dirname + "/" + "PART_ID.txt", "");
-        this->loggerPartTxt = new perItemLogger<string>(
-            dirname + "/" + "PART_TXT.txt", "");
-        this->dutCountBaseZero = 0;
-        this->dutsReported = 0;
-        this->filenumBase1 = 1;
+    testnumResolver() {
+        this->table.resize(64);
+        this->successor.resize(1);
     }
 
-    static string decodeString(unsigned char *&ptr) {
-        // note: STDF string may use less space than advertised by len byte, if null-terminated
-        char buf[255 + 1];
-        uint8_t len = *(ptr++);
-        for (unsigned int ix = 0; ix < len; ++ix) {
-            buf[ix] = *(ptr++);
-        }
-        buf[len] = 0;
-        if (buf[0] == 0)
-            return std::string("null");
-        else
-            return std::string(&buf[0]);
+    //* returns the ordinal of testnum for the DUT on site. isNew: first occurrence of testnum (new ordinal)
+    unsigned int resolve(unsigned int site, uint32_t testnum, bool &isNew) {
+        if (site >= this->lastBySite.size())
+            this->lastBySite.resize(site + 1, 0);
+        uint32_t last = this->lastBySite[site];
+
+        // === predicted: the test that followed last time, or the one after (skipped test) ===
+        const link &next = this->successor[last];
+        if ((next.testnum == testnum) && next.ordinalPlusOne) {
+            this->lastBySite[site] = next.ordinalPlusOne;
+            isNew = false;
+            return next.ordinalPlusOne - 1;
+        }
+        const link &nextNext = this->successor[next.ordinalPlusOne];
+        if ((nextNext.testnum == testnum) && nextNext.ordinalPlusOne) {
+            this->lastBySite[site] = nextNext.ordinalPlusOne;
+            isNew = false;
+            return nextNext.ordinalPlusOne - 1;
+        }
+
+        // === not predicted: learn the new successor ===
+        unsigned int ordinal = this->lookup(testnum, isNew);
+        this->successor[last].testnum = testnum;
+        this->successor[last].ordinalPlusOne = ordinal + 1;
+        this->lastBySite[site] = ordinal + 1;
+        return ordinal;
     }
 
-    void stdfRecord(unsigned char *ptr) {
-        ptr += 2;  // record length
-        uint16_t hdr = decode<uint16_t>(ptr);
-        switch (hdr) {
-            case 0 + (10 << 8): {  // FAR
-                // do nothing...
-                break;
-            }
-            case 1 + (10 << 8): {  // MIR
-                this->pwl.add("MIR", "SETUP_T", decode<uint32_t>(ptr));
-                this->pwl.add("MIR", "START_T", decode<uint32_t>(ptr));
-                this->pwl.add("MIR", "STAT_NUM", decode<uint8_t>(ptr));
-                this->pwl.add("MIR", "MODE_COD", decode<uint8_t>(ptr));
-                this->pwl.add("MIR", "RTST_COD", decode<uint8_t>(ptr));
-                this->pwl.add("MIR", "PROD_COD", decode<uint8_t>(ptr));
-                this->pwl.add("MIR", "BURN_TIM", decode<uint16_t>(ptr));
-                this->pwl.add("MIR", "CMOD_COD", decode<uint8_t>(ptr));
-                this->pwl.add("MIR", "LOT_ID", decodeString(ptr));
-                this->pwl.add("MIR", "PART_TYP", decodeString(ptr));
-                this->pwl.add("MIR", "NODE_NAM", decodeString(ptr));
-                this->pwl.add("MIR", "TSTR_TYP", decodeString(ptr));
-                this->pwl.add("MIR", "JOB_NAM", decodeString(ptr));
-                this->pwl.add("MIR", "JOB_REV", decodeString(ptr));
-                this->pwl.add("MIR", "SBLOT_ID", decodeString(ptr));
-                this->pwl.add("MIR", "OPER_NAM", decodeString(ptr));
-                this->pwl.add("MIR", "EXEC_TYP", decodeString(ptr));
-                this->pwl.add("MIR", "EXEC_VER", decodeString(ptr));
-                this->pwl.add("MIR", "TEST_COD", decodeString(ptr));
-                this->pwl.add("MIR", "TST_TEMP", decodeString(ptr));
-                this->pwl.add("MIR", "USER_TXT", decodeString(ptr));
-                this->pwl.add("MIR", "AUX_FILE ", decodeString(ptr));
-                this->pwl.add("MIR", "PKG_TYP", decodeString(ptr));
-                this->pwl.add("MIR", "FAMLY_ID", decodeString(ptr));
-                this->pwl.add("MIR", "DATE_COD", decodeString(ptr));
-                this->pwl.add("MIR", "FACIL_ID", decodeString(ptr));
-                this->pwl.add("MIR", "FLOOR_ID", decodeString(ptr));
-                this->pwl.add("MIR", "PROC_ID", decodeString(ptr));
-                break;
-            }
-            case 5 + (10 << 8): {  // PIR
-                // cout << "PIR\n";
-                ptr += 1;  // HEAD_NUM
-                unsigned int SITE_NUM = decode<uint8_t>(ptr);
-                this->PIR(SITE_NUM);
-                break;
-            }
-            case 5 + (20 << 8): {  // PRR
-                // cout << "PRR\n";
-                ptr += 1;  // HEAD_NUM
-                unsigned int SITE_NUM = decode<uint8_t>(ptr);
-                ptr += 3;  // PART_FLG, NUM_TEST
-                unsigned int HARD_BIN = decode<uint16_t>(ptr);
-                unsigned int SOFT_BIN = decode<uint16_t>(ptr);
-                /*unsigned int X_COORD = */ decode<uint16_t>(ptr);
-                /*unsigned int Y_COORD = */ decode<uint16_t>(ptr);
-                /*unsigned int TEST_T = */ decode<uint32_t>(ptr);
-                string PART_ID = decodeString(ptr);
-                string PART_TXT = decodeString(ptr);
-                this->PRR(SITE_NUM, SOFT_BIN, HARD_BIN, PART_ID, PART_TXT);
-                break;
-            }
-            case 15 + (10 << 8): {  // PTR
-                // cout << "PTR\n";
-                unsigned int TEST_NUM = decode<uint32_t>(ptr);
-                ptr += 1;  // HEAD_NUM
-                unsigned int SITE_NUM = decode<uint8_t>(ptr);
-                ptr += 2;  // TEST_FLG, PARM_FLG
-                float RESULT = decode<float>(ptr);
-                // cout << TEST_NUM << " " << RESULT << endl;
-                this->PTR(TEST_NUM, SITE_NUM, RESULT);
-                if (!this->cmLog.isLogged(TEST_NUM)) {
-                    string testtext = decodeString(ptr);
-                    string alarmId = decodeString(ptr);
-                    ptr += 4;  // OPT_FLAG, RES_SCAL, LLM_SCAL, HLM_SCAL
-                    float lowLim = decode<float>(ptr);
-                    float highLim = decode<float>(ptr);
-                    string unit = decodeString(ptr);
-                    this->cmLog.log(TEST_NUM, lowLim, highLim, testtext, unit);
-                }
-                break;
+    //* returns the ordinal of testnum without prediction. isNew: first occurrence of testnum (new ordinal)
+    unsigned int lookup(uint32_t testnum, bool &isNew) {
+        size_t mask = this->table.size() - 1;
+        for (size_t ix = hash(testnum) & mask;; ix = (ix + 1) & mask) {
+            link &e = this->table[ix];
+            if (e.ordinalPlusOne == 0) {
+                // === not found: new ordinal ===
+                unsigned int ordinal = (unsigned int)this->testnumByOrdinal.size();
+                e.testnum = testnum;
+                e.ordinalPlusOne = ordinal + 1;
+                this->testnumByOrdinal.push_back(testnum);
+                this->successor.push_back(link());
+                if (2 * this->testnumByOrdinal.size() > this->table.size())
+                    this->grow();
+                isNew = true;
+                return ordinal;
             }
-            default: {
-                // cerr << "warning: unsupported record (OK outside testcases)" << endl;
+            if (e.testnum == testnum) {
+                isNew = false;
+                return e.ordinalPlusOne - 1;
             }
         }
     }
 
-    void PIR(unsigned int site) {
-        if (this->siteValidCode.size() <= site)
-            this->siteValidCode.resize(site + 1);
-        if (this->siteValidCode[site]) {
-            cerr << "warning: inconsistent file structure. PIR on open site "
-                 << site << " (missing PRR)" << endl;
-        }
-        this->siteValidCode[site] = this->nextValidCode++;
+    //* returns a new ordinal that is not looked up by testnum (e.g. MPR pins)
+    unsigned int addOrdinal(uint32_t testnum) {
+        this->testnumByOrdinal.push_back(testnum);
+        this->successor.push_back(link());
+        return (unsigned int)this->testnumByOrdinal.size() - 1;
     }
 
-    void PTR(unsigned int testnum, unsigned int site, float val) {
-        if (this->siteValidCode.size() <= site)
-            this->siteValidCode.resize(site + 1);
-        if (!this->siteValidCode[site]) {
-            std::cerr
-                << "Warning: inconsistent file structure. PTR on closed site "
-                << site << " (missing PIR)" << endl;
-            return;
-        }
+    //* starts a new DUT on site: predicts the first test
+    void beginDut(unsigned int site) {
+        if (site < this->lastBySite.size())
+            this->lastBySite[site] = 0;
+    }
 
-        // === look up or create data structure ===
-        auto it = this->loggerTestitems.find(testnum);
-        perItemLogger<float> *i;
-        if (it != this->loggerTestitems.end()) {
-            i = it->second;
-        } else {
-            std::ostringstream tmp;
-            tmp << this->directory << "/" << testnum << ".float";
-            i = new perItemLogger<float>(tmp.str(), std::nanf(""));
+    //* number of ordinals
+    size_t size() {
+        return this->testnumByOrdinal.size();
+    }
 
-            this->loggerTestitems[testnum] = i;
-        }
+    const std::vector<unsigned int> &getTestnumByOrdinal() {
+        return this->testnumByOrdinal;
+    }
 
-        i->setData(site, this->siteValidCode[site], val);
+   protected:
+    static size_t hash(uint32_t testnum) {
+        return (size_t)((testnum * (uint64_t)0x9E3779B97F4A7C15ull) >> 32);
     }
 
-    void PRR(unsigned int site, uint16_t softbin, uint16_t hardbin, string PART_ID, string PART_TXT) {
-        if (this->siteValidCode.size() <= site)
-            this->siteValidCode.resize(site + 1);
-        unsigned int validCode = this->siteValidCode[site];
-        if (validCode == 0) {
-            std::cerr
-                << "warning: inconsistent file structure. PRR on closed site "
-                << site << " (missing PIR)" << endl;
-            return;
+    //* doubles the hash table size
+    void grow() {
+        std::vector<link> old;
+        old.swap(this->table);
+        this->table.resize(2 * old.size());
+        size_t mask = this->table.size() - 1;
+        for (auto it = old.begin(); it != old.end(); ++it) {
+            if (it->ordinalPlusOne == 0)
+                continue;
+            size_t ix = hash(it->testnum) & mask;
+            while (this->table[ix].ordinalPlusOne != 0)
+                ix = (ix + 1) & mask;
+            this->table[ix] = *it;
         }
+    }
 
-        // === data added by the PRR ===
-        this->loggerSoftbin->setData(site, validCode, softbin);
-        this->loggerHardbin->setData(site, validCode, hardbin);
-        this->loggerSite->setData(site, validCode, site);
-        this->loggerPartId->setData(site, validCode, PART_ID);
-        this->loggerPartTxt->setData(site, validCode, PART_TXT);
+    //* testnum and its ordinal + 1 (0: none)
+    struct link {
+        uint32_t testnum = 0;
+        uint32_t ordinalPlusOne = 0;
+    };
+    //* open addressing, linear probing. Size is a power of 2, at most half full
+    std::vector<link> table;
+    //* test that followed ordinal + 1 last time. Index 0: first test of a DUT
+    std::vector<link> successor;
+    //* ordinal + 1 of the previous test on each site (0: start of DUT)
+    std::vector<uint32_t> lastBySite;
+    std::vector<unsigned int> testnumByOrdinal;
+};
 
-        // === write data ===
-        for (auto it = this->loggerTestitems.begin();
-             it != loggerTestitems.end(); ++it) {
-            (*it).second->write(site, this->dutCountBaseZero, validCode);
-        }
-        this->loggerSoftbin->write(site, this->dutCountBaseZero, validCode);
-        this->loggerHardbin->write(site, this->dutCountBaseZero, validCode);
-        this->loggerSite->write(site, this->dutCountBaseZero, validCode);
-        this->loggerPartId->write(site, this->dutCountBaseZero, validCode);
-        this->loggerPartTxt->write(site, this->dutCountBaseZero, validCode);
+// =================
+// === testStats ===
+// =================
+//* count, mean, spread, extremes and histogram of the finite results of one test, for a group of DUTs (e.g. one site). Groups combine with merge()
+struct testMoments {
+    //* histogram bins: below lowLim, nBins - 2 equal bins from lowLim to highLim, above highLim (all zero without a valid limit range)
+    static const unsigned int nBins = 12;
+    uint64_t n = 0;
+    double mean = 0;
+    //* sum of squared deviations from mean
+    double m2 = 0;
+    float min = INFINITY;
+    float max = -INFINITY;
+    uint32_t hist[nBins] = {};
 
-        this->siteValidCode[site] = 0;
+    //* adds the DUTs of other (pairwise update of Chan et al.)
+    void merge(const testMoments &other) {
+        if (other.n == 0)
+            return;
+        uint64_t nTot = this->n + other.n;
+        double delta = other.mean - this->mean;
+        this->mean += delta * ((double)other.n / nTot);
+        this->m2 += other.m2 + delta * delta * ((double)this->n * other.n / nTot);
+        this->n = nTot;
+        this->min = std::min(this->min, other.min);
+        this->max = std::max(this->max, other.max);
+        for (unsigned int ix = 0; ix < nBins; ++ix)
+            this->hist[ix] += other.hist[ix];
+    }
 
-        // note: parts are counted in the order they are reported / removed (PRR)
-        ++this->dutCountBaseZero;
+    //* sample standard deviation
+    double sigma() const {
+        return (this->n > 1) ? std::sqrt(this->m2 / (this->n - 1)) : NAN;
     }
+};
 
-    bool flush() {
-        bool retVal = false;
-        for (auto it = this->loggerTestitems.begin();
-             it != this->loggerTestitems.end(); ++it)
-            retVal |= it->second->flush();
-        retVal |= this->loggerSoftbin->flush();
-        retVal |= this->loggerHardbin->flush();
-        retVal |= this->loggerSite->flush();
-        retVal |= this->loggerPartId->flush();
-        retVal |= this->loggerPartTxt->flush();
-        return retVal;
+/** streaming statistics of one PTR test by site and by input file (resultTable background thread). Within a file, results are summed per site
+ * relative to the first result of the site (a few operations per result, numerically stable for the usual spread of a test), then folded into moments */
+class testStats {
+   public:
+    //* limits for the histogram. Only tests with limits collect statistics (PTR, not MPR)
+    void setLimits(float lowLim, float highLim) {
+        this->lowLim = lowLim;
+        this->highLim = highLim;
+        double range = (double)highLim - lowLim;
+        this->binScale = ((range > 0) && std::isfinite(range)) ? (testMoments::nBins - 2) / range : 0;
+        this->isActive = true;
     }
 
-    void close() {
-        for (unsigned int ix = 0; ix < this->siteValidCode.size(); ++ix)
-            if (this->siteValidCode[ix] != 0)
-                std::cerr << "Warning: site " << ix
-                          << " has no result (PIR without PRR)\n";
+    bool active() const {
+        return this->isActive;
+    }
 
-        for (auto it = this->loggerTestitems.begin();
-             it != this->loggerTestitems.end(); ++it)
-            it->second->close();
-        this->loggerSoftbin->close();
-        this->loggerHardbin->close();
-        this->loggerPartId->close();
-        this->loggerPartTxt->close();
-        this->loggerSite->close();
-        this->cmLog.close();
+    /** adds the results vals[rows[0..n-1]] of DUTs on site from input file (base 0, non-decreasing). NaN / infinite results are not counted.
+     * The k-th DUT of a site goes to partial sum k % nLanes (independent additions). The result does not depend on how rows are batched */
+    void add(const float *vals, const uint32_t *rows, size_t n, unsigned int site, unsigned int file) {
+        if (file != this->curFile)
+            this->fold(file);
+        if (site >= this->cur.size())
+            this->cur.resize(site + 1);
+        shiftedSums &s = this->cur[site];
+        for (size_t ix = 0; (ix < n) && (s.n == 0); ++ix)
+            if (std::isfinite(vals[rows[ix]])) {
+                s.shift = vals[rows[ix]];
+                break;
+            }
+        // local lane 0 continues partial sum s.nDuts % nLanes
+        const unsigned int nLanes = shiftedSums::nLanes;
+        unsigned int rot = (unsigned int)(s.nDuts % nLanes);
+        double sum[nLanes];
+        double sumSq[nLanes];
+        for (unsigned int lane = 0; lane < nLanes; ++lane) {
+            sum[lane] = s.sum[(rot + lane) % nLanes];
+            sumSq[lane] = s.sumSq[(rot + lane) % nLanes];
+        }
+        uint64_t nValid = 0;
+        double shift = s.shift;
+        float min = s.min;
+        float max = s.max;
+        size_t ix = 0;
+        auto step = [&](unsigned int lane) {
+            float val = vals[rows[ix]];
+            bool isValid = std::isfinite(val);
+            double d = isValid ? (double)val - shift : 0.0;
+            nValid += isValid;
+            sum[lane] += d;
+            sumSq[lane] += d * d;
+            min = std::min(min, isValid ? val : min);
+            max = std::max(max, isValid ? val : max);
+            if (isValid && (this->binScale > 0))
+                ++s.hist[this->bin(val)];
+        };
+        while (ix + nLanes <= n)
+            for (unsigned int lane = 0; lane < nLanes; ++lane, ++ix)
+                step(lane);
+        for (unsigned int lane = 0; ix < n; ++lane, ++ix)
+            step(lane);
+        for (unsigned int lane = 0; lane < nLanes; ++lane) {
+            s.sum[(rot + lane) % nLanes] = sum[lane];
+            s.sumSq[(rot + lane) % nLanes] = sumSq[lane];
+        }
+        s.nDuts += n;
+        s.n += nValid;
+        s.min = min;
+        s.max = max;
     }
 
-    void reportFile(string filename) {
-        this->cmLog.reportFile(filename,
-                               this->dutCountBaseZero - this->dutsReported);
-        this->dutsReported = this->dutCountBaseZero;
-        this->pwl.write(directory, this->filenumBase1);
+    //* completes the current file. The following results belong to file
+    void fold(unsigned int file) {
+        for (size_t site = 0; site < this->cur.size(); ++site) {
+            shiftedSums &s = this->cur[site];
+            if (s.n == 0)
+                continue;
+            testMoments m;
+            double sum = (s.sum[0] + s.sum[1]) + (s.sum[2] + s.sum[3]);
+            double sumSq = (s.sumSq[0] + s.sumSq[1]) + (s.sumSq[2] + s.sumSq[3]);
+            m.n = s.n;
+            m.mean = s.shift + sum / s.n;
+            m.m2 = std::max(sumSq - sum * sum / s.n, 0.0);
+            m.min = s.min;
+            m.max = s.max;
+            memcpy(m.hist, s.hist, sizeof(m.hist));
+            if (this->bySite.size() <= site)
+                this->bySite.resize(site + 1);
+            this->bySite[site].merge(m);
+            if (this->byFile.size() <= this->curFile)
+                this->byFile.resize(this->curFile + 1);
+            this->byFile[this->curFile].merge(m);
+            s = shiftedSums();
+        }
+        this->curFile = file;
+    }
+
+    //* moments by SITE_NUM (fold() first)
+    const std::vector<testMoments> &getBySite() const {
+        return this->bySite;
+    }
+
+    //* moments by input file (fold() first). Files without results may be missing at the end
+    const std::vector<testMoments> &getByFile() const {
+        return this->byFile;
+    }
+
+   protected:
+    unsigned int bin(float val) const {
+        if (val < this->lowLim)
+            return 0;
+        if (val > this->highLim)
+            return testMoments::nBins - 1;
+        return 1 + std::min((unsigned int)(((double)val - this->lowLim) * this->binScale), testMoments::nBins - 3);
+    }
+
+    //* results of the current file on one site, relative to shift
+    struct shiftedSums {
+        static const unsigned int nLanes = 4;
+        //* first result
+        double shift = 0;
+        //* DUTs, including those without a valid result
+        uint64_t nDuts = 0;
+        uint64_t n = 0;
+        double sum[nLanes] = {};
+        double sumSq[nLanes] = {};
+        float min = INFINITY;
+        float max = -INFINITY;
+        uint32_t hist[testMoments::nBins] = {};
+    };
+    bool isActive = false;
+    float lowLim = NAN;
+    float highLim = NAN;
+    //* histogram bins per unit (0: no histogram)
+    double binScale = 0;
+    unsigned int curFile = 0;
+    std::vector<shiftedSums> cur;
+    std::vector<testMoments> bySite;
+    std::vector<testMoments> byFile;
+};
+
+// =================
+// === bitColumn ===
+// =================
+//* packed bits, one per DUT: DUT ix is bit (ix & 7) of byte (ix >> 3)
+class bitColumn {
+   public:
+    void push(bool bit) {
+        this->partial |= (uint8_t)((unsigned int)bit << this->nPartial);
+        if (++this->nPartial == 8) {
+            this->bytes.push_back(this->partial);
+            this->partial = 0;
+            this->nPartial = 0;
+        }
+    }
+
+    //* appends n zero bits
+    void pad(uint64_t n) {
+        while ((n > 0) && (this->nPartial > 0)) {
+            this->push(false);
+            --n;
+        }
+        if (n == 0)
+            return;
+        this->bytes.resize(this->bytes.size() + (size_t)(n >> 3), 0);
+        this->nPartial = (unsigned int)(n & 7);
+    }
+
+    //* appends nBits bits packed as above (e.g. the contents of a .bits file)
+    void append(const uint8_t *src, uint64_t nBits) {
+        size_t nBytes = (size_t)(nBits >> 3);
+        if (this->nPartial == 0) {
+            this->bytes.insert(this->bytes.end(), src, src + nBytes);
+        } else {
+            for (size_t ix = 0; ix < nBytes; ++ix) {
+                this->bytes.push_back((uint8_t)(this->partial | (src[ix] << this->nPartial)));
+                this->partial = (uint8_t)(src[ix] >> (8 - this->nPartial));
+            }
+        }
+        for (unsigned int ix = 0; ix < (nBits & 7); ++ix)
+            this->push((src[nBytes] >> ix) & 1);
+    }
+
+    //* completes the last byte with zero bits (end of the column)
+    void finish() {
+        if (this->nPartial > 0)
+            this->pad(8 - this->nPartial);
+    }
+
+    //* complete bytes, until the caller clears them
+    std::vector<uint8_t> &getBytes() {
+        return this->bytes;
+    }
+
+   protected:
+    std::vector<uint8_t> bytes;
+    uint8_t partial = 0;
+    unsigned int nPartial = 0;
+};
+
+// ===================
+// === resultTable ===
+// ===================
+/** results of all tests for all DUTs. Tests are numbered by dense ordinals (order of first appearance). An MPR has one ordinal per pin.
+ * The parser thread stages results per site in a contiguous row with a validity bitset. At PRR, the whole row is handed to the
+ * background thread with a single lock, which transposes rows into one buffer per test and writes the (testnum).float / (testnum)_(pin).float files.
+ * The background thread also collects the statistics of each PTR test (see testStats) from the transposed buffers.
+ * With setBitmaps(), the TEST_FLG of each PTR result is staged alongside and written as (testnum).fail.bits / (testnum).tested.bits (see bitColumn) */
+class resultTable {
+   public:
+    //* ordinals of one MPR test
+    struct mprColumns {
+        std::vector<unsigned int> ordinalByPin;
+        //* ordinals are consecutive (results can be copied as one block)
+        bool isContiguous = true;
+    };
+
+    //* pin of PTR results
+    static const uint32_t noPin = 0xFFFFFFFF;
+    //* staged flags of a PTR result (see setFlags()). 0: no PTR
+    static const uint8_t flagTested = 1;
+    static const uint8_t flagFailed = 2;
+
+    resultTable(string dirname) {
+        this->directory = dirname;
+        this->rowBufPrimary = 0;
+        this->nRowsTransposed = 0;
+    }
+
+    //* result file name (without directory) of testnum, for MPR of its pin (position in RTN_RSLT, base 0)
+    static string columnName(unsigned int testnum, uint32_t pin) {
+        if (pin == noPin)
+            return std::to_string(testnum) + ".float";
+        return std::to_string(testnum) + "_" + std::to_string(pin) + ".float";
+    }
+
+    //* bitmap file name (without directory) of PTR testnum, kind "fail" or "tested"
+    static string bitsName(unsigned int testnum, const char *kind) {
+        return std::to_string(testnum) + "." + kind + ".bits";
+    }
+
+    /** returns the ordinal for testnum of the DUT on site (site < 0: outside PIR / PRR), creating it if new (parser thread).
+     * isNew: first occurrence of testnum */
+    unsigned int getOrdinal(int site, unsigned int testnum, bool &isNew) {
+        unsigned int ordinal = (site >= 0) ? this->resolver.resolve(site, testnum, isNew) : this->resolver.lookup(testnum, isNew);
+        if (isNew)
+            this->addColumn(testnum, noPin);
+        return ordinal;
+    }
+
+    /** returns the ordinals of MPR testnum for the DUT on site (site < 0: outside PIR / PRR), with at least nPins pins (parser thread).
+     * isNew: first occurrence of testnum */
+    const mprColumns &getMprColumns(int site, unsigned int testnum, unsigned int nPins, bool &isNew) {
+        unsigned int ix = (site >= 0) ? this->mprResolver.resolve(site, testnum, isNew) : this->mprResolver.lookup(testnum, isNew);
+        if (isNew)
+            this->mprs.push_back(mprColumns());
+        mprColumns &mpr = this->mprs[ix];
+        while (mpr.ordinalByPin.size() < nPins) {
+            // note: pins added later (MPR with more results) are not contiguous to the existing ones, if other tests appeared in between
+            unsigned int ordinal = this->resolver.addOrdinal(testnum);
+            if (!mpr.ordinalByPin.empty() && (ordinal != mpr.ordinalByPin.back() + 1))
+                mpr.isContiguous = false;
+            mpr.ordinalByPin.push_back(ordinal);
+            this->addColumn(testnum, (uint32_t)mpr.ordinalByPin.size() - 1);
+        }
+        return mpr;
+    }
+
+    //* limits of PTR testnum, which has an ordinal (parser thread). Enables its statistics
+    void setLimits(unsigned int testnum, float lowLim, float highLim) {
+        bool isNew;
+        unsigned int ordinal = this->resolver.lookup(testnum, isNew);
+        std::lock_guard<std::mutex> lk(this->m);
+        this->newLimits.push_back(std::make_pair(ordinal, std::make_pair(lowLim, highLim)));
+    }
+
+    //* the input file ends after nDuts DUTs in total (counting all files)
+    void endFile(uint64_t nDuts) {
+        std::lock_guard<std::mutex> lk(this->m);
+        this->fileEnds.push_back(nDuts);
+    }
+
+    //* writes block-encoded columns (see STDFooCodec.hpp) to (name).float.blk instead. Call before the first test
+    void setCompress() {
+        this->isCompressed = true;
+    }
+
+    //* writes the per-test pass / fail bitmaps (see setFlags()). Call before the first test
+    void setBitmaps() {
+        this->isBitmaps = true;
+    }
+
+    bool hasBitmaps() const {
+        return this->isBitmaps;
+    }
+
+    //* starts a new DUT on site (parser thread)
+    void beginDut(unsigned int site) {
+        this->clearSite(site);
+        this->resolver.beginDut(site);
+        this->mprResolver.beginDut(site);
+    }
+
+    //* stages the result of one test for the DUT on site (parser thread)
+    void set(unsigned int site, unsigned int ordinal, float val) {
+        if (site >= this->siteVals.size()) {
+            this->siteVals.resize(site + 1);
+            this->siteValid.resize(site + 1);
+            this->siteFlags.resize(site + 1);
+        }
+        std::vector<float> &vals = this->siteVals[site];
+        std::vector<uint64_t> &valid = this->siteValid[site];
+        if (ordinal >= vals.size())
+            vals.resize(this->resolver.size(), std::nanf(""));
+        if ((ordinal >> 6) >= valid.size())
+            valid.resize((this->resolver.size() + 63) >> 6, 0);
+        vals[ordinal] = val;
+        valid[ordinal >> 6] |= (uint64_t)1 << (ordinal & 63);
+    }
+
+    //* stages the flags (flagTested, flagFailed) of the PTR result at ordinal, after set() (parser thread, only with setBitmaps())
+    void setFlags(unsigned int site, unsigned int ordinal, uint8_t flags) {
+        std::vector<uint8_t> &f = this->siteFlags[site];
+        if (ordinal >= f.size())
+            f.resize(this->resolver.size(), 0);
+        f[ordinal] = flags;
+    }
+
+    //* stages n results (unaligned floats e.g. MPR RTN_RSLT) of consecutive ordinals for the DUT on site (parser thread)
+    void setRange(unsigned int site, unsigned int firstOrdinal, const unsigned char *src, size_t n) {
+        if (n == 0)
+            return;
+        if (site >= this->siteVals.size()) {
+            this->siteVals.resize(site + 1);
+            this->siteValid.resize(site + 1);
+            this->siteFlags.resize(site + 1);
+        }
+        std::vector<float> &vals = this->siteVals[site];
+        std::vector<uint64_t> &valid = this->siteValid[site];
+        size_t end = firstOrdinal + n;
+        if (end > vals.size())
+            vals.resize(this->resolver.size(), std::nanf(""));
+        if (((end + 63) >> 6) > valid.size())
+            valid.resize((this->resolver.size() + 63) >> 6, 0);
+        memcpy(&vals[firstOrdinal], src, n * sizeof(float));
+
+        // === validity bits firstOrdinal..end-1, one word at a time ===
+        for (size_t ix = firstOrdinal; ix < end; ix = (ix | 63) + 1) {
+            size_t nBits = std::min(end - ix, 64 - (ix & 63));
+            uint64_t mask = (nBits == 64) ? ~(uint64_t)0 : (((uint64_t)1 << nBits) - 1);
+            valid[ix >> 6] |= mask << (ix & 63);
+        }
+    }
+
+    //* discards the staged results of site, resetting only entries that were set (parser thread)
+    void clearSite(unsigned int site) {
+        if (site >= this->siteVals.size())
+            return;
+        std::vector<float> &vals = this->siteVals[site];
+        std::vector<uint64_t> &valid = this->siteValid[site];
+        std::vector<uint8_t> &flags = this->siteFlags[site];
+        for (size_t ixWord = 0; ixWord < valid.size(); ++ixWord) {
+            uint64_t w = valid[ixWord];
+            while (w) {
+                size_t ordinal = (ixWord << 6) + countTrailingZeros(w);
+                vals[ordinal] = std::nanf("");
+                if (ordinal < flags.size())
+                    flags[ordinal] = 0;
+                w &= w - 1;  // clear lowest set bit
+            }
+            valid[ixWord] = 0;
+        }
+    }
+
+    //* returns the staged results of site (all ordinals, NaN if not set) (parser thread)
+    const float *getRow(unsigned int site) {
+        if (site >= this->siteVals.size()) {
+            this->siteVals.resize(site + 1);
+            this->siteValid.resize(site + 1);
+            this->siteFlags.resize(site + 1);
+        }
+        this->siteVals[site].resize(this->resolver.size(), std::nanf(""));
+        return this->siteVals[site].data();
+    }
+
+    //* appends the staged results of site as the next DUT and clears the site (parser thread)
+    void emitRow(unsigned int site) {
+        const float *row = this->getRow(site);
+        size_t n = this->resolver.size();
+        {
+            std::lock_guard<std::mutex> lk(this->m);
+            std::vector<float> &b = this->rowBuf[this->rowBufPrimary];
+            b.insert(b.end(), row, row + n);
+            this->rowLen[this->rowBufPrimary].push_back((unsigned int)n);
+            this->rowSite[this->rowBufPrimary].push_back(site);
+            if (this->isBitmaps) {
+                std::vector<uint8_t> &f = this->siteFlags[site];
+                f.resize(n, 0);
+                this->flagBuf[this->rowBufPrimary].insert(this->flagBuf[this->rowBufPrimary].end(), f.begin(), f.end());
+            }
+        }
+        this->clearSite(site);
+    }
+
+    //* number of tests known to the background thread
+    size_t getNColumns() {
+        return this->colFilenames.size();
+    }
+
+    //* number of tests
+    size_t getNOrdinals() {
+        return this->resolver.size();
+    }
+
+    //* TEST_NUM by ordinal (parser thread)
+    const std::vector<unsigned int> &getTestnumByOrdinal() {
+        return this->resolver.getTestnumByOrdinal();
+    }
+
+    //* MPR pin by ordinal, noPin for PTR (parser thread)
+    const std::vector<uint32_t> &getPinByOrdinal() {
+        return this->pinByOrdinal;
+    }
+
+    //* TEST_NUM of all MPR tests (parser thread)
+    const std::vector<unsigned int> &getMprTestnums() {
+        return this->mprResolver.getTestnumByOrdinal();
+    }
+
+    //* number of pins of the MPR test with the given index in getMprTestnums() (parser thread)
+    size_t getMprNPins(size_t ix) {
+        return this->mprs[ix].ordinalByPin.size();
+    }
+
+    /** transposes staged rows and writes all test buffers with at least nMin results (background thread). nMin = 0: write all, create files even if empty.
+     * Returns true if data was written */
+    bool flush(fileHandlePool &pool, size_t nMin) {
+        bool retVal = this->transpose();
+        for (size_t ordinal = 0; ordinal < this->colBuf.size(); ++ordinal) {
+            std::vector<float> &c = this->colBuf[ordinal];
+            bool create = !this->colCreated[ordinal];
+            if ((c.size() < std::max(nMin, (size_t)1)) && !(create && (nMin == 0)))
+                continue;
+            FILE *h = pool.get(this->colFilenames[ordinal], create);
+            this->colCreated[ordinal] = true;
+            if (this->isCompressed) {
+                // completed blocks (the first write also creates the header)
+                this->colEncoder[ordinal].add(c.data(), c.size(), this->encoded);
+                pool.write(h, this->encoded.data(), this->encoded.size(), this->colFilenames[ordinal]);
+                this->encoded.clear();
+            } else if (c.size() > 0) {
+                pool.write(h, c.data(), c.size() * sizeof(float), this->colFilenames[ordinal]);
+            }
+            c.clear();
+            if (this->isBitmaps && !this->colBitsNames[ordinal].empty()) {
+                this->writeBits(pool, ordinal, this->colFailed[ordinal], "fail", create);
+                this->writeBits(pool, ordinal, this->colTested[ordinal], "tested", create);
+            }
+            retVal = true;
+        }
+        return retVal;
+    }
+
+    //* statistics of ordinal (after close(). Only active() for PTR tests)
+    const testStats &getStats(size_t ordinal) {
+        return this->colStats[ordinal];
+    }
+
+    //* writes all remaining results. Creates all files (background thread, or after it has finished)
+    void close(fileHandlePool &pool) {
+        this->flush(pool, 0);
+        for (auto it = this->colStats.begin(); it != this->colStats.end(); ++it)
+            it->fold(0);
+        for (size_t ordinal = 0; ordinal < this->colBitsNames.size(); ++ordinal) {
+            if (!this->isBitmaps || this->colBitsNames[ordinal].empty())
+                continue;
+            this->colFailed[ordinal].finish();
+            this->writeBits(pool, ordinal, this->colFailed[ordinal], "fail", false);
+            this->colTested[ordinal].finish();
+            this->writeBits(pool, ordinal, this->colTested[ordinal], "tested", false);
+        }
+        if (!this->isCompressed)
+            return;
+        for (size_t ordinal = 0; ordinal < this->colEncoder.size(); ++ordinal) {
+            this->colEncoder[ordinal].finish(this->encoded);
+            pool.write(pool.get(this->colFilenames[ordinal], false), this->encoded.data(), this->encoded.size(), this->colFilenames[ordinal]);
+            this->encoded.clear();
+        }
+    }
+
+   protected:
+    //* result file for the next ordinal (parser thread)
+    void addColumn(unsigned int testnum, uint32_t pin) {
+        this->pinByOrdinal.push_back(pin);
+        std::lock_guard<std::mutex> lk(this->m);
+        this->filenames.push_back(this->directory + "/" + columnName(testnum, pin) + (this->isCompressed ? ".blk" : ""));
+        this->bitsNames.push_back((pin == noPin) ? this->directory + "/" + std::to_string(testnum) : string());
+    }
+
+    //* writes the complete bytes of a bitmap of ordinal (background thread)
+    void writeBits(fileHandlePool &pool, size_t ordinal, bitColumn &bits, const char *kind, bool create) {
+        const string fname = this->colBitsNames[ordinal] + "." + kind + ".bits";
+        std::vector<uint8_t> &bytes = bits.getBytes();
+        FILE *h = pool.get(fname, create);
+        if (!bytes.empty())
+            pool.write(h, bytes.data(), bytes.size(), fname);
+        bytes.clear();
+    }
+
+    static unsigned int countTrailingZeros(uint64_t w) {
+#ifdef __GNUC__
+        return __builtin_ctzll(w);
+#else
+        unsigned int n = 0;
+        while (!((w >> n) & 1))
+            ++n;
+        return n;
+#endif
+    }
+
+    //* rows groupRows[start..start + n - 1] of one transposed batch: DUTs of site from input file
+    struct statsGroup {
+        size_t start;
+        size_t n;
+        unsigned int site;
+        unsigned int file;
+    };
+
+    //* moves staged rows into per-test buffers (background thread). Returns true if there were any
+    bool transpose() {
+        std::vector<float> *rows;
+        std::vector<unsigned int> *lens;
+        std::vector<unsigned int> *sites;
+        std::vector<uint8_t> *flags;
+        {  // === swap buffers, pick up new tests, limits, file ends ===
+            std::lock_guard<std::mutex> lk(this->m);
+            for (size_t ix = this->colFilenames.size(); ix < this->filenames.size(); ++ix) {
+                this->colFilenames.push_back(this->filenames[ix]);
+                this->colBitsNames.push_back(this->bitsNames[ix]);
+            }
+            this->colStats.resize(this->colFilenames.size());
+            for (auto it = this->newLimits.begin(); it != this->newLimits.end(); ++it)
+                this->colStats[it->first].setLimits(it->second.first, it->second.second);
+            this->newLimits.clear();
+            this->colFileEnds.insert(this->colFileEnds.end(), this->fileEnds.begin() + this->colFileEnds.size(), this->fileEnds.end());
+            rows = &this->rowBuf[this->rowBufPrimary];
+            lens = &this->rowLen[this->rowBufPrimary];
+            sites = &this->rowSite[this->rowBufPrimary];
+            flags = &this->flagBuf[this->rowBufPrimary];
+            this->rowBufPrimary = (this->rowBufPrimary + 1) & 1;
+        }
+        size_t nOrdinals = this->colFilenames.size();
+        this->colBuf.resize(nOrdinals);
+        this->colNDuts.resize(nOrdinals, 0);
+        this->colCreated.resize(nOrdinals, false);
+        if (this->isCompressed)
+            this->colEncoder.resize(nOrdinals);
+        if (this->isBitmaps) {
+            this->colFailed.resize(nOrdinals);
+            this->colTested.resize(nOrdinals);
+        }
+        if (lens->empty())
+            return false;
+
+        // === one test at a time (sequential writes into its buffer) ===
+        // note: row lengths are non-decreasing (tests are only added)
+        size_t nRows = lens->size();
+        unsigned int nMax = lens->back();
+        std::vector<size_t> rowStart(nRows);
+        size_t pos = 0;
+        for (size_t ixRow = 0; ixRow < nRows; ++ixRow) {
+            rowStart[ixRow] = pos;
+            pos += (*lens)[ixRow];
+        }
+        // rows grouped by input file, then site (stable), for the statistics
+        std::vector<uint32_t> groupRows(nRows);
+        std::vector<statsGroup> groups;
+        size_t ixRunStart = 0;
+        while (ixRunStart < nRows) {
+            while ((this->nFilesEnded < this->colFileEnds.size()) && (this->colFileEnds[this->nFilesEnded] <= this->nRowsTransposed + ixRunStart))
+                ++this->nFilesEnded;
+            size_t ixRunEnd = nRows;
+            if (this->nFilesEnded < this->colFileEnds.size())
+                ixRunEnd = (size_t)std::min((uint64_t)nRows, this->colFileEnds[this->nFilesEnded] - this->nRowsTransposed);
+            unsigned int nSites = 0;
+            for (size_t ixRow = ixRunStart; ixRow < ixRunEnd; ++ixRow)
+                nSites = std::max(nSites, (*sites)[ixRow] + 1);
+            std::vector<size_t> siteStart(nSites + 1, 0);
+            for (size_t ixRow = ixRunStart; ixRow < ixRunEnd; ++ixRow)
+                ++siteStart[(*sites)[ixRow] + 1];
+            for (unsigned int site = 0; site < nSites; ++site) {
+                if (siteStart[site + 1] > 0)
+                    groups.push_back(statsGroup{ixRunStart + siteStart[site], siteStart[site + 1], site, (unsigned int)this->nFilesEnded});
+                siteStart[site + 1] += siteStart[site];
+            }
+            for (size_t ixRow = ixRunStart; ixRow < ixRunEnd; ++ixRow)
+                groupRows[ixRunStart + siteStart[(*sites)[ixRow]]++] = (uint32_t)ixRow;
+            ixRunStart = ixRunEnd;
+        }
+        std::vector<uint32_t> partialRows;  // groupRows for tests that appeared within this batch
+        size_t ixFirstRow = 0;  // first row that contains the current ordinal
+        for (unsigned int ordinal = 0; ordinal < nMax; ++ordinal) {
+            while ((*lens)[ixFirstRow] <= ordinal)
+                ++ixFirstRow;
+            std::vector<float> &c = this->colBuf[ordinal];
+            // NaN for DUTs before the test appeared
+            uint64_t nDutsBefore = this->nRowsTransposed + ixFirstRow;
+            const bool isBits = this->isBitmaps && !this->colBitsNames[ordinal].empty();
+            if (this->colNDuts[ordinal] < nDutsBefore) {
+                c.resize(c.size() + (nDutsBefore - this->colNDuts[ordinal]), std::nanf(""));
+                if (isBits) {
+                    this->colFailed[ordinal].pad(nDutsBefore - this->colNDuts[ordinal]);
+                    this->colTested[ordinal].pad(nDutsBefore - this->colNDuts[ordinal]);
+                }
+                this->colNDuts[ordinal] = nDutsBefore;
+            }
+            const float *src = rows->data();
+            for (size_t ixRow = ixFirstRow; ixRow < nRows; ++ixRow)
+                c.push_back(src[rowStart[ixRow] + ordinal]);
+            if (isBits) {
+                bitColumn &failed = this->colFailed[ordinal];
+                bitColumn &tested = this->colTested[ordinal];
+                const uint8_t *f = flags->data();
+                for (size_t ixRow = ixFirstRow; ixRow < nRows; ++ixRow) {
+                    uint8_t rowFlags = f[rowStart[ixRow] + ordinal];
+                    failed.push((rowFlags & flagFailed) != 0);
+                    tested.push((rowFlags & flagTested) != 0);
+                }
+            }
+            this->colNDuts[ordinal] += nRows - ixFirstRow;
+
+            testStats &st = this->colStats[ordinal];
+            if (st.active()) {
+                // vals and groupRows both start at ixFirstRow
+                const float *vals = c.data() + c.size() - (nRows - ixFirstRow);
+                for (auto it = groups.begin(); it != groups.end(); ++it) {
+                    const uint32_t *rowIx = groupRows.data() + it->start;
+                    size_t n = it->n;
+                    if (ixFirstRow > 0) {
+                        partialRows.clear();
+                        for (size_t ix = 0; ix < it->n; ++ix)
+                            if (rowIx[ix] >= ixFirstRow)
+                                partialRows.push_back(rowIx[ix] - (uint32_t)ixFirstRow);
+                        rowIx = partialRows.data();
+                        n = partialRows.size();
+                    }
+                    st.add(vals, rowIx, n, it->site, it->file);
+                }
+            }
+        }
+        this->nRowsTransposed += nRows;
+        rows->clear();
+        lens->clear();
+        sites->clear();
+        flags->clear();
+        return true;
+    }
+
+    string directory;
+
+    // === parser thread ===
+    testnumResolver resolver;
+    //* MPR TEST_NUM to index into mprs
+    testnumResolver mprResolver;
+    std::vector<mprColumns> mprs;
+    std::vector<uint32_t> pinByOrdinal;
+    //* staged results per site, by ordinal (NaN if not set)
+    std::vector<std::vector<float>> siteVals;
+    //* validity bitset per site (bit set: siteVals entry needs to be reset)
+    std::vector<std::vector<uint64_t>> siteValid;
+    //* staged PTR flags per site, by ordinal (see setFlags(). Only with setBitmaps())
+    std::vector<std::vector<uint8_t>> siteFlags;
+
+    // === shared (protected by m) ===
+    std::mutex m;
+    //* rows of all tests per DUT (double buffered)
+    std::vector<float> rowBuf[2];
+    //* number of tests in each row
+    std::vector<unsigned int> rowLen[2];
+    //* site of each row
+    std::vector<unsigned int> rowSite[2];
+    //* flags of all tests per DUT, as rowBuf (only with setBitmaps())
+    std::vector<uint8_t> flagBuf[2];
+    unsigned int rowBufPrimary;
+    //* output file by ordinal
+    std::vector<string> filenames;
+    //* bitmap files by ordinal, without ".fail.bits" / ".tested.bits" (empty for MPR)
+    std::vector<string> bitsNames;
+    //* limits by ordinal, not yet seen by the background thread
+    std::vector<std::pair<unsigned int, std::pair<float, float>>> newLimits;
+    //* number of DUTs at the end of each input file
+    std::vector<uint64_t> fileEnds;
+
+    // === background thread ===
+    //* copy of filenames
+    std::vector<string> colFilenames;
+    //* unwritten results by ordinal
+    std::vector<std::vector<float>> colBuf;
+    //* number of DUTs in colBuf and file, by ordinal
+    std::vector<uint64_t> colNDuts;
+    std::vector<bool> colCreated;
+    uint64_t nRowsTransposed;
+    //* statistics by ordinal
+    std::vector<testStats> colStats;
+    //* copy of fileEnds
+    std::vector<uint64_t> colFileEnds;
+    //* input files that end before the next row
+    size_t nFilesEnded = 0;
+    //* see setCompress()
+    bool isCompressed = false;
+    std::vector<stdfooCodec::blockEncoder<float>> colEncoder;
+    std::vector<unsigned char> encoded;
+    //* see setBitmaps()
+    bool isBitmaps = false;
+    //* copy of bitsNames
+    std::vector<string> colBitsNames;
+    //* unwritten bitmaps by ordinal
+    std::vector<bitColumn> colFailed;
+    std::vector<bitColumn> colTested;
+};
+
+// =======================
+// === containerWriter ===
+// =======================
+/** writes "container.stdfoo" (layout see commonLogger::writeContainer()) region by region, each starting at a multiple of alignment.
+ * Regions come from memory, or from a file. On Linux, files are copied by the kernel (copy_file_range: no pass through user space,
+ * a shared extent instead of a copy on filesystems with reflinks e.g. XFS, btrfs). */
+class containerWriter {
+   public:
+    static const uint64_t alignment = 4096;
+
+    containerWriter(const string &fname) : buf(1 << 20, 0) {
+        this->dest = fopen(fname.c_str(), "wb");
+        if (!this->dest) {
+            cerr << "Failed to open '" << fname << "' for write" << endl;
+            fail("");
+        }
+        this->pos = alignment;  // header is written last
+        if (fseek(this->dest, (long)this->pos, SEEK_SET))
+            fail("container: seek failed");
+    }
+
+    //* adds region name with n bytes from data
+    void add(const string &name, const void *data, uint64_t n) {
+        if (fwrite(data, 1, n, this->dest) != n)
+            fail("container: write failed");
+        this->endRegion(name, n);
+    }
+
+    //* adds region name with the contents of file fname. Returns false if it does not exist
+    bool addFile(const string &name, const string &fname) {
+        FILE *src = fopen(fname.c_str(), "rb");
+        if (!src)
+            return false;
+        uint64_t nBytes = 0;
+#ifdef __linux__
+        if (fflush(this->dest))
+            fail("container: write failed");
+        loff_t offSrc = 0;
+        loff_t offDest = (loff_t)this->pos;
+        ssize_t n;
+        while ((n = copy_file_range(fileno(src), &offSrc, fileno(this->dest), &offDest, (size_t)1 << 30, 0)) > 0)
+            nBytes += (uint64_t)n;
+        // note: fails on the first call if unsupported (e.g. old kernel, across filesystems), then copies below
+        if ((n < 0) && (nBytes > 0))
+            fail("container: write failed");
+        if ((nBytes > 0) && fseeko(this->dest, (off_t)(this->pos + nBytes), SEEK_SET))
+            fail("container: seek failed");
+#endif
+        if (nBytes == 0) {
+            while (size_t n = fread(this->buf.data(), 1, this->buf.size(), src)) {
+                if (fwrite(this->buf.data(), 1, n, this->dest) != n)
+                    fail("container: write failed");
+                nBytes += n;
+            }
+        }
+        fclose(src);
+        this->endRegion(name, nBytes);
+        return true;
+    }
+
+    //* writes manifest and header
+    void close() {
+        string m = this->manifest.str();
+        if (fwrite(m.data(), 1, m.size(), this->dest) != m.size())
+            fail("container: write failed");
+        unsigned char header[48] = {0};
+        memcpy(header, "STDFooCt", 8);
+        uint32_t version = 1;
+        uint32_t alignment32 = (uint32_t)alignment;
+        uint64_t manifestSize = m.size();
+        memcpy(header + 8, &version, 4);
+        memcpy(header + 12, &alignment32, 4);
+        memcpy(header + 16, &this->pos, 8);
+        memcpy(header + 24, &manifestSize, 8);
+        memcpy(header + 32, &this->nEntries, 8);
+        if (fseek(this->dest, 0, SEEK_SET) || (fwrite(header, 1, sizeof(header), this->dest) != sizeof(header)) || fclose(this->dest))
+            fail("container: write failed");
+    }
+
+   protected:
+    //* lists the region of nBytes written at pos in the manifest, pads to alignment
+    void endRegion(const string &name, uint64_t nBytes) {
+        this->manifest << name << "\t" << this->pos << "\t" << nBytes << "\n";
+        ++this->nEntries;
+        uint64_t nPad = (alignment - (this->pos + nBytes) % alignment) % alignment;
+        std::fill(this->buf.begin(), this->buf.begin() + nPad, 0);
+        if (fwrite(this->buf.data(), 1, nPad, this->dest) != nPad)
+            fail("container: write failed");
+        this->pos += nBytes + nPad;
+    }
+    FILE *dest;
+    //* start of the next region
+    uint64_t pos;
+    //* one "name \t offset \t size \n" line per region
+    std::stringstream manifest;
+    uint64_t nEntries = 0;
+    //* copy buffer, padding
+    std::vector<char> buf;
+};
+
+// ====================
+// === commonLogger ===
+// ====================
+/** writes items common to all DUTs (testnumber, testnames, limits, units). Can afford one filehandle per item. */
+class commonLogger {
+   public:
+    commonLogger(string dirname) {
+        this->directory = dirname;
+    }
+
+    //* checks for first occurrence of testnum PTR
+    bool isLogged(unsigned int testnum) {
+        // STDF standard: "The first occurrence of this record also establishes the default values for all semi-static information about the test, such as limits, units, and scaling."
+        // note: when parsing, resultTable reports the first occurrence (one lookup per PTR)
+        return this->loggedTests.find(testnum) != this->loggedTests.end();
+    }
+
+    //* checks for first occurrence of testnum MPR
+    bool isMprLogged(unsigned int testnum) {
+        return this->mprTests.find(testnum) != this->mprTests.end();
+    }
+
+    //* records default values from first occurrence of MPR record. Thread-safe (parse shards)
+    void logMpr(unsigned int testnum, float lowLim, float highLim, string testname, string unit) {
+        std::lock_guard<std::mutex> lk(this->logMutex);
+        mprInfo &i = this->mprTests[testnum];
+        i.lowLim = lowLim;
+        i.highLim = highLim;
+        i.testname = testname;
+        i.unit = unit;
+    }
+
+    //* number of pins (results per MPR record) of MPR testnum. Keeps the largest value
+    void setMprPins(unsigned int testnum, unsigned int nPins) {
+        mprInfo &i = this->mprTests[testnum];
+        i.nPins = std::max(i.nPins, nPins);
+    }
+
+    //* records default values from first occurrence of PTR record. Thread-safe (parse shards)
+    void log(unsigned int testnum, float lowLim, float highLim, string testname,
+             string unit) {
+        std::lock_guard<std::mutex> lk(this->logMutex);
+        this->lowLim[testnum] = lowLim;
+        this->highLim[testnum] = highLim;
+        this->testname[testnum] = testname;
+        this->unit[testnum] = unit;
+        this->loggedTests.insert(testnum);
+    }
+
+    /** adds the statistics of PTR testnum by input file (starting at file ixFirstFile, base 0) and by SITE_NUM. Moments of the same
+     * file / site are merged (e.g. --append) */
+    void addStats(unsigned int testnum, size_t ixFirstFile, const std::vector<testMoments> &byFile, const std::vector<testMoments> &bySite) {
+        testGroups &g = this->stats[testnum];
+        if (g.byFile.size() < ixFirstFile + byFile.size())
+            g.byFile.resize(ixFirstFile + byFile.size());
+        for (size_t ix = 0; ix < byFile.size(); ++ix)
+            g.byFile[ixFirstFile + ix].merge(byFile[ix]);
+        if (g.bySite.size() < bySite.size())
+            g.bySite.resize(bySite.size());
+        for (size_t ix = 0; ix < bySite.size(); ++ix)
+            g.bySite[ix].merge(bySite[ix]);
+    }
+
+    //* adds the number of DUTs by SITE_NUM
+    void addSiteDuts(const std::vector<uint64_t> &dutsBySite) {
+        if (this->dutsBySite.size() < dutsBySite.size())
+            this->dutsBySite.resize(dutsBySite.size(), 0);
+        for (size_t ix = 0; ix < dutsBySite.size(); ++ix)
+            this->dutsBySite[ix] += dutsBySite[ix];
+    }
+
+    //* statistics are incomplete (e.g. merged results from an earlier version): close() removes stats.* instead of writing them
+    void setNoStats() {
+        this->hasStats = false;
+    }
+
+    //* writes collected data to files */
+    void close() {
+        if (this->isContainer)
+            this->container.reset(new containerWriter(this->directory + "/container.stdfoo"));
+
+        // === copy testnums to sorted set ===
+        std::set<unsigned int> testnums;
+        for (auto it = this->loggedTests.begin(); it != this->loggedTests.end();
+             ++it) {
+            testnums.insert(*it);
+        }
+
+        this->openHandle("testnums.uint32");
+        for (auto it = testnums.begin(); it != testnums.end(); ++it) {
+            uint32_t tmp = *it;
+            this->h.write((const char *)&tmp, sizeof(tmp));
+        }
+        this->closeHandle();
+
+        this->openHandle("testnames.txt");
+        for (auto it = testnums.begin(); it != testnums.end(); ++it)
+            this->h << this->testname[*it] << "\n";
+        this->closeHandle();
+
+        this->openHandle("units.txt");
+        for (auto it = testnums.begin(); it != testnums.end(); ++it)
+            this->h << this->unit[*it] << "\n";
+        this->closeHandle();
+
+        this->openHandle("lowLim.float");
+        for (auto it = testnums.begin(); it != testnums.end(); ++it) {
+            float tmp = this->lowLim[*it];
+            this->h.write((const char *)&tmp, sizeof(tmp));
+        }
+        this->closeHandle();
+
+        this->openHandle("highLim.float");
+        for (auto it = testnums.begin(); it != testnums.end(); ++it) {
+            float tmp = this->highLim[*it];
+            this->h.write((const char *)&tmp, sizeof(tmp));
+        }
+        this->closeHandle();
+
+        this->openHandle("filenames.txt");
+        for (auto it = this->filenames.begin(); it != this->filenames.end();
+             ++it)
+            this->h << *it << "\n";
+        this->closeHandle();
+
+        this->openHandle("dutsPerFile.uint32");
+        for (auto it = this->dutsPerFile.begin(); it != this->dutsPerFile.end();
+             ++it) {
+            uint32_t tmp = *it;
+            this->h.write((const char *)&tmp, sizeof(tmp));
+        }
+        this->closeHandle();
+
+        // human-readable file / lot summary in csv format
+        this->openHandle("filelist.txt");
+        this->h << "filename\tnDuts\n";
+        for (unsigned int ix = 0; ix < this->filenames.size(); ++ix)
+            this->h << this->filenames[ix] << "\t" << this->dutsPerFile[ix]
+                    << "\n";
+        this->closeHandle();
+
+        // human-readable summary in csv format
+        this->openHandle("testlist.txt");
+        this->h.precision(9);
+        this->h << "TEST_NUM\tTEST_TXT\tUNITS\tLO_LIMIT\tHI_LIMIT\n";
+        for (auto it = testnums.begin(); it != testnums.end(); ++it) {
+            this->h << (*it) << "\t"                //
+                    << this->testname[*it] << "\t"  //
+                    << this->unit[*it] << "\t"      //
+                    << this->lowLim[*it] << "\t"    //
+                    << this->highLim[*it] << "\n";
+        }
+        this->closeHandle();
+
+        // === MPR tests (ascending TEST_NUM) ===
+        this->openHandle("mprTestnums.uint32");
+        for (auto it = this->mprTests.begin(); it != this->mprTests.end(); ++it) {
+            uint32_t tmp = it->first;
+            this->h.write((const char *)&tmp, sizeof(tmp));
+        }
+        this->closeHandle();
+
+        this->openHandle("mprPins.uint32");
+        for (auto it = this->mprTests.begin(); it != this->mprTests.end(); ++it) {
+            uint32_t tmp = it->second.nPins;
+            this->h.write((const char *)&tmp, sizeof(tmp));
+        }
+        this->closeHandle();
+
+        this->openHandle("mprTestnames.txt");
+        for (auto it = this->mprTests.begin(); it != this->mprTests.end(); ++it)
+            this->h << it->second.testname << "\n";
+        this->closeHandle();
+
+        this->openHandle("mprUnits.txt");
+        for (auto it = this->mprTests.begin(); it != this->mprTests.end(); ++it)
+            this->h << it->second.unit << "\n";
+        this->closeHandle();
+
+        this->openHandle("mprLowLim.float");
+        for (auto it = this->mprTests.begin(); it != this->mprTests.end(); ++it)
+            this->h.write((const char *)&it->second.lowLim, sizeof(float));
+        this->closeHandle();
+
+        this->openHandle("mprHighLim.float");
+        for (auto it = this->mprTests.begin(); it != this->mprTests.end(); ++it)
+            this->h.write((const char *)&it->second.highLim, sizeof(float));
+        this->closeHandle();
+
+        this->writeStats(testnums);
+
+        if (this->container)
+            this->writeContainer(testnums);
+    }
+
+    //* close() packs all results into a single container file (see writeContainer())
+    void setContainer(bool isContainer) {
+        this->isContainer = isContainer;
+    }
+
+    //* reports the end of an input file, how many DUTs it contains
+    void reportFile(string filename, unsigned int dutsPerFile) {
+        this->filenames.push_back(filename);
+        this->dutsPerFile.push_back(dutsPerFile);
+    }
+
+    //* stats.(level).(name) files, for levels "" (all DUTs), "site." and "file."
+    static std::vector<string> statsFilenames() {
+        const char *levels[] = {"", "site.", "file."};
+        const char *names[] = {"count.uint64", "nan.uint64", "mean.double", "sigma.double", "m2.double", "min.float", "max.float", "cpk.double", "hist.uint32"};
+        std::vector<string> retVal = {"stats.sites.uint8", "stats.siteDuts.uint64"};
+        for (auto level : levels)
+            for (auto name : names)
+                retVal.push_back(string("stats.") + level + name);
+        return retVal;
+    }
+
+   protected:
+    /** writes the statistics of all PTR tests, aligned with testnums.uint32. Per site (stats.sites.uint8) and per input file, the groups
+     * of a test are consecutive: entry ixTest * nGroups + ixGroup. See testMoments */
+    void writeStats(const std::set<unsigned int> &testnums) {
+        if (!this->hasStats) {
+            std::vector<string> names = statsFilenames();
+            for (auto it = names.begin(); it != names.end(); ++it)
+                remove((this->directory + "/" + *it).c_str());
+            cout << "note: stats.* not written (results without statistics, e.g. cache entries from an earlier version)" << endl;
+            return;
+        }
+
+        // === sites with DUTs ===
+        std::vector<unsigned int> sites;
+        this->openHandle("stats.sites.uint8");
+        for (unsigned int site = 0; site < this->dutsBySite.size(); ++site) {
+            if (this->dutsBySite[site] == 0)
+                continue;
+            sites.push_back(site);
+            uint8_t tmp = (uint8_t)site;
+            this->h.write((const char *)&tmp, sizeof(tmp));
+        }
+        this->closeHandle();
+        std::vector<uint64_t> siteDuts;
+        this->openHandle("stats.siteDuts.uint64");
+        for (auto it = sites.begin(); it != sites.end(); ++it) {
+            siteDuts.push_back(this->dutsBySite[*it]);
+            this->h.write((const char *)&siteDuts.back(), sizeof(uint64_t));
+        }
+        this->closeHandle();
+
+        // === moments by level ===
+        std::vector<uint64_t> fileDuts(this->dutsPerFile.begin(), this->dutsPerFile.end());
+        uint64_t nDuts = 0;
+        for (auto it = fileDuts.begin(); it != fileDuts.end(); ++it)
+            nDuts += *it;
+        const testMoments none;
+        std::vector<testMoments> all(testnums.size());
+        std::vector<testMoments> bySite;
+        std::vector<testMoments> byFile;
+        size_t ixTest = 0;
+        for (auto it = testnums.begin(); it != testnums.end(); ++it, ++ixTest) {
+            const testGroups &g = this->stats[*it];
+            for (auto itFile = g.byFile.begin(); itFile != g.byFile.end(); ++itFile)
+                all[ixTest].merge(*itFile);
+            for (auto itSite = sites.begin(); itSite != sites.end(); ++itSite)
+                bySite.push_back((*itSite < g.bySite.size()) ? g.bySite[*itSite] : none);
+            for (size_t ixFile = 0; ixFile < fileDuts.size(); ++ixFile)
+                byFile.push_back((ixFile < g.byFile.size()) ? g.byFile[ixFile] : none);
+        }
+        this->writeMoments("stats.", testnums, all, std::vector<uint64_t>(1, nDuts));
+        this->writeMoments("stats.site.", testnums, bySite, siteDuts);
+        this->writeMoments("stats.file.", testnums, byFile, fileDuts);
+    }
+
+    //* one file per quantity, for all tests (limits) and groups (number of DUTs)
+    void writeMoments(const string &prefix, const std::set<unsigned int> &testnums, const std::vector<testMoments> &m, const std::vector<uint64_t> &duts) {
+        std::vector<uint64_t> count;
+        std::vector<uint64_t> nan;
+        std::vector<double> mean;
+        std::vector<double> sigma;
+        std::vector<double> m2;
+        std::vector<float> min;
+        std::vector<float> max;
+        std::vector<double> cpk;
+        std::vector<uint32_t> hist;
+        size_t ix = 0;
+        for (auto it = testnums.begin(); it != testnums.end(); ++it) {
+            const float lowLim = this->lowLim[*it];
+            const float highLim = this->highLim[*it];
+            for (size_t ixGroup = 0; ixGroup < duts.size(); ++ixGroup, ++ix) {
+                const testMoments &g = m[ix];
+                const bool isEmpty = g.n == 0;
+                count.push_back(g.n);
+                nan.push_back(duts[ixGroup] - g.n);
+                mean.push_back(isEmpty ? NAN : g.mean);
+                sigma.push_back(g.sigma());
+                m2.push_back(g.m2);
+                min.push_back(isEmpty ? NAN : g.min);
+                max.push_back(isEmpty ? NAN : g.max);
+                // process capability: distance of the mean from the nearer limit in units of 3 sigma (NaN if there is no limit)
+                cpk.push_back((sigma.back() > 0) ? std::fmin(highLim - g.mean, g.mean - lowLim) / (3 * sigma.back()) : NAN);
+                hist.insert(hist.end(), g.hist, g.hist + testMoments::nBins);
+            }
+        }
+        this->writeVector(prefix + "count.uint64", count);
+        this->writeVector(prefix + "nan.uint64", nan);
+        this->writeVector(prefix + "mean.double", mean);
+        this->writeVector(prefix + "sigma.double", sigma);
+        this->writeVector(prefix + "m2.double", m2);
+        this->writeVector(prefix + "min.float", min);
+        this->writeVector(prefix + "max.float", max);
+        this->writeVector(prefix + "cpk.double", cpk);
+        this->writeVector(prefix + "hist.uint32", hist);
+    }
+
+    template <class T>
+    void writeVector(const string &name, const std::vector<T> &data) {
+        if (this->container) {
+            this->container->add(name, data.data(), data.size() * sizeof(T));
+            return;
+        }
+        this->openHandle(name);
+        this->h.write((const char *)data.data(), data.size() * sizeof(T));
+        this->closeHandle();
+    }
+
+    /** Completes "container.stdfoo", to be accessed with a single mmap. close() has written the index files and statistics into it, the files
+     * written during the conversion (result columns etc.) are copied into it and deleted:
+     * - header (first 4096 bytes): "STDFooCt", uint32 version (1), uint32 alignment (4096), uint64 manifest offset, uint64 manifest size, uint64 number of entries
+     * - one region per result file (content identical to the file), each starting at a multiple of 4096
+     * - manifest (text, after the last region): one "name \t offset \t size \n" line per region
+     * Regions: index files (testnums.uint32 etc.), statistics (stats.*), fileOffsets.uint64 (index of each file's first DUT, base 0), per-DUT data (site.uint8 etc.),
+     * per-file data (MIR_1.txt etc.), then one (testnum).float per test, in ascending TEST_NUM order, then (testnum)_(pin).float of MPR tests, in ascending TEST_NUM and pin order. */
+    void writeContainer(const std::set<unsigned int> &testnums) {
+        // === index of each input file's first DUT ===
+        std::vector<uint64_t> fileOffsets;
+        uint64_t offset = 0;
+        for (auto it = this->dutsPerFile.begin(); it != this->dutsPerFile.end(); ++it) {
+            fileOffsets.push_back(offset);
+            offset += *it;
+        }
+        this->writeVector("fileOffsets.uint64", fileOffsets);
+
+        // === collect files written during the conversion ===
+        std::vector<string> names = {"site.uint8", "hardbin.uint16", "softbin.uint16", "PART_ID.heap", "PART_ID.offsets.uint64",
+                                     "PART_TXT.heap", "PART_TXT.offsets.uint64",
+                                     "tileDims.uint32", "tileTestOrder.uint32", "tilePinOrder.uint32", "tiles.index.uint64", "tiles.float"};
+        std::vector<string> dirEntries = listDirectory(this->directory);
+        std::sort(dirEntries.begin(), dirEntries.end());
+        for (unsigned int filenum = 1; filenum <= this->filenames.size(); ++filenum) {
+            // per-file data e.g. MIR_(filenum).txt
+            const string suffix = "_" + std::to_string(filenum) + ".txt";
+            for (auto it = dirEntries.begin(); it != dirEntries.end(); ++it)
+                if ((it->length() > suffix.length()) && !it->compare(it->length() - suffix.length(), suffix.length(), suffix))
+                    names.push_back(*it);
+        }
+        for (auto it = testnums.begin(); it != testnums.end(); ++it)
+            names.push_back(std::to_string(*it) + ".float");
+        for (auto it = testnums.begin(); it != testnums.end(); ++it) {
+            names.push_back(resultTable::bitsName(*it, "fail"));
+            names.push_back(resultTable::bitsName(*it, "tested"));
+        }
+        for (auto it = this->mprTests.begin(); it != this->mprTests.end(); ++it)
+            for (unsigned int pin = 0; pin < it->second.nPins; ++pin)
+                names.push_back(std::to_string(it->first) + "_" + std::to_string(pin) + ".float");
+
+        // === copy, deleting each file once packed (disk space: the container plus one file) ===
+        for (auto it = names.begin(); it != names.end(); ++it) {
+            const string fname = this->directory + "/" + *it;
+            if (this->container->addFile(*it, fname))  // otherwise e.g. test without any result
+                remove(fname.c_str());
+        }
+        this->container->close();
+        this->container.reset();
+    }
+
+    /** index files are written as (name).tmp in the output directory, replacing name on closeHandle() (e.g. --append: no half-written index).
+     * With setContainer(), as a region of the container instead */
+    void openHandle(const string &name) {
+        this->hName = name;
+        if (this->container) {
+            this->h.rdbuf(&this->hMemory);
+            return;
+        }
+        const string fname = this->directory + "/" + name + ".tmp";
+        if (!this->hFile.open(fname, std::ios::out | std::ios::binary)) {
+            cerr << "Failed to open '" << fname << "' for write" << endl;
+            fail("");
+        }
+        this->h.rdbuf(&this->hFile);
+    }
+    void closeHandle() {
+        if (this->container) {
+            string tmp = this->hMemory.str();
+            this->hMemory.str("");
+            this->container->add(this->hName, tmp.data(), tmp.size());
+            return;
+        }
+        const string fname = this->directory + "/" + this->hName;
+        bool isOk = !this->h.fail();
+        if (!this->hFile.close() || !isOk || !replaceFile(fname + ".tmp", fname)) {
+            cerr << "Failed to write '" << fname << "'" << endl;
+            fail("");
+        }
+    }
+    //* index file being written, into hFile or hMemory (see openHandle())
+    std::ostream h{nullptr};
+    std::filebuf hFile;
+    std::stringbuf hMemory;
+    string hName;
+    string directory;
+    std::unordered_map<unsigned int, float> lowLim;
+    std::unordered_map<unsigned int, float> highLim;
+    std::unordered_map<unsigned int, string> testname;
+    std::unordered_map<unsigned int, string> unit;
+    std::unordered_set<unsigned int> loggedTests;
+    //* semi-static information of an MPR test
+    struct mprInfo {
+        float lowLim = std::nanf("");
+        float highLim = std::nanf("");
+        string testname;
+        string unit;
+        unsigned int nPins = 0;
+    };
+    //* MPR tests by TEST_NUM
+    std::map<unsigned int, mprInfo> mprTests;
+    std::vector<string> filenames;
+    std::vector<unsigned int> dutsPerFile;
+    //* see setContainer()
+    bool isContainer = false;
+    //* open during close(), with setContainer()
+    std::unique_ptr<containerWriter> container;
+    //* protects log(), logMpr()
+    std::mutex logMutex;
+    //* statistics of a PTR test
+    struct testGroups {
+        std::vector<testMoments> byFile;
+        //* by SITE_NUM
+        std::vector<testMoments> bySite;
+    };
+    //* by TEST_NUM
+    std::unordered_map<unsigned int, testGroups> stats;
+    //* number of DUTs by SITE_NUM
+    std::vector<uint64_t> dutsBySite;
+    //* see setNoStats()
+    bool hasStats = true;
+};
+
+// =====================
+// === warningCounts ===
+// =====================
+/** inconsistent input, counted by kind. Only the first warning of each kind is printed in detail, report() summarizes the counts
+ * (a damaged file would otherwise print one line per record). Thread-safe (parser thread and shard worker threads) */
+class warningCounts {
+   public:
+    enum kind_e {
+        PIR_ON_OPEN_SITE,
+        PRR_ON_CLOSED_SITE,
+        PTR_ON_CLOSED_SITE,
+        MPR_ON_CLOSED_SITE,
+        MPR_SHORT,
+        PIR_WITHOUT_PRR,
+        PARTIAL_RECORD,
+        nKinds
+    };
+
+    //* counts one warning. Returns true for the first one of its kind (the caller prints it)
+    bool add(kind_e kind) {
+        return this->counts[kind].fetch_add(1, std::memory_order_relaxed) == 0;
+    }
+    uint64_t get(kind_e kind) const {
+        return this->counts[kind].load(std::memory_order_relaxed);
+    }
+    //* key e.g. in the stats file
+    static const char *name(kind_e kind) {
+        static const char *names[nKinds] = {"PIR_on_open_site", "PRR_on_closed_site", "PTR_on_closed_site", "MPR_on_closed_site", "MPR_shorter_than_RSLT_CNT", "PIR_without_PRR", "partial_record"};
+        return names[kind];
+    }
+    //* one line per kind that occurred more than once (the first one was printed already)
+    void report() const {
+        for (int ix = 0; ix < nKinds; ++ix)
+            if (this->get((kind_e)ix) > 1)
+                cerr << "Warning: " << this->get((kind_e)ix) << " occurrences of " << name((kind_e)ix) << " (the first one is shown above)" << endl;
+    }
+
+   protected:
+    std::atomic<uint64_t> counts[nKinds] = {};
+};
+
+// =================
+// === testShard ===
+// =================
+/** stages the results of a share of the tests (see stdfWriter::setParseJobs()), or of all tests if there is only one shard.
+ * Follows PIR / PRR of all sites, so that every shard emits the same sequence of DUT rows */
+class testShard {
+   public:
+    testShard(string dirname, commonLogger &cmLog, warningCounts &warnings) : results(dirname), cmLog(cmLog), warnings(warnings) {
+        this->ring = NULL;
+        this->dest = NULL;
+        this->nFree = 0;
+        this->nStaged = 0;
+    }
+
+    //* processes a PIR, PRR, PTR or MPR record (with header). Other records are ignored
+    void record(unsigned char *ptr) {
+        unsigned int REC_LEN = decode<uint16_t>(ptr);
+        uint16_t hdr = decode<uint16_t>(ptr);
+        switch (hdr) {
+            case 5 + (10 << 8): {  // PIR
+                ptr += 1;          // HEAD_NUM
+                this->PIR(decode<uint8_t>(ptr));
+                break;
+            }
+            case 5 + (20 << 8): {  // PRR
+                ptr += 1;          // HEAD_NUM
+                this->PRR(decode<uint8_t>(ptr));
+                break;
+            }
+            case 15 + (10 << 8): {  // PTR
+                unsigned int TEST_NUM = decode<uint32_t>(ptr);
+                ptr += 1;  // HEAD_NUM
+                unsigned int SITE_NUM = decode<uint8_t>(ptr);
+                uint8_t TEST_FLG = decode<uint8_t>(ptr);
+                ptr += 1;  // PARM_FLG
+                float RESULT = decode<float>(ptr);
+                bool isFirstOccurrence = this->PTR(TEST_NUM, SITE_NUM, RESULT, TEST_FLG);
+                if (isFirstOccurrence) {
+                    string testtext = decodeString(ptr);
+                    string alarmId = decodeString(ptr);
+                    ptr += 4;  // OPT_FLAG, RES_SCAL, LLM_SCAL, HLM_SCAL
+                    float lowLim = decode<float>(ptr);
+                    float highLim = decode<float>(ptr);
+                    string unit = decodeString(ptr);
+                    this->cmLog.log(TEST_NUM, lowLim, highLim, testtext, unit);
+                    this->results.setLimits(TEST_NUM, lowLim, highLim);
+                }
+                break;
+            }
+            case 15 + (15 << 8): {  // MPR
+                const unsigned char *recordEnd = ptr + REC_LEN;
+                unsigned int TEST_NUM = decode<uint32_t>(ptr);
+                ptr += 1;  // HEAD_NUM
+                unsigned int SITE_NUM = decode<uint8_t>(ptr);
+                ptr += 2;  // TEST_FLG, PARM_FLG
+                unsigned int RTN_ICNT = decode<uint16_t>(ptr);
+                unsigned int RSLT_CNT = decode<uint16_t>(ptr);
+                ptr += (RTN_ICNT + 1) / 2;  // RTN_STAT (nibbles)
+                const unsigned char *RTN_RSLT = ptr;
+                if (RTN_RSLT + 4 * RSLT_CNT > recordEnd) {
+                    if (this->warnings.add(warningCounts::MPR_SHORT))
+                        cerr << "Warning: MPR " << TEST_NUM << " shorter than RSLT_CNT " << RSLT_CNT << endl;
+                    RSLT_CNT = (RTN_RSLT < recordEnd) ? (unsigned int)(recordEnd - RTN_RSLT) / 4 : 0;
+                }
+                ptr += 4 * RSLT_CNT;
+                bool isFirstOccurrence = this->MPR(TEST_NUM, SITE_NUM, RTN_RSLT, RSLT_CNT);
+                if (isFirstOccurrence) {
+                    string testtext = decodeString(ptr);
+                    string alarmId = decodeString(ptr);
+                    ptr += 4;  // OPT_FLAG, RES_SCAL, LLM_SCAL, HLM_SCAL
+                    float lowLim = decode<float>(ptr);
+                    float highLim = decode<float>(ptr);
+                    ptr += 8;             // START_IN, INCR_IN
+                    ptr += 2 * RTN_ICNT;  // RTN_INDX
+                    string unit = decodeString(ptr);
+                    this->cmLog.logMpr(TEST_NUM, lowLim, highLim, testtext, unit);
+                }
+                break;
+            }
+            default: {
+            }
+        }
+    }
+
+    //* starts a new DUT on site
+    void PIR(unsigned int site) {
+        if (this->siteOpen.size() <= site)
+            this->siteOpen.resize(site + 1, 0);
+        this->siteOpen[site] = 1;
+        this->results.beginDut(site);
+    }
+
+    //* emits the staged results of site as the next DUT. Only for an open site (the caller warns otherwise)
+    void PRR(unsigned int site) {
+        if ((this->siteOpen.size() <= site) || !this->siteOpen[site])
+            return;
+        this->results.emitRow(site);
+        this->siteOpen[site] = 0;
+    }
+
+    //* returns true on the first occurrence of testnum
+    bool PTR(unsigned int testnum, unsigned int site, float val, uint8_t TEST_FLG) {
+        bool isNew;
+        if ((this->siteOpen.size() <= site) || !this->siteOpen[site]) {
+            if (this->warnings.add(warningCounts::PTR_ON_CLOSED_SITE))
+                std::cerr
+                    << "Warning: inconsistent file structure. PTR on closed site "
+                    << site << " (missing PIR)" << endl;
+            // result is discarded but the test is known (limits, result file)
+            this->results.getOrdinal(-1, testnum, isNew);
+            return isNew;
+        }
+
+        unsigned int ordinal = this->results.getOrdinal(site, testnum, isNew);
+        this->results.set(site, ordinal, val);
+        if (this->results.hasBitmaps())
+            this->results.setFlags(site, ordinal, ptrFlags(TEST_FLG));
+        return isNew;
+    }
+
+    //* results: nResults unaligned floats (RTN_RSLT), one per pin. Returns true on the first occurrence of testnum
+    bool MPR(unsigned int testnum, unsigned int site, const unsigned char *results, unsigned int nResults) {
+        bool isNew;
+        if ((this->siteOpen.size() <= site) || !this->siteOpen[site]) {
+            if (this->warnings.add(warningCounts::MPR_ON_CLOSED_SITE))
+                std::cerr
+                    << "Warning: inconsistent file structure. MPR on closed site "
+                    << site << " (missing PIR)" << endl;
+            // results are discarded but the test is known (limits, result files)
+            this->results.getMprColumns(-1, testnum, nResults, isNew);
+            return isNew;
+        }
+
+        const resultTable::mprColumns &cols = this->results.getMprColumns(site, testnum, nResults, isNew);
+        if (nResults == 0) {
+            // no results
+        } else if (cols.isContiguous) {
+            // === usual case: one block copy ===
+            this->results.setRange(site, cols.ordinalByPin[0], results, nResults);
+        } else {
+            for (unsigned int pin = 0; pin < nResults; ++pin)
+                this->results.setRange(site, cols.ordinalByPin[pin], results + 4 * pin, 1);
+        }
+        return isNew;
+    }
+
+    resultTable &getResults() {
+        return this->results;
+    }
+
+    //* blocking between parser thread and worker thread (after join())
+    const ringWaits &getRingWaits() const {
+        return this->ringBlocking;
+    }
+
+    /** resultTable flags from the PTR TEST_FLG: tested unless bit 4 (test not executed) is set, failed if bit 7 (test failed) is set
+     * without bit 6 (no pass / fail indication) */
+    static uint8_t ptrFlags(uint8_t TEST_FLG) {
+        if (TEST_FLG & 0x10)
+            return 0;
+        uint8_t flags = resultTable::flagTested;
+        if ((TEST_FLG & 0xC0) == 0x80)
+            flags |= resultTable::flagFailed;
+        return flags;
+    }
+
+    // === own worker thread (more than one shard) ===
+    //* starts the worker thread, which processes the records passed to push()
+    void start() {
+        std::promise<blockingCircBuf *> ringCreated;
+        std::future<blockingCircBuf *> ringPtr = ringCreated.get_future();
+        this->worker = std::thread(
+            [this](std::promise<blockingCircBuf *> ringCreated) {
+                // on the worker's stack: blockingCircBuf is over-aligned, which operator new supports only from C++17
+                blockingCircBuf ring(ringSize, 65535 + 4);
+                ringCreated.set_value(&ring);
+                this->run(ring);
+                this->ringBlocking = ring.getWaits();
+            },
+            std::move(ringCreated));
+        this->ring = ringPtr.get();
+    }
+
+    //* queues a copy of a record (with header) for the worker thread (parser thread). Records are handed over in batches
+    void push(const unsigned char *record, unsigned int n) {
+        if (this->nStaged + n > this->nFree) {
+            this->publish();
+            this->ring->getLargestPossiblePush(n, &this->nFree, &this->dest);
+        }
+        memcpy(this->dest + this->nStaged, record, n);
+        this->nStaged += n;
+        if (this->nStaged >= batchSize)
+            this->publish();
+    }
+
+    //* processes all queued records and ends the worker thread (parser thread)
+    void join() {
+        if (!this->ring)
+            return;
+        this->publish();
+        this->ring->setShutdown(true);
+        this->worker.join();
+        this->ring = NULL;
+    }
+
+    ~testShard() {
+        this->join();
+    }
+
+   protected:
+    //* hands the staged records to the worker thread
+    void publish() {
+        if (this->nStaged == 0)
+            return;
+        this->ring->reportPush(this->nStaged);
+        this->nStaged = 0;
+        this->nFree = 0;  // push position has moved
+    }
+
+    //* worker thread: record loop (records are complete, see push())
+    void run(blockingCircBuf &ring) {
+        while (true) {
+            unsigned int nBytesAvailable;
+            unsigned char *ptr;
+            if (ring.getLargestPossiblePop(4, &nBytesAvailable, &ptr))
+                break;
+            unsigned char *ptrCopy = ptr;
+            unsigned int recordSizeWithHeader = decode<uint16_t>(ptrCopy) + 4;
+            while (nBytesAvailable < recordSizeWithHeader)
+                if (ring.getLargestPossiblePop(recordSizeWithHeader, &nBytesAvailable, &ptr))
+                    return;
+            this->record(ptr);
+            ring.pop(recordSizeWithHeader);
+        }
+    }
+
+    resultTable results;
+    //* first occurrence data of tests (shared by all shards)
+    commonLogger &cmLog;
+    //* shared by all shards
+    warningCounts &warnings;
+    //* per site: between PIR and PRR
+    std::vector<uint8_t> siteOpen;
+
+    // === parser thread => worker thread ===
+    //* owned by the worker thread (NULL if none)
+    blockingCircBuf *ring;
+    std::thread worker;
+    //* free space in ring at dest, of which nStaged bytes are written but not yet published
+    unsigned char *dest;
+    unsigned int nFree;
+    unsigned int nStaged;
+    //* see getRingWaits()
+    ringWaits ringBlocking;
+    static const unsigned int ringSize = 1 << 22;
+    static const unsigned int batchSize = 1 << 14;
+};
+
+// ==================
+// === stdfWriter ===
+// ==================
+/** takes one input STDF record at a time, extracts detailed data and routes to various writers */
+class stdfWriter {
+   public:
+    stdfWriter(string dirname, unsigned int nMaxOpenFiles = 256) : cmLog(dirname), pool(nMaxOpenFiles) {
+        this->directory = dirname;
+        this->shards.push_back(std::unique_ptr<testShard>(new testShard(dirname, this->cmLog, this->warnings)));
+        this->nextValidCode = 1;  // 0 is "invalid"
+        this->loggerSite = new perItemLogger<uint8_t>(
+            dirname + "/" + "site.uint8", 255);
+        this->loggerHardbin = new perItemLogger<uint16_t>(
+            dirname + "/" + "hardbin.uint16", 65535);
+        this->loggerSoftbin = new perItemLogger<uint16_t>(
+            dirname + "/" + "softbin.uint16", 65535);
+        this->loggerPartId = new stringHeapLogger(dirname + "/" + "PART_ID");
+        this->loggerPartTxt = new stringHeapLogger(dirname + "/" + "PART_TXT");
+        this->dutCountBaseZero = 0;
+        this->dutsReported = 0;
+        this->filenumBase1 = 1;
+        this->tiles = NULL;
+    }
+
+    /** distributes PTR / MPR records by TEST_NUM over nShards worker threads, which stage the results (the calling thread
+     * only splits records and keeps per-DUT data). PIR / PRR go to all shards. Not with setTiles() (one row over all tests) */
+    void setParseJobs(unsigned int nShards) {
+        this->shards.clear();
+        for (unsigned int ix = 0; ix < nShards; ++ix) {
+            this->shards.push_back(std::unique_ptr<testShard>(new testShard(this->directory, this->cmLog, this->warnings)));
+            if (this->isCompressed)
+                this->shards.back()->getResults().setCompress();
+            if (this->isBitmaps)
+                this->shards.back()->getResults().setBitmaps();
+            if (nShards > 1)
+                this->shards.back()->start();
+        }
+    }
+
+    //* writes result columns and per-DUT bins / sites block-encoded (see STDFooCodec.hpp). Call before the first record
+    void setCompress() {
+        this->isCompressed = true;
+        for (auto it = this->shards.begin(); it != this->shards.end(); ++it)
+            (*it)->getResults().setCompress();
+        this->loggerSite->setCompress();
+        this->loggerHardbin->setCompress();
+        this->loggerSoftbin->setCompress();
+    }
+
+    //* writes pass / fail bitmaps of each PTR test (see resultTable::setFlags()). Call before the first record
+    void setBitmaps() {
+        this->isBitmaps = true;
+        for (auto it = this->shards.begin(); it != this->shards.end(); ++it)
+            (*it)->getResults().setBitmaps();
+    }
+
+    //* additionally writes results in tiles of nDutsPerTile x nTestsPerTile (see tileWriter)
+    void setTiles(unsigned int nDutsPerTile, unsigned int nTestsPerTile) {
+        this->tiles = new tileWriter(this->directory, nDutsPerTile, nTestsPerTile);
+    }
+
+    void stdfRecord(unsigned char *ptr) {
+        unsigned char *record = ptr;
+        unsigned int REC_LEN = decode<uint16_t>(ptr);
+        uint16_t hdr = decode<uint16_t>(ptr);
+        switch (hdr) {
+            case 0 + (10 << 8): {  // FAR
+                // do nothing...
+                break;
+            }
+            case 1 + (10 << 8): {  // MIR
+                this->pwl.add("MIR", "SETUP_T", decode<uint32_t>(ptr));
+                this->pwl.add("MIR", "START_T", decode<uint32_t>(ptr));
+                this->pwl.add("MIR", "STAT_NUM", decode<uint8_t>(ptr));
+                this->pwl.add("MIR", "MODE_COD", decode<uint8_t>(ptr));
+                this->pwl.add("MIR", "RTST_COD", decode<uint8_t>(ptr));
+                this->pwl.add("MIR", "PROD_COD", decode<uint8_t>(ptr));
+                this->pwl.add("MIR", "BURN_TIM", decode<uint16_t>(ptr));
+                this->pwl.add("MIR", "CMOD_COD", decode<uint8_t>(ptr));
+                this->pwl.add("MIR", "LOT_ID", decodeString(ptr));
+                this->pwl.add("MIR", "PART_TYP", decodeString(ptr));
+                this->pwl.add("MIR", "NODE_NAM", decodeString(ptr));
+                this->pwl.add("MIR", "TSTR_TYP", decodeString(ptr));
+                this->pwl.add("MIR", "JOB_NAM", decodeString(ptr));
+                this->pwl.add("MIR", "JOB_REV", decodeString(ptr));
+                this->pwl.add("MIR", "SBLOT_ID", decodeString(ptr));
+                this->pwl.add("MIR", "OPER_NAM", decodeString(ptr));
+                this->pwl.add("MIR", "EXEC_TYP", decodeString(ptr));
+                this->pwl.add("MIR", "EXEC_VER", decodeString(ptr));
+                this->pwl.add("MIR", "TEST_COD", decodeString(ptr));
+                this->pwl.add("MIR", "TST_TEMP", decodeString(ptr));
+                this->pwl.add("MIR", "USER_TXT", decodeString(ptr));
+                this->pwl.add("MIR", "AUX_FILE ", decodeString(ptr));
+                this->pwl.add("MIR", "PKG_TYP", decodeString(ptr));
+                this->pwl.add("MIR", "FAMLY_ID", decodeString(ptr));
+                this->pwl.add("MIR", "DATE_COD", decodeString(ptr));
+                this->pwl.add("MIR", "FACIL_ID", decodeString(ptr));
+                this->pwl.add("MIR", "FLOOR_ID", decodeString(ptr));
+                this->pwl.add("MIR", "PROC_ID", decodeString(ptr));
+                break;
+            }
+            case 5 + (10 << 8): {  // PIR
+                // cout << "PIR\n";
+                ptr += 1;  // HEAD_NUM
+                unsigned int SITE_NUM = decode<uint8_t>(ptr);
+                this->PIR(SITE_NUM);
+                this->toAllShards(record, REC_LEN + 4);
+                break;
+            }
+            case 5 + (20 << 8): {  // PRR
+                // cout << "PRR\n";
+                ptr += 1;  // HEAD_NUM
+                unsigned int SITE_NUM = decode<uint8_t>(ptr);
+                ptr += 3;  // PART_FLG, NUM_TEST
+                unsigned int HARD_BIN = decode<uint16_t>(ptr);
+                unsigned int SOFT_BIN = decode<uint16_t>(ptr);
+                /*unsigned int X_COORD = */ decode<uint16_t>(ptr);
+                /*unsigned int Y_COORD = */ decode<uint16_t>(ptr);
+                /*unsigned int TEST_T = */ decode<uint32_t>(ptr);
+                const unsigned char *PART_ID = ptr;  // STDF strings, used in place
+                const unsigned char *PART_TXT = PART_ID + 1 + PART_ID[0];
+                if (this->PRR(SITE_NUM, SOFT_BIN, HARD_BIN, PART_ID, PART_TXT))
+                    this->toAllShards(record, REC_LEN + 4);
+                break;
+            }
+            case 15 + (10 << 8):    // PTR
+            case 15 + (15 << 8): {  // MPR
+                if (this->shards.size() == 1) {
+                    this->shards[0]->record(record);
+                } else {
+                    unsigned int TEST_NUM = decode<uint32_t>(ptr);
+                    this->shards[this->getShard(TEST_NUM)]->push(record, REC_LEN + 4);
+                }
+                break;
+            }
+            default: {
+                // cerr << "warning: unsupported record (OK outside testcases)" << endl;
+            }
+        }
+    }
+
+    void PIR(unsigned int site) {
+        if (this->siteValidCode.size() <= site)
+            this->siteValidCode.resize(site + 1);
+        if (this->siteValidCode[site] && this->warnings.add(warningCounts::PIR_ON_OPEN_SITE)) {
+            cerr << "warning: inconsistent file structure. PIR on open site "
+                 << site << " (missing PRR)" << endl;
+        }
+        this->siteValidCode[site] = this->nextValidCode++;
+    }
+
+    /** PART_ID, PART_TXT: STDF strings (length byte, then characters).
+     * Returns false if the site is not open (the shards ignore the record) */
+    bool PRR(unsigned int site, uint16_t softbin, uint16_t hardbin, const unsigned char *PART_ID, const unsigned char *PART_TXT) {
+        if (this->siteValidCode.size() <= site)
+            this->siteValidCode.resize(site + 1);
+        unsigned int validCode = this->siteValidCode[site];
+        if (validCode == 0) {
+            if (this->warnings.add(warningCounts::PRR_ON_CLOSED_SITE))
+                std::cerr
+                    << "warning: inconsistent file structure. PRR on closed site "
+                    << site << " (missing PIR)" << endl;
+            return false;
+        }
+
+        // === data added by the PRR ===
+        this->loggerSoftbin->setData(site, validCode, softbin);
+        this->loggerHardbin->setData(site, validCode, hardbin);
+        this->loggerSite->setData(site, validCode, site);
+        this->loggerPartId->setData(site, validCode, PART_ID);
+        this->loggerPartTxt->setData(site, validCode, PART_TXT);
+        if (this->dutsBySite.size() <= site)
+            this->dutsBySite.resize(site + 1, 0);
+        ++this->dutsBySite[site];
+
+        // === write data ===
+        if (this->tiles) {
+            resultTable &results = this->shards[0]->getResults();  // single shard (see setParseJobs())
+            this->tiles->addRow(results.getRow(site), results.getNOrdinals());
+        }
+        this->loggerSoftbin->write(site, this->dutCountBaseZero, validCode);
+        this->loggerHardbin->write(site, this->dutCountBaseZero, validCode);
+        this->loggerSite->write(site, this->dutCountBaseZero, validCode);
+        this->loggerPartId->write(site, this->dutCountBaseZero, validCode);
+        this->loggerPartTxt->write(site, this->dutCountBaseZero, validCode);
+
+        this->siteValidCode[site] = 0;
+
+        // note: parts are counted in the order they are reported / removed (PRR)
+        ++this->dutCountBaseZero;
+        return true;
+    }
+
+    //* writes buffered data to files in chunks (background thread). Returns true if data was written
+    bool flush() {
+        // === chunk size ===
+        // larger chunks reduce file operations but need more memory, as all columns are buffered
+        size_t nBytesMin = std::min(std::max(flushBudget / (this->nOrdinalsFlushed + 5), (size_t)flushMin), (size_t)flushMax);
+
+        bool retVal = false;
+        size_t nOrdinals = 0;
+        for (auto it = this->shards.begin(); it != this->shards.end(); ++it) {
+            retVal |= (*it)->getResults().flush(this->pool, nBytesMin / sizeof(float));
+            nOrdinals += (*it)->getResults().getNColumns();
+        }
+        this->nOrdinalsFlushed = nOrdinals;
+        retVal |= this->loggerSoftbin->flush(this->pool, nBytesMin / sizeof(uint16_t));
+        retVal |= this->loggerHardbin->flush(this->pool, nBytesMin / sizeof(uint16_t));
+        retVal |= this->loggerSite->flush(this->pool, nBytesMin / sizeof(uint8_t));
+        retVal |= this->loggerPartId->flush(this->pool, nBytesMin);
+        retVal |= this->loggerPartTxt->flush(this->pool, nBytesMin);
+        if (this->tiles)
+            retVal |= this->tiles->flush(this->pool, flushMax / sizeof(float));
+        return retVal;
+    }
+
+    void close() {
+        // === shard worker threads: process remaining records ===
+        for (auto it = this->shards.begin(); it != this->shards.end(); ++it)
+            (*it)->join();
+
+        for (unsigned int ix = 0; ix < this->siteValidCode.size(); ++ix)
+            if ((this->siteValidCode[ix] != 0) && this->warnings.add(warningCounts::PIR_WITHOUT_PRR))
+                std::cerr << "Warning: site " << ix
+                          << " has no result (PIR without PRR)\n";
+        this->warnings.report();
+
+        for (auto it = this->shards.begin(); it != this->shards.end(); ++it)
+            (*it)->getResults().close(this->pool);
+        this->loggerSoftbin->close(this->pool);
+        this->loggerHardbin->close(this->pool);
+        this->loggerPartId->close(this->pool);
+        this->loggerPartTxt->close(this->pool);
+        this->loggerSite->close(this->pool);
+        if (this->tiles)
+            this->tiles->close(this->pool, this->shards[0]->getResults().getTestnumByOrdinal(), this->shards[0]->getResults().getPinByOrdinal());
+        this->pool.closeAll();
+        for (auto it = this->shards.begin(); it != this->shards.end(); ++it) {
+            resultTable &results = (*it)->getResults();
+            const std::vector<unsigned int> &mprTestnums = results.getMprTestnums();
+            for (size_t ix = 0; ix < mprTestnums.size(); ++ix)
+                this->cmLog.setMprPins(mprTestnums[ix], (unsigned int)results.getMprNPins(ix));
+            const std::vector<unsigned int> &testnumByOrdinal = results.getTestnumByOrdinal();
+            for (size_t ordinal = 0; ordinal < testnumByOrdinal.size(); ++ordinal) {
+                const testStats &st = results.getStats(ordinal);
+                if (st.active())
+                    this->cmLog.addStats(testnumByOrdinal[ordinal], 0, st.getByFile(), st.getBySite());
+            }
+        }
+        this->cmLog.addSiteDuts(this->dutsBySite);
+        this->cmLog.close();
+    }
+
+    //* write results into a single container file (see commonLogger::writeContainer())
+    void setContainer(bool isContainer) {
+        this->cmLog.setContainer(isContainer);
+    }
+
+    //* statistics on file operations
+    const fileHandlePool &getFileHandles() const {
+        return this->pool;
+    }
+
+    //* see warningCounts. Also for the caller's warnings on the input (e.g. partial record)
+    warningCounts &getWarnings() {
+        return this->warnings;
+    }
+
+    //* number of DUTs so far (parser thread)
+    unsigned int getNDuts() const {
+        return this->dutCountBaseZero;
+    }
+
+    //* blocking between the parser thread and the shard worker threads (after close(). None with a single shard)
+    ringWaits getShardWaits() const {
+        ringWaits retVal;
+        for (auto it = this->shards.begin(); it != this->shards.end(); ++it)
+            retVal.add((*it)->getRingWaits());
+        return retVal;
+    }
+
+    void reportFile(string filename) {
+        this->cmLog.reportFile(filename,
+                               this->dutCountBaseZero - this->dutsReported);
+        this->dutsReported = this->dutCountBaseZero;
+        for (auto it = this->shards.begin(); it != this->shards.end(); ++it)
+            (*it)->getResults().endFile(this->dutCountBaseZero);
+        this->pwl.write(directory, this->filenumBase1);
         this->filenumBase1++;
     }
-    ~stdfWriter() {
-        for (auto it = this->loggerTestitems.begin();
-             it != this->loggerTestitems.end(); ++it) {
-            delete it->second;
+    ~stdfWriter() {
+        delete this->loggerSite;
+        delete this->loggerHardbin;
+        delete this->loggerSoftbin;
+        delete this->loggerPartId;
+        delete this->loggerPartTxt;
+        delete this->tiles;
+    }
+
+   protected:
+    //* shard of testnum (multiplicative hash, mapped to the number of shards)
+    unsigned int getShard(unsigned int testnum) {
+        return (unsigned int)(((uint64_t)(uint32_t)(testnum * 2654435761u) * this->shards.size()) >> 32);
+    }
+
+    //* passes a PIR / PRR record (with header) to every shard
+    void toAllShards(unsigned char *record, unsigned int n) {
+        if (this->shards.size() == 1)
+            this->shards[0]->record(record);
+        else
+            for (auto it = this->shards.begin(); it != this->shards.end(); ++it)
+                (*it)->push(record, n);
+    }
+
+    //* directory common to all written files
+    string directory;
+    //* log NUM_SITE per insertion
+    perItemLogger<uint8_t> *loggerSite;
+    //* log HARD_BIN per insertion
+    perItemLogger<uint16_t> *loggerHardbin;
+    //* log SOFT_BIN per insertion
+    perItemLogger<uint16_t> *loggerSoftbin;
+    //* log PART_ID per insertion
+    stringHeapLogger *loggerPartId;
+    //* log PART_TXT per insertion
+    stringHeapLogger *loggerPartTxt;
+    //* timestamp to monitor PIR-PTR*n-PRR sequence, also to recognize whether data in loggers is valid (motivation: advancing one timestamp is faster than invalidating thousands of records)
+    unsigned int nextValidCode;
+    //* timestamp per site for PIR-PTR*n-PRR sequence monitoring
+    std::vector<unsigned int> siteValidCode;
+    //* number of DUTs by SITE_NUM (statistics)
+    std::vector<uint64_t> dutsBySite;
+    //* number of insertions = current length of all per-DUT results
+    unsigned int dutCountBaseZero;
+    //* logger for non-per-DUT data e.g. testnames
+    commonLogger cmLog;
+    //* inconsistent input (shared with the shards)
+    warningCounts warnings;
+    //* results of all tests, by share of TEST_NUM (see setParseJobs()). Declared after cmLog, which they use
+    std::vector<std::unique_ptr<testShard>> shards;
+    unsigned int dutsReported;
+    perFileLogger pwl;
+    unsigned int filenumBase1;
+    //* output files kept open between flushes
+    fileHandlePool pool;
+    //* optional DUT-major copy of the results (NULL if not used). Slots are resultTable ordinals
+    tileWriter *tiles;
+    //* number of tests at the last flush() (background thread)
+    size_t nOrdinalsFlushed = 0;
+    //* see setCompress()
+    bool isCompressed = false;
+    //* see setBitmaps()
+    bool isBitmaps = false;
+    //* memory for buffered data of all columns (bytes), for the flush() chunk size
+    static const size_t flushBudget = 64 << 20;
+    //* chunk size limits (bytes)
+    static const size_t flushMin = 4096;
+    static const size_t flushMax = 1 << 20;
+};
+
+// =======================
+// === pingPongMailbox ===
+// =======================
+//* minimal communication between two threads using one payload message of type T
+template <class T>
+class pingPongMailbox {
+   public:
+    enum state_e {
+        PING,
+        PONG
+    };
+    state_e state = PING;
+    pingPongMailbox() {
+    }
+    state_e getState() {
+        std::lock_guard<std::mutex> lk(this->m);
+        return this->state;
+    }
+    T getPayload() {
+        std::lock_guard<std::mutex> lk(this->m);
+        return this->payload;
+    }
+    //* blocks until the other thread sets the given state
+    void waitFor(state_e state) {
+        std::unique_lock<std::mutex> lk(this->m);
+        while (this->state != state)
+            this->evt.wait(lk);
+    }
+    //* change of state unlocks other wait()ing thread
+    void setState(state_e state, T payload) {
+        std::lock_guard<std::mutex> lk(this->m);
+        this->state = state;
+        this->payload = payload;
+        this->evt.notify_all();
+    }
+
+   protected:
+    std::mutex m;
+    std::condition_variable evt;
+    T payload;
+};
+
+// ===============
+// === options ===
+// ===============
+//* command line switches, given ahead of the output folder e.g. "--jobs=8" */
+class options {
+   public:
+    //* number of input files converted concurrently. 1: a single pipeline processes all files in sequence */
+    unsigned int nJobs = 1;
+    /** number of threads inflating a single .gz file: BGZF members in parallel, a plain .gz file by parallelGzipDecoder if it can be mapped
+     * (not with useMmap off or useZlib). Otherwise, and for 1, inflate is sequential */
+    unsigned int nInflateJobs = std::max(1u, std::thread::hardware_concurrency());
+    //* .gz decoder: built-in (STDFooInflate.hpp) or libz */
+    bool useZlib = false;
+    //* parse uncompressed files straight from a memory map (otherwise: read into blockingCircBuf) */
+    bool useMmap = true;
+    //* maximum number of output files kept open at the same time (all jobs) */
+    unsigned int nMaxOpenFiles = 256;
+    //* write a single container.stdfoo instead of one file per result */
+    bool container = false;
+    //* DUTs x tests per tile for tiled output (0: none) */
+    unsigned int nTileDuts = 0;
+    unsigned int nTileTests = 0;
+    //* add the input files to the existing results in the output folder */
+    bool append = false;
+    //* conversion cache folder (see conversionCache). Empty: none */
+    string cacheDir;
+    //* block-encoded result columns and bins / sites (see STDFooCodec.hpp) */
+    bool compress = false;
+    //* --lossy=BOUND: 16-bit result columns with an error of at most BOUND * (highLim - lowLim) (see quantizeResults()). 0: none */
+    double lossyBound = 0;
+    //* number of threads staging test results, each for a share of the TEST_NUMs (see stdfWriter::setParseJobs()) */
+    unsigned int nParseJobs = 1;
+    //* per-test pass / fail bitmaps from the PTR TEST_FLG (see resultTable::setFlags()) */
+    bool bitmaps = false;
+    //* --stats-json=FILE: counters and timers of the run (see runStats). Empty: none */
+    string statsJson;
+    //* --progress[=SECONDS]: progress line every SECONDS (0: none) */
+    double progressSeconds = 0;
+
+    //* consumes leading "--" switches. Returns the index of the first remaining argument (output folder) */
+    int parse(int argc, char **argv) {
+        int ix = 1;
+        for (; ix < argc; ++ix) {
+            string arg(argv[ix]);
+            if (arg.compare(0, 2, "--"))
+                break;  // not a switch
+            if (!arg.compare(0, 7, "--jobs=")) {
+                if (!parseUnsigned(arg.substr(7), this->nJobs))
+                    fail("--jobs=N: expecting a number (0: one job per CPU core)");
+                if (this->nJobs == 0)
+                    this->nJobs = std::max(1u, std::thread::hardware_concurrency());
+            } else if (!arg.compare(0, 15, "--inflate-jobs=")) {
+                if (!parseUnsigned(arg.substr(15), this->nInflateJobs) || (this->nInflateJobs < 1))
+                    fail("--inflate-jobs=N: expecting a positive number");
+            } else if (!arg.compare(0, 13, "--parse-jobs=")) {
+                if (!parseUnsigned(arg.substr(13), this->nParseJobs))
+                    fail("--parse-jobs=N: expecting a number (0: one per CPU core)");
+                if (this->nParseJobs == 0)
+                    this->nParseJobs = std::max(1u, std::thread::hardware_concurrency());
+            } else if (!arg.compare(0, 17, "--max-open-files=")) {
+                if (!parseUnsigned(arg.substr(17), this->nMaxOpenFiles) || (this->nMaxOpenFiles < 1))
+                    fail("--max-open-files=N: expecting a positive number");
+            } else if (!arg.compare(0, 8, "--tiles=")) {
+                size_t ixX = arg.find('x', 8);
+                if ((ixX == string::npos) || !parseUnsigned(arg.substr(8, ixX - 8), this->nTileDuts) || !parseUnsigned(arg.substr(ixX + 1), this->nTileTests) || (this->nTileDuts < 1) || (this->nTileTests < 1))
+                    fail("--tiles=KxM: expecting positive numbers of DUTs (K) and tests (M) per tile e.g. --tiles=64x64");
+            } else if (!arg.compare(0, 8, "--lossy=")) {
+                char *end;
+                this->lossyBound = strtod(arg.c_str() + 8, &end);
+                if ((end == arg.c_str() + 8) || (*end != 0) || !(this->lossyBound > 0))
+                    fail("--lossy=BOUND: expecting a positive number (error bound relative to the limit range) e.g. --lossy=1e-4");
+            } else if (!arg.compare(0, 8, "--cache=")) {
+                this->cacheDir = arg.substr(8);
+                if (this->cacheDir.empty())
+                    fail("--cache=DIR: expecting a folder name");
+            } else if (!arg.compare(0, 13, "--stats-json=")) {
+                this->statsJson = arg.substr(13);
+                if (this->statsJson.empty())
+                    fail("--stats-json=FILE: expecting a file name");
+            } else if (arg == "--progress") {
+                this->progressSeconds = 5;
+            } else if (!arg.compare(0, 11, "--progress=")) {
+                char *end;
+                this->progressSeconds = strtod(arg.c_str() + 11, &end);
+                if ((end == arg.c_str() + 11) || (*end != 0) || !(this->progressSeconds > 0))
+                    fail("--progress=SECONDS: expecting a positive number");
+            } else if (arg == "--container") {
+                this->container = true;
+            } else if (arg == "--compress") {
+                this->compress = true;
+            } else if (arg == "--bitmaps") {
+                this->bitmaps = true;
+            } else if (arg == "--append") {
+                this->append = true;
+            } else if (arg == "--no-mmap") {
+                this->useMmap = false;
+            } else if (arg == "--inflate=builtin") {
+                this->useZlib = false;
+            } else if (arg == "--inflate=zlib") {
+#ifdef NO_LIBZ
+                fail("--inflate=zlib: built with NO_LIBZ");
+#endif
+                this->useZlib = true;
+            } else {
+                cerr << "unknown option '" << arg << "'" << endl;
+                fail("");
+            }
+        }
+        if (this->compress && (this->container || (this->nTileDuts > 0) || this->append))
+            fail("--compress: not supported with --container, --tiles or --append");
+        if ((this->lossyBound > 0) && (this->container || this->compress || this->append))
+            fail("--lossy=BOUND: not supported with --container, --compress or --append");
+        if ((this->nParseJobs > 1) && (this->nTileDuts > 0))
+            fail("--parse-jobs=N: not supported with --tiles (tiles need the results of all tests per DUT in one place)");
+        return ix;
+    }
+
+    static bool parseUnsigned(const string &str, unsigned int &val) {
+        if (str.empty())
+            return false;
+        char *end;
+        unsigned long tmp = strtoul(str.c_str(), &end, 10);
+        if (*end != 0)
+            return false;
+        val = (unsigned int)tmp;
+        return true;
+    }
+};
+
+//* copies len bytes into reader, blocking while the buffer is full. Returns true if the reader was shut down */
+bool pushAll(blockingCircBuf &reader, const unsigned char *src, size_t len) {
+    while (len > 0) {
+        unsigned int nBytesMax;
+        unsigned char *dest;
+        if (reader.getLargestPossiblePush(/*nBytesMin*/ 1, &nBytesMax, &dest))
+            return true;
+        unsigned int n = (unsigned int)std::min((size_t)nBytesMax, len);
+        memcpy(dest, src, n);
+        reader.reportPush(n);
+        src += n;
+        len -= n;
+    }
+    return false;
+}
+
+static FILE *openForRead(const string &filename) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) {
+        cerr << "failed to open '" << filename << "' for read";
+        fail("");
+    }
+    return f;
+}
+
+// =====================
+// === pipelineStats ===
+// =====================
+//* size of a regular file in bytes (0 e.g. for a pipe)
+static uint64_t inputSize(const string &filename) {
+    struct stat st;
+    if ((stat(filename.c_str(), &st) != 0) || !S_ISREG(st.st_mode))
+        return 0;
+    return (uint64_t)st.st_size;
+}
+
+//* ISIZE trailer of a .gz file: uncompressed size modulo 2^32 of the last gzip member
+static bool readIsize(const string &filename, uint64_t &isize) {
+    std::ifstream is(filename, std::ifstream::binary);
+    unsigned char trailer[4];
+    if (!is.seekg(-4, std::ios::end) || !is.read((char *)trailer, 4))
+        return false;
+    isize = trailer[0] | ((uint64_t)trailer[1] << 8) | ((uint64_t)trailer[2] << 16) | ((uint64_t)trailer[3] << 24);
+    return true;
+}
+
+/** counters and timers of one reader => parser => background writer pipeline (see convertFiles()), for --stats-json and --progress.
+ * Each counter is written by one thread only (relaxed load / store, no locked instruction per record) and may be read by any thread */
+class pipelineStats {
+   public:
+    enum record_e {
+        REC_FAR,
+        REC_MIR,
+        REC_PIR,
+        REC_PTR,
+        REC_MPR,
+        REC_PRR,
+        REC_OTHER,
+        nRecordTypes
+    };
+
+    //* adds n to a counter of the calling thread
+    static void add(std::atomic<uint64_t> &counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    static uint64_t get(const std::atomic<uint64_t> &counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    // === parser thread ===
+    //* one record with nBytes including the header
+    void record(unsigned char REC_TYP, unsigned char REC_SUB, unsigned int nBytes) {
+        add(this->nRecords[recordType(REC_TYP, REC_SUB)], 1);
+        add(this->bytesStdf, nBytes);
+    }
+    static record_e recordType(unsigned char REC_TYP, unsigned char REC_SUB) {
+        switch ((REC_TYP << 8) | REC_SUB) {
+            case 0x000A:
+                return REC_FAR;
+            case 0x010A:
+                return REC_MIR;
+            case 0x050A:
+                return REC_PIR;
+            case 0x0514:
+                return REC_PRR;
+            case 0x0F0A:
+                return REC_PTR;
+            case 0x0F0F:
+                return REC_MPR;
+            default:
+                return REC_OTHER;
+        }
+    }
+    static const char *recordName(record_e type) {
+        static const char *names[nRecordTypes] = {"FAR", "MIR", "PIR", "PTR", "MPR", "PRR", "other"};
+        return names[type];
+    }
+
+    // === reader thread ===
+    //* counter for the bytes read from the input files (see inputFile::setCounter())
+    std::atomic<uint64_t> *getInputCounter() {
+        return &this->bytesIn;
+    }
+
+    /** the pipeline starts on filename (the parser thread is idle). Expected STDF size for the progress: file size if uncompressed,
+     * ISIZE trailer if .gz (modulo 2^32, see inputDone()). Otherwise (e.g. BGZF, .zst) progress follows the compressed input */
+    void beginFile(const string &filename) {
+        const uint64_t size = inputSize(filename);
+        uint64_t stdfSize = 0;
+        bool isIsize = false;
+        if (size > 0) {
+            unsigned char hdr[18];
+            FILE *f = openForRead(filename);
+            inputFormat_e format = detectFormat(hdr, fread(hdr, 1, sizeof(hdr), f));
+            fclose(f);
+            if (format == FORMAT_PLAIN)
+                stdfSize = size;
+            else if ((format == FORMAT_GZIP) && readIsize(filename, stdfSize))
+                isIsize = true;
+        }
+        this->curStdfSize.store(stdfSize, std::memory_order_relaxed);
+        this->curIsIsize.store(isIsize, std::memory_order_relaxed);
+        this->curStdfStart.store(get(this->bytesStdf), std::memory_order_relaxed);
+        this->curBytesInStart.store(get(this->bytesIn), std::memory_order_relaxed);
+        this->curFileSize.store(size, std::memory_order_relaxed);
+    }
+
+    //* the parser thread has processed the file (the reader thread is idle)
+    void endFile() {
+        const uint64_t size = get(this->curFileSize);
+        if (size > 0)
+            this->bytesIn.store(get(this->curBytesInStart) + size, std::memory_order_relaxed);  // e.g. memory-mapped, or read by libz
+        add(this->inputDoneBytes, size);
+        add(this->nFiles, 1);
+        this->curFileSize.store(0, std::memory_order_relaxed);
+    }
+
+    //* input bytes (file sizes) processed so far, including the estimated share of the current file (any thread)
+    double inputDone() const {
+        const double done = (double)get(this->inputDoneBytes);
+        const uint64_t size = get(this->curFileSize);
+        if (size == 0)
+            return done;
+        const uint64_t nStdf = get(this->bytesStdf) - get(this->curStdfStart);
+        const uint64_t nIn = get(this->bytesIn) - get(this->curBytesInStart);
+        uint64_t nTotal = get(this->curStdfSize);
+        if (this->curIsIsize.load(std::memory_order_relaxed)) {
+            // ISIZE is the size modulo 2^32: take the candidate nearest to the ratio so far (not below the STDF data seen)
+            const double expected = (nIn > 0) ? (double)nStdf / nIn * size : (double)size;
+            while ((nTotal < nStdf) || ((double)nTotal + 2147483648.0 < expected))
+                nTotal += (uint64_t)1 << 32;
+        }
+        const double frac = (nTotal > 0) ? (double)nStdf / nTotal : (double)nIn / size;
+        return done + std::min(frac, 1.0) * size;
+    }
+
+    // === background writer thread ===
+    //* one flush() that wrote nBytes
+    void flushed(uint64_t ns, uint64_t nBytes) {
+        add(this->nFlushes, 1);
+        add(this->flushNs, ns);
+        add(this->flushBytes, nBytes);
+        if (ns > get(this->maxFlushNs))
+            this->maxFlushNs.store(ns, std::memory_order_relaxed);
+        if (nBytes > get(this->maxFlushBytes))
+            this->maxFlushBytes.store(nBytes, std::memory_order_relaxed);
+    }
+
+    // === end of convertFiles() ===
+    //* adds the blocking and output of a finished pipeline. ringBytes: capacity of the reader / parser buffer
+    void addRun(const ringWaits &readerWaits, uint64_t ringBytes, stdfWriter &writer) {
+        this->readerRing.add(readerWaits);
+        this->ringCapacity = std::max(this->ringCapacity, ringBytes);
+        this->shardRings.add(writer.getShardWaits());
+        this->nDuts += writer.getNDuts();
+        this->nFileOpens += writer.getFileHandles().getNOpens();
+        this->nWrites += writer.getFileHandles().getNWrites();
+        this->bytesOut += writer.getFileHandles().getNBytes();
+        for (int ix = 0; ix < warningCounts::nKinds; ++ix)
+            this->nWarnings[ix] += writer.getWarnings().get((warningCounts::kind_e)ix);
+    }
+
+    // === live (any thread) ===
+    std::atomic<uint64_t> nFiles{0};
+    //* compressed input, as read from the files
+    std::atomic<uint64_t> bytesIn{0};
+    //* decoded input (records with header)
+    std::atomic<uint64_t> bytesStdf{0};
+    std::atomic<uint64_t> nRecords[nRecordTypes] = {};
+    std::atomic<uint64_t> nFlushes{0};
+    std::atomic<uint64_t> flushNs{0};
+    std::atomic<uint64_t> flushBytes{0};
+    std::atomic<uint64_t> maxFlushNs{0};
+    //* largest flush: highest backlog of buffered output (bytes)
+    std::atomic<uint64_t> maxFlushBytes{0};
+
+    // === after the run (see addRun()) ===
+    ringWaits readerRing;
+    uint64_t ringCapacity = 0;
+    ringWaits shardRings;
+    uint64_t nDuts = 0;
+    uint64_t nFileOpens = 0;
+    uint64_t nWrites = 0;
+    uint64_t bytesOut = 0;
+    uint64_t nWarnings[warningCounts::nKinds] = {};
+
+   protected:
+    // === current file (see beginFile()) ===
+    std::atomic<uint64_t> curFileSize{0};
+    std::atomic<uint64_t> curStdfSize{0};
+    std::atomic<bool> curIsIsize{false};
+    std::atomic<uint64_t> curStdfStart{0};
+    std::atomic<uint64_t> curBytesInStart{0};
+    //* sizes of the completed files
+    std::atomic<uint64_t> inputDoneBytes{0};
+};
+
+/** statistics of a whole run over all pipelines (one per concurrent job, see convertFilesParallel()): periodic progress line (--progress)
+ * and stats file (--stats-json) */
+class runStats {
+   public:
+    runStats(const options &opt, const std::vector<string> &flist, unsigned int nPipelines) {
+        this->tStart = std::chrono::steady_clock::now();
+        this->statsJson = opt.statsJson;
+        for (unsigned int ix = 0; ix < nPipelines; ++ix)
+            this->pipelines.push_back(std::unique_ptr<pipelineStats>(new pipelineStats()));
+        for (auto it = flist.begin(); it != flist.end(); ++it)
+            this->inputTotal += inputSize(*it);
+        this->nFilesTotal = flist.size();
+        if (opt.progressSeconds > 0)
+            this->progressThread = std::thread([this](double seconds) { this->progressLoop(seconds); }, opt.progressSeconds);
+    }
+
+    pipelineStats &pipeline(unsigned int ix) {
+        return *this->pipelines[ix];
+    }
+
+    //* a file that is not converted (conversion cache) counts as done (calling thread only)
+    void skipFile(const string &filename) {
+        pipelineStats::add(this->inputSkipped, inputSize(filename));
+        pipelineStats::add(this->nFilesSkipped, 1);
+    }
+
+    //* ends the progress line and writes the stats file, if requested
+    void finish() {
+        this->stopProgress();
+        if (this->statsJson.empty())
+            return;
+        std::ofstream os(this->statsJson);
+        this->writeJson(os);
+        os.close();
+        if (!os) {
+            cerr << "Failed to write '" << this->statsJson << "'" << endl;
+            fail("");
+        }
+    }
+
+    ~runStats() {
+        this->stopProgress();
+    }
+
+   protected:
+    double elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - this->tStart).count();
+    }
+
+    void stopProgress() {
+        {
+            std::lock_guard<std::mutex> lk(this->m);
+            this->isDone = true;
+        }
+        this->cv.notify_all();
+        if (this->progressThread.joinable())
+            this->progressThread.join();
+    }
+
+    //* one line every "seconds" e.g. "progress: 41.7%, 1.2 GB STDF at 310.4 MB/s, 52000 DUTs, ETA 0:00:47"
+    void progressLoop(double seconds) {
+        std::unique_lock<std::mutex> lk(this->m);
+        while (!this->cv.wait_for(lk, std::chrono::duration<double>(seconds), [this] { return this->isDone; })) {
+            double done = (double)pipelineStats::get(this->inputSkipped);
+            uint64_t nStdf = 0;
+            uint64_t nDuts = 0;
+            uint64_t nFiles = pipelineStats::get(this->nFilesSkipped);
+            for (auto it = this->pipelines.begin(); it != this->pipelines.end(); ++it) {
+                done += (*it)->inputDone();
+                nStdf += pipelineStats::get((*it)->bytesStdf);
+                nDuts += pipelineStats::get((*it)->nRecords[pipelineStats::REC_PRR]);
+                nFiles += pipelineStats::get((*it)->nFiles);
+            }
+            const double t = this->elapsed();
+            std::stringstream ss;
+            ss.setf(std::ios::fixed);
+            ss.precision(1);
+            ss << "progress: ";
+            if (this->inputTotal > 0)
+                ss << 100.0 * done / this->inputTotal << "%, ";
+            ss << nFiles << " of " << this->nFilesTotal << " files, " << nStdf / 1048576.0 << " MB STDF at " << nStdf / 1048576.0 / t << " MB/s, " << nDuts << " DUTs";
+            if ((this->inputTotal > 0) && (done > 0)) {
+                uint64_t eta = (uint64_t)(t * (this->inputTotal - done) / done);
+                ss << ", ETA " << eta / 3600 << ":" << std::setfill('0') << std::setw(2) << (eta / 60) % 60 << ":" << std::setw(2) << eta % 60;
+            }
+            cout << ss.str() << endl;
+        }
+    }
+
+    static double seconds(uint64_t ns) {
+        return ns * 1e-9;
+    }
+
+    static void writeWaits(std::ostream &os, const char *producer, const char *consumer, const ringWaits &w) {
+        os << "\"" << producer << "BlockedWaits\": " << w.nPushWaits << ", \"" << producer << "BlockedSeconds\": " << seconds(w.pushWaitNs)
+           << ", \"" << consumer << "StarvedWaits\": " << w.nPopWaits << ", \"" << consumer << "StarvedSeconds\": " << seconds(w.popWaitNs)
+           << ", \"peakBytes\": " << w.peakBytes;
+    }
+
+    //* totals of all pipelines
+    void writeJson(std::ostream &os) {
+        pipelineStats sum;
+        ringWaits readerRing;
+        ringWaits shardRings;
+        uint64_t maxFlushNs = 0;
+        uint64_t maxFlushBytes = 0;
+        uint64_t ringCapacity = 0;
+        for (auto it = this->pipelines.begin(); it != this->pipelines.end(); ++it) {
+            const pipelineStats &p = **it;
+            pipelineStats::add(sum.nFiles, pipelineStats::get(p.nFiles));
+            pipelineStats::add(sum.bytesIn, pipelineStats::get(p.bytesIn));
+            pipelineStats::add(sum.bytesStdf, pipelineStats::get(p.bytesStdf));
+            for (int ix = 0; ix < pipelineStats::nRecordTypes; ++ix)
+                pipelineStats::add(sum.nRecords[ix], pipelineStats::get(p.nRecords[ix]));
+            pipelineStats::add(sum.nFlushes, pipelineStats::get(p.nFlushes));
+            pipelineStats::add(sum.flushNs, pipelineStats::get(p.flushNs));
+            pipelineStats::add(sum.flushBytes, pipelineStats::get(p.flushBytes));
+            maxFlushNs = std::max(maxFlushNs, pipelineStats::get(p.maxFlushNs));
+            maxFlushBytes = std::max(maxFlushBytes, pipelineStats::get(p.maxFlushBytes));
+            readerRing.add(p.readerRing);
+            shardRings.add(p.shardRings);
+            ringCapacity = std::max(ringCapacity, p.ringCapacity);
+            sum.nDuts += p.nDuts;
+            sum.nFileOpens += p.nFileOpens;
+            sum.nWrites += p.nWrites;
+            sum.bytesOut += p.bytesOut;
+            for (int ix = 0; ix < warningCounts::nKinds; ++ix)
+                sum.nWarnings[ix] += p.nWarnings[ix];
+        }
+        const uint64_t nFlushes = pipelineStats::get(sum.nFlushes);
+        const uint64_t flushBytes = pipelineStats::get(sum.flushBytes);
+
+        os << "{\n";
+        os << "  \"seconds\": " << this->elapsed() << ",\n";
+        os << "  \"pipelines\": " << this->pipelines.size() << ",\n";
+        os << "  \"files\": " << pipelineStats::get(sum.nFiles) << ",\n";
+        os << "  \"filesSkipped\": " << pipelineStats::get(this->nFilesSkipped) << ",\n";
+        os << "  \"bytesIn\": " << pipelineStats::get(sum.bytesIn) << ",\n";
+        os << "  \"bytesStdf\": " << pipelineStats::get(sum.bytesStdf) << ",\n";
+        os << "  \"bytesOut\": " << sum.bytesOut << ",\n";
+        os << "  \"duts\": " << sum.nDuts << ",\n";
+        os << "  \"records\": {";
+        for (int ix = 0; ix < pipelineStats::nRecordTypes; ++ix)
+            os << (ix ? ", " : "") << "\"" << pipelineStats::recordName((pipelineStats::record_e)ix) << "\": " << pipelineStats::get(sum.nRecords[ix]);
+        os << "},\n";
+        os << "  \"readerRing\": {\"capacityBytes\": " << ringCapacity << ", ";
+        writeWaits(os, "reader", "parser", readerRing);
+        os << "},\n";
+        os << "  \"shardRings\": {";
+        writeWaits(os, "parser", "shard", shardRings);
+        os << "},\n";
+        os << "  \"flush\": {\"count\": " << nFlushes << ", \"seconds\": " << seconds(pipelineStats::get(sum.flushNs))
+           << ", \"maxSeconds\": " << seconds(maxFlushNs) << ", \"bytes\": " << flushBytes << ", \"bytesPerFlush\": " << (nFlushes ? flushBytes / nFlushes : 0)
+           << ", \"maxBytes\": " << maxFlushBytes << "},\n";
+        os << "  \"output\": {\"fileOpens\": " << sum.nFileOpens << ", \"writes\": " << sum.nWrites << "},\n";
+#ifndef _WIN32
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+#ifdef __APPLE__
+            os << "  \"peakRssBytes\": " << (uint64_t)usage.ru_maxrss << ",\n";
+#else
+            os << "  \"peakRssBytes\": " << (uint64_t)usage.ru_maxrss * 1024 << ",\n";  // kB
+#endif
+#endif
+        os << "  \"warnings\": {";
+        for (int ix = 0; ix < warningCounts::nKinds; ++ix)
+            os << (ix ? ", " : "") << "\"" << warningCounts::name((warningCounts::kind_e)ix) << "\": " << sum.nWarnings[ix];
+        os << "}\n";
+        os << "}\n";
+    }
+
+    std::chrono::steady_clock::time_point tStart;
+    string statsJson;
+    std::vector<std::unique_ptr<pipelineStats>> pipelines;
+    //* sizes of all input files (0 for pipes)
+    uint64_t inputTotal = 0;
+    size_t nFilesTotal = 0;
+    //* see skipFile()
+    std::atomic<uint64_t> inputSkipped{0};
+    std::atomic<uint64_t> nFilesSkipped{0};
+    // === progress thread ===
+    std::thread progressThread;
+    std::mutex m;
+    std::condition_variable cv;
+    bool isDone = false;
+};
+
+// =================
+// === inputFile ===
+// =================
+//* opened input file (may be a pipe). The leading bytes are read ahead to detect the format, and replayed by read() */
+class inputFile {
+   public:
+    inputFile(const string &filename) {
+        this->filename = filename;
+        this->f = openForRead(filename);
+        this->nHdr = fread(this->hdr, 1, sizeof(this->hdr), this->f);
+        this->hdrPos = 0;
+        this->format = detectFormat(this->hdr, this->nHdr);
+    }
+    size_t read(unsigned char *dest, size_t n) {
+        if (this->hdrPos < this->nHdr) {
+            n = std::min(n, this->nHdr - this->hdrPos);
+            memcpy(dest, this->hdr + this->hdrPos, n);
+            this->hdrPos += n;
+            return n;
+        }
+        n = fread((void *)dest, 1, n, this->f);
+        if (this->nBytesRead)
+            pipelineStats::add(*this->nBytesRead, n);
+        return n;
+    }
+    //* counts the bytes read from the file into counter (reading thread only), starting with the header read ahead
+    void setCounter(std::atomic<uint64_t> *counter) {
+        this->nBytesRead = counter;
+        pipelineStats::add(*counter, this->nHdr);
+    }
+    //* counts n bytes consumed without read(), e.g. through a mapping of the file
+    void addBytesRead(uint64_t n) {
+        if (this->nBytesRead)
+            pipelineStats::add(*this->nBytesRead, n);
+    }
+    //* fread-compatible callback
+    static size_t read(void *inputFile_, unsigned char *dest, size_t n) {
+        return ((inputFile *)inputFile_)->read(dest, n);
+    }
+    bool isRegularFile() {
+        struct stat st;
+        return (stat(this->filename.c_str(), &st) == 0) && S_ISREG(st.st_mode);
+    }
+    ~inputFile() {
+        fclose(this->f);
+    }
+    string filename;
+    inputFormat_e format;
+
+   protected:
+    FILE *f;
+    unsigned char hdr[18];
+    size_t nHdr;
+    size_t hdrPos;
+    //* see setCounter() (NULL: none)
+    std::atomic<uint64_t> *nBytesRead = NULL;
+};
+
+// ==================
+// === stdfSource ===
+// ==================
+//* decoded contents of one input file. The implementation is chosen by openSource() */
+class stdfSource {
+   public:
+    virtual ~stdfSource() {
+    }
+    //* reads up to n bytes into dest. Returns 0 at end of data. Throws std::runtime_error on corrupt data */
+    virtual size_t read(unsigned char *dest, size_t n) = 0;
+};
+
+//* uncompressed .stdf
+class plainSource : public stdfSource {
+   public:
+    plainSource(inputFile &in) : in(in) {
+    }
+    size_t read(unsigned char *dest, size_t n) override {
+        return this->in.read(dest, n);
+    }
+
+   protected:
+    inputFile &in;
+};
+
+//* .gz through the built-in decoder (no library dependency)
+class builtinGzSource : public stdfSource {
+   public:
+    builtinGzSource(inputFile &in) : decoder(inputFile::read, &in) {
+    }
+    size_t read(unsigned char *dest, size_t n) override {
+        return this->decoder.read(dest, n);
+    }
+
+   protected:
+    stdfooInflate::gzipDecoder decoder;
+};
+
+#ifndef NO_LIBZ
+//* .gz through libz (opens the file by name, regular files only)
+class zlibSource : public stdfSource {
+   public:
+    zlibSource(const string &filename) {
+        this->f = gzopen(filename.c_str(), "rb");
+        if (!this->f) {
+            cerr << "failed to open '" << filename << "' for read";
+            fail("");
+        }
+        gzbuffer(this->f, 1 << 20);
+    }
+    size_t read(unsigned char *dest, size_t n) override {
+        int nRead = gzread(this->f, (void *)dest, (unsigned int)n);
+        if (nRead < 0) {
+            int errnum;
+            throw std::runtime_error(gzerror(this->f, &errnum));
+        }
+        return nRead;
+    }
+    ~zlibSource() {
+        gzclose(this->f);
+    }
+
+   protected:
+    gzFile_s *f;
+};
+#endif
+
+#ifdef WITH_ZSTD
+//* .zst through libzstd
+class zstdSource : public stdfSource {
+   public:
+    zstdSource(inputFile &file) : file(file), in(1 << 20) {
+        this->ds = ZSTD_createDStream();
+        ZSTD_initDStream(this->ds);
+        this->inBuf.src = this->in.data();
+        this->inBuf.size = 0;
+        this->inBuf.pos = 0;
+    }
+    size_t read(unsigned char *dest, size_t n) override {
+        ZSTD_outBuffer out = {dest, n, 0};
+        while (out.pos == 0) {
+            if ((this->inBuf.pos == this->inBuf.size) && !this->eof) {
+                this->inBuf.size = this->file.read(this->in.data(), this->in.size());
+                this->inBuf.pos = 0;
+                this->eof = (this->inBuf.size == 0);
+            }
+            size_t posIn = this->inBuf.pos;
+            size_t ret = ZSTD_decompressStream(this->ds, &out, &this->inBuf);
+            if (ZSTD_isError(ret))
+                throw std::runtime_error(string("zstd: ") + ZSTD_getErrorName(ret));
+            if ((out.pos > 0) || (this->inBuf.pos > posIn))
+                this->frameComplete = (ret == 0);
+            else if (this->eof) {
+                if (!this->frameComplete)
+                    throw std::runtime_error("zstd: truncated file");
+                break;
+            }
+        }
+        return out.pos;
+    }
+    ~zstdSource() {
+        ZSTD_freeDStream(this->ds);
+    }
+
+   protected:
+    inputFile &file;
+    ZSTD_DStream *ds;
+    std::vector<unsigned char> in;
+    ZSTD_inBuffer inBuf;
+    bool eof = false;
+    //* last frame was completely decoded (otherwise, end of file means truncation)
+    bool frameComplete = true;
+};
+#endif
+
+#ifdef WITH_LZ4
+//* .lz4 (frame format) through liblz4
+class lz4Source : public stdfSource {
+   public:
+    lz4Source(inputFile &file) : file(file), in(1 << 20) {
+        if (LZ4F_isError(LZ4F_createDecompressionContext(&this->ctx, LZ4F_VERSION)))
+            fail("LZ4F_createDecompressionContext failed");
+    }
+    size_t read(unsigned char *dest, size_t n) override {
+        while (true) {
+            if ((this->inPos == this->inEnd) && !this->eof) {
+                this->inEnd = this->file.read(this->in.data(), this->in.size());
+                this->inPos = 0;
+                this->eof = (this->inEnd == 0);
+            }
+            size_t nOut = n;
+            size_t nIn = this->inEnd - this->inPos;
+            size_t ret = LZ4F_decompress(this->ctx, dest, &nOut, this->in.data() + this->inPos, &nIn, NULL);
+            if (LZ4F_isError(ret))
+                throw std::runtime_error(string("lz4: ") + LZ4F_getErrorName(ret));
+            this->inPos += nIn;
+            if ((nOut > 0) || (nIn > 0))
+                this->frameComplete = (ret == 0);
+            if (nOut > 0)
+                return nOut;
+            if (this->eof && (nIn == 0)) {
+                if (!this->frameComplete)
+                    throw std::runtime_error("lz4: truncated file");
+                return 0;
+            }
+        }
+    }
+    ~lz4Source() {
+        LZ4F_freeDecompressionContext(this->ctx);
+    }
+
+   protected:
+    inputFile &file;
+    LZ4F_dctx *ctx;
+    std::vector<unsigned char> in;
+    size_t inPos = 0;
+    size_t inEnd = 0;
+    bool eof = false;
+    //* last frame was completely decoded (otherwise, end of file means truncation)
+    bool frameComplete = true;
+};
+#endif
+
+//* returns the decoder for the format of "in"
+static std::unique_ptr<stdfSource> openSource(inputFile &in, const options &opt) {
+    switch (in.format) {
+        case FORMAT_GZIP:
+        case FORMAT_BGZF:
+#ifndef NO_LIBZ
+            if (opt.useZlib && in.isRegularFile())
+                return std::unique_ptr<stdfSource>(new zlibSource(in.filename));
+#endif
+            return std::unique_ptr<stdfSource>(new builtinGzSource(in));
+        case FORMAT_ZSTD:
+#ifdef WITH_ZSTD
+            return std::unique_ptr<stdfSource>(new zstdSource(in));
+#else
+            cerr << "'" << in.filename << "' is zstd compressed. Use a build with -DWITH_ZSTD (make STDFoo_zstd.exe)" << endl;
+            fail("");
+#endif
+        case FORMAT_LZ4:
+#ifdef WITH_LZ4
+            return std::unique_ptr<stdfSource>(new lz4Source(in));
+#else
+            cerr << "'" << in.filename << "' is lz4 compressed. Use a build with -DWITH_LZ4 (make STDFoo_lz4.exe)" << endl;
+            fail("");
+#endif
+        case FORMAT_PLAIN:
+        default:
+            return std::unique_ptr<stdfSource>(new plainSource(in));
+    }
+}
+
+// =======================
+// === parallel gunzip ===
+// =======================
+// BGZF (e.g. bgzip) consists of many small, independent gzip members that state their compressed size in the header (BSIZE in "BC" extra field).
+// Those are located without decoding and inflated in parallel.
+// A plain .gz file is usually one deflate stream. If it can be mapped, parallelGzipDecoder guesses block boundaries and decodes from
+// there without history (see STDFooInflate.hpp).
+
+//* reads n bytes unless end of file
+static size_t readFully(inputFile &f, unsigned char *dest, size_t n) {
+    size_t nTot = 0;
+    while (nTot < n) {
+        size_t nRead = f.read(dest + nTot, n - nTot);
+        if (nRead == 0)
+            break;
+        nTot += nRead;
+    }
+    return nTot;
+}
+
+enum bgzfMember_e {
+    BGZF_MEMBER,
+    BGZF_END,
+    //* gzip member without BSIZE (e.g. ordinary gzip appended to BGZF): its bytes read so far are in "member"
+    BGZF_OTHER
+};
+
+//* reads the next complete BGZF member into "member". Throws std::runtime_error on truncation (the bytes up to the end of file in "member") */
+static bgzfMember_e readBgzfMember(inputFile &f, std::vector<unsigned char> &member) {
+    // === fixed gzip header + XLEN ===
+    member.resize(12);
+    size_t n = readFully(f, member.data(), 12);
+    member.resize(n);
+    if (n == 0)
+        return BGZF_END;
+    if ((n != 12) || (member[0] != 0x1f) || (member[1] != 0x8b) || (member[2] != 8) || !(member[3] & 4))
+        return BGZF_OTHER;
+    unsigned int xlen = member[10] | (member[11] << 8);
+
+    // === extra subfields: search BSIZE ===
+    member.resize(12 + xlen);
+    size_t nRead = readFully(f, member.data() + 12, xlen);
+    if (nRead != xlen) {
+        member.resize(12 + nRead);
+        throw std::runtime_error("truncated BGZF member");
+    }
+    unsigned int bsize = 0;
+    for (unsigned int ix = 12; ix + 4 <= 12 + xlen;) {
+        unsigned int slen = member[ix + 2] | (member[ix + 3] << 8);
+        if ((member[ix] == 'B') && (member[ix + 1] == 'C') && (slen == 2) && (ix + 6 <= 12 + xlen))
+            bsize = member[ix + 4] | (member[ix + 5] << 8);
+        ix += 4 + slen;
+    }
+    unsigned int nTot = bsize + 1;  // BSIZE is total member size minus one
+    if ((bsize == 0) || (nTot < 12 + xlen + 8))
+        return BGZF_OTHER;
+
+    // === remaining payload and trailer ===
+    member.resize(nTot);
+    nRead = readFully(f, member.data() + 12 + xlen, nTot - 12 - xlen);
+    if (nRead != nTot - 12 - xlen) {
+        member.resize(12 + xlen + nRead);
+        throw std::runtime_error("truncated BGZF member");
+    }
+    return BGZF_MEMBER;
+}
+
+//* decoded data of a batch of BGZF members, up to the first corrupt member (error: its description, empty if none)
+struct inflatedBatch {
+    std::vector<unsigned char> data;
+    string error;
+    //* the corrupt member
+    std::vector<unsigned char> failed;
+};
+
+//* inflates a batch of complete gzip members (concatenated in "members", with given sizes). Worker thread: reports errors in the result */
+static inflatedBatch inflateMembers(const std::vector<unsigned char> &members, const std::vector<unsigned int> &sizes, bool useZlib) {
+    // === output size is known from ISIZE trailers ===
+    size_t nOut = 0;
+    size_t pos = 0;
+    for (auto it = sizes.begin(); it != sizes.end(); ++it) {
+        pos += *it;
+        const unsigned char *t = &members[pos - 4];
+        nOut += (uint32_t)t[0] | ((uint32_t)t[1] << 8) | ((uint32_t)t[2] << 16) | ((uint32_t)t[3] << 24);
+    }
+    inflatedBatch retVal;
+    retVal.data.resize(nOut);
+
+    pos = 0;
+    size_t posOut = 0;
+    for (auto it = sizes.begin(); it != sizes.end(); ++it) {
+        const unsigned char *m = &members[pos];
+        unsigned int xlen = m[10] | (m[11] << 8);
+        const unsigned char *t = m + *it - 8;
+        uint32_t crc = (uint32_t)t[0] | ((uint32_t)t[1] << 8) | ((uint32_t)t[2] << 16) | ((uint32_t)t[3] << 24);
+        uint32_t isize = (uint32_t)t[4] | ((uint32_t)t[5] << 8) | ((uint32_t)t[6] << 16) | ((uint32_t)t[7] << 24);
+        const unsigned char *payload = m + 12 + xlen;  // raw deflate (header is parsed above)
+        size_t nPayload = *it - 12 - xlen - 8;
+
+        bool ok = false;
+#ifndef NO_LIBZ
+        if (useZlib) {
+            z_stream zs = {};
+            if (inflateInit2(&zs, -MAX_WBITS) == Z_OK) {
+                zs.next_in = (Bytef *)payload;
+                zs.avail_in = (uInt)nPayload;
+                zs.next_out = retVal.data.data() + posOut;
+                zs.avail_out = isize;
+                int ret = inflate(&zs, Z_FINISH);
+                inflateEnd(&zs);
+                ok = (ret == Z_STREAM_END) && (zs.avail_out == 0);
+            }
+        } else
+#endif
+            ok = stdfooInflate::inflateRaw(payload, nPayload, retVal.data.data() + posOut, isize);
+        if (!ok)
+            retVal.error = "corrupt BGZF member (inflate failed)";
+        else if (stdfooInflate::crc32::update(0, retVal.data.data() + posOut, isize) != crc)
+            retVal.error = "corrupt BGZF member (CRC mismatch)";
+        if (!retVal.error.empty()) {
+            retVal.data.resize(posOut);
+            retVal.failed.assign(m, m + *it);
+            break;
+        }
+        posOut += isize;
+        pos += *it;
+    }
+    return retVal;
+}
+
+//* copies everything "source" decodes into reader. Returns true if the reader was shut down
+template <class T>
+static bool pushSource(T &source, blockingCircBuf &reader) {
+    while (true) {
+        unsigned int nBytesMax;
+        unsigned char *dest;
+        if (reader.getLargestPossiblePush(/*nBytesMin*/ 1, &nBytesMax, &dest))
+            return true;  // pro forma. We're not using this direction for signaling. E.g. unrecoverable error on other end
+        size_t nRead = source.read(dest, nBytesMax);
+        if (nRead == 0)
+            return false;  // end of file
+        reader.reportPush((unsigned int)nRead);
+    }
+}
+
+//* input callback that replays bytes already read from a file, then continues reading the file
+struct replayInput {
+    const std::vector<unsigned char> *prefix;
+    size_t pos;
+    inputFile *f;
+    static size_t read(void *replayInput_, unsigned char *dest, size_t n) {
+        replayInput *r = (replayInput *)replayInput_;
+        if (r->pos < r->prefix->size()) {
+            n = std::min(n, r->prefix->size() - r->pos);
+            memcpy(dest, r->prefix->data() + r->pos, n);
+            r->pos += n;
+            return n;
+        }
+        return r->f->read(dest, n);
+    }
+};
+
+/** feeds a BGZF .stdf.gz file into reader, inflating up to nThreads batches of members at a time. From a member without BSIZE on, the
+ * rest of the file is decoded sequentially (built-in decoder). Throws std::runtime_error on corrupt or truncated data, after passing on
+ * all data decoded before it: the member with the error is decoded sequentially up to it, so the data is the same as without BGZF */
+static void main_readerBgzf(inputFile &f, blockingCircBuf &reader, const options &opt) {
+    const size_t nBatchBytes = 1 << 20;  // compressed input per inflate job
+    std::deque<std::future<inflatedBatch>> jobs;
+    std::vector<unsigned char> member;
+    bool eof = false;
+    bool isOther = false;
+    string error;
+    //* the member with the error (truncated: up to the end of file)
+    std::vector<unsigned char> failed;
+    bool isShutdown = false;
+    while (true) {
+        // === keep up to two batches per thread in flight (read-ahead) ===
+        while (!eof && !isOther && error.empty() && (jobs.size() < 2 * opt.nInflateJobs)) {
+            std::vector<unsigned char> batch;
+            std::vector<unsigned int> sizes;
+            while (batch.size() < nBatchBytes) {
+                bgzfMember_e m;
+                try {
+                    m = readBgzfMember(f, member);
+                } catch (std::runtime_error &e) {
+                    error = e.what();
+                    failed.swap(member);
+                    break;
+                }
+                if (m != BGZF_MEMBER) {
+                    eof = (m == BGZF_END);
+                    isOther = (m == BGZF_OTHER);
+                    break;
+                }
+                batch.insert(batch.end(), member.begin(), member.end());
+                sizes.push_back((unsigned int)member.size());
+            }
+            if (sizes.empty())
+                break;
+            jobs.push_back(std::async(std::launch::async, inflateMembers, std::move(batch), std::move(sizes), opt.useZlib));
+        }
+        if (jobs.empty())
+            break;
+
+        // === forward results in order ===
+        inflatedBatch batch = jobs.front().get();
+        jobs.pop_front();
+        if (pushAll(reader, batch.data.data(), batch.data.size())) {
+            isShutdown = true;
+            break;  // pro forma. See main_reader()
+        }
+        if (!batch.error.empty()) {
+            error = batch.error;
+            failed.swap(batch.failed);
+            break;
+        }
+    }
+    for (auto it = jobs.begin(); it != jobs.end(); ++it)
+        it->wait();
+    if (!error.empty()) {
+        if (!isShutdown) {
+            stdfooInflate::memoryInput src = {failed.data(), failed.size()};
+            stdfooInflate::gzipDecoder decoder(stdfooInflate::memoryInput::read, &src);
+            pushSource(decoder, reader);  // throws at the error
+        }
+        throw std::runtime_error(error);
+    }
+
+    // === rest of the file is not BGZF: continue sequentially from the start of that member ===
+    if (isOther && !isShutdown) {
+        replayInput replay = {&member, 0, &f};
+        stdfooInflate::gzipDecoder decoder(replayInput::read, &replay);
+        pushSource(decoder, reader);
+    }
+}
+
+//* .gz (not BGZF) decoded from the mapped file by parallelGzipDecoder. Counts the compressed bytes decoded into the input file's counter
+class parallelGzSource : public stdfSource {
+   public:
+    parallelGzSource(inputFile &in, mappedBuf &m, unsigned int nThreads) : in(in), decoder(m.getData(), m.getSize(), nThreads) {
+    }
+    size_t read(unsigned char *dest, size_t n) override {
+        size_t nRead = this->decoder.read(dest, n);
+        uint64_t pos = this->decoder.getInputPos();
+        if (pos > this->nCounted) {
+            this->in.addBytesRead(pos - this->nCounted);
+            this->nCounted = pos;
+        }
+        return nRead;
+    }
+
+   protected:
+    inputFile &in;
+    stdfooInflate::parallelGzipDecoder decoder;
+    uint64_t nCounted = 0;
+};
+
+/** feeds a .gz file (not BGZF) into reader, decoding on opt.nInflateJobs threads. Returns false if the file cannot be mapped (pipe,
+ * Windows), for sequential decoding instead. Throws std::runtime_error on corrupt data, after passing on all data decoded before it */
+static bool main_readerGzip(inputFile &f, blockingCircBuf &reader, const options &opt) {
+    mappedBuf m(f.filename);
+    if (!m.isMapped() || (m.getFormat() != FORMAT_GZIP))
+        return false;
+    parallelGzSource source(f, m, opt.nInflateJobs);
+    pushSource(source, reader);
+    return true;
+}
+
+//* feeds one file into reader at a time, decoding according to its format. stats: counts the bytes read (may be NULL)
+void main_reader(string filename, blockingCircBuf &reader, const options &opt, pipelineStats *stats = NULL) {
+    inputFile in(filename);
+    if (stats)
+        in.setCounter(stats->getInputCounter());
+    try {
+        bool isDone = false;
+        if ((in.format == FORMAT_BGZF) && (opt.nInflateJobs > 1)) {
+            main_readerBgzf(in, reader, opt);
+            isDone = true;
+        } else if ((in.format == FORMAT_GZIP) && (opt.nInflateJobs > 1) && opt.useMmap && !opt.useZlib) {
+            isDone = main_readerGzip(in, reader, opt);
+        }
+        if (!isDone) {
+            std::unique_ptr<stdfSource> source = openSource(in, opt);
+            pushSource(*source, reader);
+        }
+    } catch (std::runtime_error &e) {
+        // keep what was decoded so far (e.g. truncated file from aborted test)
+        cerr << "Warning: " << filename << ": " << e.what() << endl;
+    }
+    cout << "finished " << filename << endl;
+}
+
+//* processes one file out of "reader" (blockingCircBuf or mappedBuf) at a time into "writer", counting the records into "stats"
+template <class T>
+void main_writer(string filename, T &reader, stdfWriter &writer, pipelineStats &stats) {
+    unsigned int nBytesAvailable = 0;  // defval is never used
+    bool startup = true;
+    while (true) {
+        unsigned char *ptr;
+        // === get at least 2 bytes to know size of following record ===
+        // we also read the REC_TYP, REC_SUB bytes for sanity check at startup
+        bool shutdown = reader.getLargestPossiblePop(4, &nBytesAvailable, &ptr);
+        if (shutdown)
+            goto breakOuterLoop;
+
+        if (startup) {
+            unsigned char *ptrCopy = ptr + 2;  // skip 16-bit record length
+            uint16_t SUB_TYP = decode<uint16_t>(ptrCopy);
+
+            if (SUB_TYP == 0x0A00) {         // REC_TYP==0 and REC_SUB==10
+                                             // OK...
+            } else if (SUB_TYP == 0x000A) {  // above but swapped => wrong endian-ness
+                fail("Big Endian STDF file format is not supported");
+            } else {
+                fail("invalid STDF file ('first record must be FAR')");  // see  STDF spec v4 "Notes on "Initial Sequence" page 14
+            }
+            startup = false;
+        }
+
+        unsigned char *ptrCopy = ptr;  // don't want decode() to advance pointer
+        uint16_t recordSize = decode<uint16_t>(ptrCopy);
+        unsigned int recordSizeWithHeader = recordSize + 4;
+
+        // === keep reading until required record length is available ===
+        while (nBytesAvailable < recordSizeWithHeader) {
+            shutdown = reader.getLargestPossiblePop(recordSizeWithHeader,
+                                                    &nBytesAvailable, &ptr);
+            if (shutdown)
+                goto breakOuterLoop;
+        }  // while less data than record length
+
+        // === process record in-place ===
+        stats.record(ptr[2], ptr[3], recordSizeWithHeader);
+        writer.stdfRecord((unsigned char *)ptr);
+
+        // === release processed length of input data ===
+        reader.pop(recordSizeWithHeader);
+    }  // while true (records in file)
+
+breakOuterLoop:
+    if (nBytesAvailable != 0) {
+        // end-of-file with unconsumed bytes (one per file: always printed)
+        writer.getWarnings().add(warningCounts::PARTIAL_RECORD);
+        cerr << "Warning: " << filename
+             << " has incorrect format (partial record)" << endl;
+    }
+    writer.reportFile(filename);
+}
+
+//* determine whether the filename indicates a list of input files
+bool isDotTxt(string fname) {
+    if (fname.length() < 4)
+        return false;
+    string ending = fname.substr(fname.length() - 4, 4);
+    if (ending.compare(".txt"))
+        return false;  // differs
+    return true;
+}
+
+void buildFileList(int argc, char **argv, int ixFirst, std::vector<string> &flist) {
+    for (int ixFile = ixFirst; ixFile < argc; ++ixFile) {
+        string filename(argv[ixFile]);
+        if (isDotTxt(filename)) {
+            std::ifstream h(filename);  // RAII auto-close
+            if (!h.is_open()) {
+                cerr << "failed to open '" << filename << " for read'\n";
+                fail("");
+            }
+            while (h >> filename)
+                if (filename.length() > 0)
+                    flist.push_back(filename);
+        } else {
+            flist.push_back(filename);
+        }
+    }
+
+    // === try to open any input file ===
+    // so we don't fail unnecessarily in the middle of a long conversion job
+    for (auto it = flist.begin(); it != flist.end(); ++it) {
+        std::ifstream h(*it);  // RAII auto-close
+        if (!h.is_open()) {
+            cerr << "failed to open '" << *it << " for read'\n";
+            fail("");
+        }
+    }
+}
+
+//* one input file, as passed from reader to parser thread
+struct inputJob {
+    string filename;
+    //* set if the parser reads the file directly from memory (otherwise through blockingCircBuf)
+    std::shared_ptr<mappedBuf> mapped;
+};
+
+/** converts all files in flist, in order, into folder dirname (one reader => parser => background writer pipeline).
+ * Adds counters and timers to stats (NULL: none, see runStats) */
+void convertFiles(const string &dirname, const std::vector<string> &flist, const options &opt, pipelineStats *stats = NULL) {
+    unsigned int nCirc = 65600 * 128;    // max. read-ahead (performance parameter. This number gives best performance on 5 GB testcase)
+    unsigned int nChunkMax = 65535 + 4;  // max. single pop size. STDF 4-byte header is not included in 16-bit count
+    pingPongMailbox<inputJob> mailbox;
+    pipelineStats ownStats;
+    if (!stats)
+        stats = &ownStats;
+
+    blockingCircBuf reader(nCirc, nChunkMax);
+    std::thread readerThread([&flist, &reader, &mailbox, &opt, stats] {
+        for (auto it = flist.begin(); it != flist.end(); ++it) {
+            inputJob job;
+            job.filename = *it;
+
+            // === wait for downstream processing to finish ===
+            // this thread owns the "PING" end of the mailbox
+            mailbox.waitFor(mailbox.PING);
+            stats->beginFile(job.filename);
+
+            // === uncompressed regular file: parsed in place by the downstream thread ===
+            if (opt.useMmap) {
+                job.mapped = std::make_shared<mappedBuf>(job.filename);
+                if (job.mapped->isMapped() && (job.mapped->getFormat() == FORMAT_PLAIN)) {
+                    mailbox.setState(mailbox.PONG, job);
+                    continue;
+                }
+                job.mapped.reset();  // e.g. pipe: stream instead
+            }
+
+            reader.setShutdown(false);
+
+            // === notify downstream processing ===
+            mailbox.setState(mailbox.PONG, job);
+
+            // === feed data ===
+            main_reader(job.filename, reader, opt, stats);
+            reader.setShutdown(true);
+        }
+
+        mailbox.waitFor(mailbox.PING);
+
+        // === notify downstream processing there is no more data ===
+        mailbox.setState(mailbox.PONG, /*agreed protocol: empty filename => done*/
+                         inputJob());
+    });
+
+    stdfWriter writer(dirname, opt.nMaxOpenFiles);
+    writer.setContainer(opt.container);
+    writer.setParseJobs(opt.nParseJobs);
+    if (opt.compress)
+        writer.setCompress();
+    if (opt.bitmaps)
+        writer.setBitmaps();
+    if (opt.nTileDuts > 0)
+        writer.setTiles(opt.nTileDuts, opt.nTileTests);
+    std::thread recordParserThread([&reader, &writer, &mailbox, stats] {
+        while (true) {
+            // === wait for news ===
+            // this thread owns the "PONG" end of the mailbox
+            mailbox.waitFor(mailbox.PONG);
+            inputJob job = mailbox.getPayload();
+            if (job.filename.length() == 0) {
+                break;
+            }
+            if (job.mapped) {
+                main_writer(job.filename, *job.mapped, writer, *stats);
+                cout << "finished " << job.filename << endl;  // streamed: reported by main_reader()
+            } else
+                main_writer(job.filename, reader, writer, *stats);
+            job.mapped.reset();  // unmap before handing back
+            stats->endFile();
+            mailbox.setState(mailbox.PING, /*don't-care return payload*/
+                             inputJob());
+        }
+    });
+
+    bool backgroundWriteRunning = true;
+    std::thread backgroundWriterThread([&writer, &backgroundWriteRunning, stats] {
+        while (backgroundWriteRunning) {
+            const auto tStart = std::chrono::steady_clock::now();
+            const uint64_t nBytesBefore = writer.getFileHandles().getNBytes();
+            bool wroteSomeData = writer.flush();
+            if (wroteSomeData)
+                stats->flushed((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tStart).count(),
+                               writer.getFileHandles().getNBytes() - nBytesBefore);
+            // suspend if idle (don't go into a spin loop if inbound data is slow).
+            // Note: Could use a condition variable signaled on data but sleep() is simple and stupid with minimal overhead.
+            if (!wroteSomeData)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    readerThread.join();
+    recordParserThread.join();
+    reader.setShutdown(true);  // redundant unless no files
+    backgroundWriteRunning = false;
+    backgroundWriterThread.join();
+    writer.close();
+    stats->addRun(reader.getWaits(), nCirc, writer);
+}
+
+// ===========================
+// === parallel conversion ===
+// ===========================
+// Each input file is converted into its own "fragment" subfolder by an independent pipeline.
+// mergeFragments() then concatenates the fragments in command line order, giving the same result as convertFiles().
+// Note: Each file must be self-contained (PIR / PRR pairs may not span files, as all state is reset between fragments).
+
+//* reads a complete binary file into a vector. Missing file returns empty vector */
+template <class T>
+static std::vector<T> readBinaryFile(const string &fname) {
+    std::ifstream is(fname, std::ifstream::binary | std::ifstream::ate);
+    std::vector<T> retVal;
+    if (!is.is_open())
+        return retVal;
+    std::streamoff nBytes = is.tellg();
+    retVal.resize(nBytes / sizeof(T));
+    is.seekg(0);
+    is.read((char *)retVal.data(), retVal.size() * sizeof(T));
+    return retVal;
+}
+
+//* reads newline-terminated text file into lines */
+static std::vector<string> readLines(const string &fname) {
+    std::ifstream is(fname, std::ifstream::binary);
+    std::vector<string> retVal;
+    string line;
+    while (std::getline(is, line))
+        retVal.push_back(line);
+    return retVal;
+}
+
+//* appends contents of file src to dest. Returns number of bytes copied (0 if src does not exist) */
+static uint64_t appendFile(std::ofstream &dest, const string &src) {
+    std::ifstream is(src, std::ifstream::binary);
+    if (!is.is_open())
+        return 0;
+    std::vector<char> buf(1 << 20);
+    uint64_t nTot = 0;
+    while (is) {
+        is.read(buf.data(), buf.size());
+        std::streamsize n = is.gcount();
+        dest.write(buf.data(), n);
+        nTot += n;
+    }
+    return nTot;
+}
+
+//* size of a file in bytes (0 if missing)
+static uint64_t fileSize(const string &fname) {
+    std::ifstream is(fname, std::ifstream::binary | std::ifstream::ate);
+    if (!is.is_open())
+        return 0;
+    return (uint64_t)is.tellg();
+}
+
+static bool fileExists(const string &fname) {
+    std::ifstream h(fname);  // RAII auto-close
+    return h.is_open();
+}
+
+//* isAppend: write to the end of an existing file (otherwise truncate)
+static std::ofstream openForWrite(const string &fname, bool isAppend = false) {
+    std::ofstream h(fname, std::ofstream::out | std::ofstream::binary | (isAppend ? std::ofstream::app : std::ofstream::out));
+    if (!h.is_open()) {
+        cerr << "Failed to open '" << fname << "' for write" << endl;
+        fail("");
+    }
+    return h;
+}
+
+//* reads the statistics of level "site." or "file." with nGroups per test (see commonLogger::writeStats()). Returns false if missing or inconsistent
+static bool readMoments(const string &dirname, const string &prefix, size_t nTests, size_t nGroups, std::vector<testMoments> &m) {
+    std::vector<uint64_t> count = readBinaryFile<uint64_t>(dirname + "/" + prefix + "count.uint64");
+    std::vector<double> mean = readBinaryFile<double>(dirname + "/" + prefix + "mean.double");
+    std::vector<double> m2 = readBinaryFile<double>(dirname + "/" + prefix + "m2.double");
+    std::vector<float> min = readBinaryFile<float>(dirname + "/" + prefix + "min.float");
+    std::vector<float> max = readBinaryFile<float>(dirname + "/" + prefix + "max.float");
+    std::vector<uint32_t> hist = readBinaryFile<uint32_t>(dirname + "/" + prefix + "hist.uint32");
+    const size_t n = nTests * nGroups;
+    if ((count.size() != n) || (mean.size() != n) || (m2.size() != n) || (min.size() != n) || (max.size() != n) || (hist.size() != n * testMoments::nBins))
+        return false;
+    m.resize(n);
+    for (size_t ix = 0; ix < n; ++ix) {
+        m[ix].n = count[ix];
+        if (count[ix] == 0)
+            continue;  // NaN mean, min, max
+        m[ix].mean = mean[ix];
+        m[ix].m2 = m2[ix];
+        m[ix].min = min[ix];
+        m[ix].max = max[ix];
+        memcpy(m[ix].hist, &hist[ix * testMoments::nBins], sizeof(m[ix].hist));
+    }
+    return true;
+}
+
+/** adds the statistics of the results in dirname (nFiles input files) to cmLog, with its first file at ixFirstFile.
+ * Returns false if there are none (e.g. results from an earlier version) */
+static bool loadStats(commonLogger &cmLog, const string &dirname, size_t ixFirstFile, size_t nFiles) {
+    std::vector<uint32_t> testnums = readBinaryFile<uint32_t>(dirname + "/testnums.uint32");
+    std::vector<uint8_t> sites = readBinaryFile<uint8_t>(dirname + "/stats.sites.uint8");
+    std::vector<uint64_t> siteDuts = readBinaryFile<uint64_t>(dirname + "/stats.siteDuts.uint64");
+    std::vector<testMoments> bySite;
+    std::vector<testMoments> byFile;
+    if (!fileExists(dirname + "/stats.count.uint64") || (siteDuts.size() != sites.size()) ||
+        !readMoments(dirname, "stats.site.", testnums.size(), sites.size(), bySite) || !readMoments(dirname, "stats.file.", testnums.size(), nFiles, byFile))
+        return false;
+
+    // === by SITE_NUM ===
+    const size_t nSites = sites.empty() ? 0 : *std::max_element(sites.begin(), sites.end()) + 1;
+    std::vector<uint64_t> dutsBySite(nSites, 0);
+    for (size_t ixSite = 0; ixSite < sites.size(); ++ixSite)
+        dutsBySite[sites[ixSite]] = siteDuts[ixSite];
+    cmLog.addSiteDuts(dutsBySite);
+    for (size_t ixTest = 0; ixTest < testnums.size(); ++ixTest) {
+        std::vector<testMoments> testBySite(nSites);
+        for (size_t ixSite = 0; ixSite < sites.size(); ++ixSite)
+            testBySite[sites[ixSite]] = bySite[ixTest * sites.size() + ixSite];
+        std::vector<testMoments> testByFile(byFile.begin() + ixTest * nFiles, byFile.begin() + (ixTest + 1) * nFiles);
+        cmLog.addStats(testnums[ixTest], ixFirstFile, testByFile, testBySite);
+    }
+    return true;
+}
+
+/** per-DUT output file of mergeFragments(), written as is or block-encoded (opt.compress: file name + ".blk", see STDFooCodec.hpp).
+ * Sources are uncompressed fragment files */
+template <class T>
+class mergedColumn {
+   public:
+    mergedColumn(const string &fname, bool isCompressed, bool isAppend) : h(openForWrite(isCompressed ? fname + ".blk" : fname, isAppend)) {
+        this->fname = isCompressed ? fname + ".blk" : fname;
+        if (isCompressed)
+            this->encoder.reset(new stdfooCodec::blockEncoder<T>());
+    }
+
+    //* appends the contents of file src. Returns the number of elements (0 if src does not exist)
+    uint64_t appendFile(const string &src) {
+        std::ifstream is(src, std::ifstream::binary);
+        if (!is.is_open())
+            return 0;
+        std::vector<T> buf((1 << 20) / sizeof(T));
+        uint64_t nTot = 0;
+        while (is) {
+            is.read((char *)buf.data(), buf.size() * sizeof(T));
+            size_t n = (size_t)is.gcount() / sizeof(T);
+            this->write(buf.data(), n);
+            nTot += n;
+        }
+        return nTot;
+    }
+
+    //* appends n copies of val (e.g. NaN for DUTs without the test)
+    void pad(uint64_t n, T val) {
+        const std::vector<T> padBuf(16384, val);
+        while (n > 0) {
+            size_t nChunk = (size_t)std::min(n, (uint64_t)padBuf.size());
+            this->write(padBuf.data(), nChunk);
+            n -= nChunk;
+        }
+    }
+
+    void close() {
+        if (this->encoder) {
+            this->encoder->finish(this->encoded);
+            this->h.write((const char *)this->encoded.data(), this->encoded.size());
+        }
+        this->h.close();
+        if (!this->h) {
+            cerr << "Failed to write '" << this->fname << "'" << endl;
+            fail("");
         }
-        delete this->loggerSite;
-        delete this->loggerHardbin;
-        delete this->loggerSoftbin;
-        delete this->loggerPartId;
-        delete this->loggerPartTxt;
     }
 
    protected:
-    //* directory common to all written files
-    string directory;
-    //* data loggers per TEST_NUM
-    std::unordered_map<unsigned int, perItemLogger<float> *> loggerTestitems;
-    //* log NUM_SITE per insertion
-    perItemLogger<uint8_t> *loggerSite;
-    //* log HARD_BIN per insertion
-    perItemLogger<uint16_t> *loggerHardbin;
-    //* log SOFT_BIN per insertion
-    perItemLogger<uint16_t> *loggerSoftbin;
-    //* log PART_ID per insertion
-    perItemLogger<string> *loggerPartId;
-    //* log PART_TXT per insertion
-    perItemLogger<string> *loggerPartTxt;
-    //* timestamp to monitor PIR-PTR*n-PRR sequence, also to recognize whether data in loggers is valid (motivation: advancing one timestamp is faster than invalidating thousands of records)
-    unsigned int nextValidCode;
-    //* timestamp per site for PIR-PTR*n-PRR sequence monitoring
-    std::vector<unsigned int> siteValidCode;
-    //* number of insertions = current length of all per-DUT results
-    unsigned int dutCountBaseZero;
-    //* logger for non-per-DUT data e.g. testnames
-    commonLogger cmLog;
-    unsigned int dutsReported;
-    perFileLogger pwl;
-    unsigned int filenumBase1;
+    void write(const T *vals, size_t n) {
+        if (!this->encoder) {
+            this->h.write((const char *)vals, n * sizeof(T));
+            return;
+        }
+        this->encoder->add(vals, n, this->encoded);
+        this->h.write((const char *)this->encoded.data(), this->encoded.size());
+        this->encoded.clear();
+    }
+
+    std::ofstream h;
+    string fname;
+    std::unique_ptr<stdfooCodec::blockEncoder<T>> encoder;
+    std::vector<unsigned char> encoded;
+};
+
+//* bitmap file (see bitColumn) of mergeFragments(): sources are concatenated bit by bit, continuing after nBitsExisting bits of an existing file (isAppend)
+class mergedBits {
+   public:
+    mergedBits(const string &fname, uint64_t nBitsExisting) : fname(fname) {
+        if (nBitsExisting == 0) {
+            this->h = openForWrite(fname);
+            return;
+        }
+        // === the incomplete last byte is rewritten ===
+        uint8_t last = 0;
+        if (nBitsExisting & 7) {
+            std::ifstream is(fname, std::ifstream::binary);
+            is.seekg((std::streamoff)(nBitsExisting >> 3));
+            is.read((char *)&last, 1);
+            if (!is)
+                fail("inconsistent intermediate results");
+        }
+        this->h.open(fname, std::ofstream::in | std::ofstream::out | std::ofstream::binary);
+        if (!this->h.is_open()) {
+            cerr << "Failed to open '" << fname << "' for write" << endl;
+            fail("");
+        }
+        this->h.seekp((std::streamoff)(nBitsExisting >> 3));
+        this->bits.append(&last, nBitsExisting & 7);
+    }
+
+    /** appends the bits of nDuts DUTs from file src. Returns the number of bits (0 if src does not exist or is empty,
+     * e.g. no PRR after the first PTR) */
+    uint64_t appendFile(const string &src, uint64_t nDuts) {
+        std::vector<uint8_t> buf = readBinaryFile<uint8_t>(src);
+        if (buf.empty())
+            return 0;
+        if (buf.size() != (nDuts + 7) / 8)
+            fail("inconsistent intermediate results");
+        this->bits.append(buf.data(), nDuts);
+        this->write();
+        return nDuts;
+    }
+
+    //* appends n zero bits (DUTs without the test)
+    void pad(uint64_t n) {
+        this->bits.pad(n);
+        this->write();
+    }
+
+    void close() {
+        this->bits.finish();
+        this->write();
+        this->h.close();
+        if (!this->h) {
+            cerr << "Failed to write '" << this->fname << "'" << endl;
+            fail("");
+        }
+    }
+
+   protected:
+    void write() {
+        std::vector<uint8_t> &bytes = this->bits.getBytes();
+        this->h.write((const char *)bytes.data(), bytes.size());
+        bytes.clear();
+    }
+
+    std::ofstream h;
+    string fname;
+    bitColumn bits;
 };
 
+/** builds the tiled output (see tileWriter) from the result columns in dirname, with the same number of tiles for every block of DUTs.
+ * At most nMaxOpen columns are read at a time */
+static void writeTilesFromColumns(const string &dirname, unsigned int K, unsigned int M, const std::vector<unsigned int> &testnumBySlot, const std::vector<uint32_t> &pinBySlot, uint64_t nDuts, unsigned int nMaxOpen) {
+    const uint64_t nBlocks = (nDuts + K - 1) / K;
+    const uint64_t nTilesPerBlock = (testnumBySlot.size() + M - 1) / M;
+    std::ofstream h = openForWrite(dirname + "/tiles.float");
+    std::vector<float> tile(K * M);
+    std::vector<float> col(K);
+    for (uint64_t ixTile = 0; ixTile < nTilesPerBlock; ++ixTile) {
+        // === columns ixFirst..ixEnd-1 of this tile, limited by open files ===
+        for (unsigned int ixFirst = 0; ixFirst < M; ixFirst += nMaxOpen) {
+            unsigned int ixEnd = std::min(M, ixFirst + nMaxOpen);
+            std::vector<std::ifstream> cols(ixEnd - ixFirst);
+            for (unsigned int ix = ixFirst; ix < ixEnd; ++ix) {
+                uint64_t slot = ixTile * M + ix;
+                if (slot < testnumBySlot.size())
+                    cols[ix - ixFirst].open(dirname + "/" + resultTable::columnName(testnumBySlot[slot], pinBySlot[slot]), std::ifstream::binary);
+            }
+
+            for (uint64_t ixBlock = 0; ixBlock < nBlocks; ++ixBlock) {
+                std::fill(tile.begin(), tile.end(), std::nanf(""));
+                for (unsigned int ix = ixFirst; ix < ixEnd; ++ix) {
+                    std::ifstream &c = cols[ix - ixFirst];
+                    if (!c.is_open())
+                        continue;
+                    c.read((char *)col.data(), col.size() * sizeof(float));
+                    size_t n = c.gcount() / sizeof(float);
+                    for (size_t ixDut = 0; ixDut < n; ++ixDut)
+                        tile[ixDut * M + ix] = col[ixDut];
+                }
+
+                std::streamoff pos = (std::streamoff)((ixBlock * nTilesPerBlock + ixTile) * K * M * sizeof(float));
+                if ((ixFirst == 0) && (ixEnd == M)) {
+                    h.seekp(pos);
+                    h.write((const char *)tile.data(), tile.size() * sizeof(float));
+                } else {
+                    // partial tile: one segment per DUT
+                    for (unsigned int ixDut = 0; ixDut < K; ++ixDut) {
+                        h.seekp(pos + (std::streamoff)((ixDut * M + ixFirst) * sizeof(float)));
+                        h.write((const char *)&tile[ixDut * M + ixFirst], (ixEnd - ixFirst) * sizeof(float));
+                    }
+                }
+            }
+        }
+    }
+    if (!h) {
+        cerr << "Failed to write '" << dirname << "/tiles.float'" << endl;
+        fail("");
+    }
+
+    std::ofstream hIndex = openForWrite(dirname + "/tiles.index.uint64");
+    for (uint64_t ixBlock = 0; ixBlock < nBlocks; ++ixBlock) {
+        uint64_t tmp = ixBlock * nTilesPerBlock;
+        hIndex.write((const char *)&tmp, sizeof(tmp));
+    }
+    tileWriter::writeTileInfo(dirname, K, M, testnumBySlot, pinBySlot);
+}
+
+/** combines per-file conversion results ("fragments", one per entry in flist) into dirname.
+ * isAppend: dirname already holds results (e.g. from an earlier run), which are extended in place. Existing data is not rewritten,
+ * except for the index files (testnums.uint32 etc.), which are replaced atomically */
+void mergeFragments(const string &dirname, const std::vector<string> &fragments, const std::vector<string> &flist, const options &opt, bool isAppend) {
+    const unsigned int nJobs = opt.nJobs;
+    commonLogger cmLog(dirname);
+    cmLog.setContainer(opt.container);
+
+    // === sources: existing results (isAppend), then fragments ===
+    std::vector<string> sources;
+    if (isAppend)
+        sources.push_back(dirname);
+    sources.insert(sources.end(), fragments.begin(), fragments.end());
+    const size_t ixFirstFragment = sources.size() - fragments.size();
+
+    // DUTs per source
+    std::vector<uint64_t> duts;
+    // per TEST_NUM and pin (MPR, otherwise resultTable::noPin): index of the first source that created a result file
+    std::map<std::pair<unsigned int, uint32_t>, size_t> firstFragment;
+    size_t nFiles = 0;
+    for (size_t ixFrag = 0; ixFrag < sources.size(); ++ixFrag) {
+        const string &f = sources[ixFrag];
+        const bool isFragment = ixFrag >= ixFirstFragment;
+        std::vector<uint32_t> testnums = readBinaryFile<uint32_t>(f + "/testnums.uint32");
+        std::vector<string> testnames = readLines(f + "/testnames.txt");
+        std::vector<string> units = readLines(f + "/units.txt");
+        std::vector<float> lowLim = readBinaryFile<float>(f + "/lowLim.float");
+        std::vector<float> highLim = readBinaryFile<float>(f + "/highLim.float");
+        std::vector<uint32_t> dutsPerFile = readBinaryFile<uint32_t>(f + "/dutsPerFile.uint32");
+        std::vector<string> filenames = isFragment ? std::vector<string>(1, flist[ixFrag - ixFirstFragment]) : readLines(f + "/filenames.txt");
+        if ((testnames.size() != testnums.size()) || (units.size() != testnums.size()) || (lowLim.size() != testnums.size()) || (highLim.size() != testnums.size()) || (dutsPerFile.size() != filenames.size()))
+            fail("inconsistent intermediate results");
+
+        for (size_t ix = 0; ix < testnums.size(); ++ix) {
+            // STDF "first occurrence" establishes limits, units => first file wins
+            if (!cmLog.isLogged(testnums[ix]))
+                cmLog.log(testnums[ix], lowLim[ix], highLim[ix], testnames[ix], units[ix]);
+            auto column = std::make_pair(testnums[ix], (uint32_t)resultTable::noPin);
+            if ((firstFragment.find(column) == firstFragment.end()) && fileExists(f + "/" + resultTable::columnName(column.first, column.second)))
+                firstFragment[column] = ixFrag;
+        }
+
+        // === MPR tests ===
+        std::vector<uint32_t> mprTestnums = readBinaryFile<uint32_t>(f + "/mprTestnums.uint32");
+        std::vector<uint32_t> mprPins = readBinaryFile<uint32_t>(f + "/mprPins.uint32");
+        std::vector<string> mprTestnames = readLines(f + "/mprTestnames.txt");
+        std::vector<string> mprUnits = readLines(f + "/mprUnits.txt");
+        std::vector<float> mprLowLim = readBinaryFile<float>(f + "/mprLowLim.float");
+        std::vector<float> mprHighLim = readBinaryFile<float>(f + "/mprHighLim.float");
+        if ((mprPins.size() != mprTestnums.size()) || (mprTestnames.size() != mprTestnums.size()) || (mprUnits.size() != mprTestnums.size()) || (mprLowLim.size() != mprTestnums.size()) || (mprHighLim.size() != mprTestnums.size()))
+            fail("inconsistent intermediate results");
+        for (size_t ix = 0; ix < mprTestnums.size(); ++ix) {
+            if (!cmLog.isMprLogged(mprTestnums[ix]))
+                cmLog.logMpr(mprTestnums[ix], mprLowLim[ix], mprHighLim[ix], mprTestnames[ix], mprUnits[ix]);
+            cmLog.setMprPins(mprTestnums[ix], mprPins[ix]);
+            for (uint32_t pin = 0; pin < mprPins[ix]; ++pin) {
+                auto column = std::make_pair(mprTestnums[ix], pin);
+                if ((firstFragment.find(column) == firstFragment.end()) && fileExists(f + "/" + resultTable::columnName(column.first, column.second)))
+                    firstFragment[column] = ixFrag;
+            }
+        }
+        uint64_t nDuts = 0;
+        for (size_t ix = 0; ix < filenames.size(); ++ix) {
+            cmLog.reportFile(filenames[ix], dutsPerFile[ix]);
+            nDuts += dutsPerFile[ix];
+        }
+        duts.push_back(nDuts);
+        if (!loadStats(cmLog, f, nFiles, filenames.size()))
+            cmLog.setNoStats();
+
+        // === per-file logs e.g. MIR_1.txt => MIR_(filenum).txt ===
+        // note: existing results (isAppend) are already in place
+        std::vector<string> names = isFragment ? listDirectory(f) : std::vector<string>();
+        for (auto it = names.begin(); it != names.end(); ++it) {
+            const string suffix = "_1.txt";
+            if ((it->length() <= suffix.length()) || it->compare(it->length() - suffix.length(), suffix.length(), suffix))
+                continue;
+            std::ofstream h = openForWrite(dirname + "/" + it->substr(0, it->length() - suffix.length()) + "_" + std::to_string(nFiles + 1) + ".txt");
+            appendFile(h, f + "/" + *it);
+        }
+        nFiles += filenames.size();
+    }
+
+    // === per-DUT data common to all tests (one entry per PRR in each fragment) ===
+    {
+        mergedColumn<uint8_t> site(dirname + "/site.uint8", opt.compress, isAppend);
+        mergedColumn<uint16_t> hardbin(dirname + "/hardbin.uint16", opt.compress, isAppend);
+        mergedColumn<uint16_t> softbin(dirname + "/softbin.uint16", opt.compress, isAppend);
+        for (auto it = fragments.begin(); it != fragments.end(); ++it) {
+            site.appendFile(*it + "/site.uint8");
+            hardbin.appendFile(*it + "/hardbin.uint16");
+            softbin.appendFile(*it + "/softbin.uint16");
+        }
+        site.close();
+        hardbin.close();
+        softbin.close();
+    }
+    // === string heaps: entries are re-added in DUT order, giving the same dictionary as convertFiles() ===
+    const char *perDutHeap[] = {"PART_ID", "PART_TXT"};
+    for (auto name : perDutHeap) {
+        fileHandlePool pool(2);
+        stringHeapLogger merged(dirname + "/" + name);
+        if (isAppend)
+            merged.resume((unsigned int)duts[0]);
+        string val;
+        for (auto it = fragments.begin(); it != fragments.end(); ++it) {
+            std::vector<char> heap = readBinaryFile<char>(*it + "/" + name + ".heap");
+            std::vector<uint64_t> offsets = readBinaryFile<uint64_t>(*it + "/" + name + ".offsets.uint64");
+            for (auto itOffset = offsets.begin(); itOffset != offsets.end(); ++itOffset) {
+                if (*itOffset >= heap.size())
+                    fail("inconsistent intermediate results");
+                size_t len = (uint8_t)heap[*itOffset];
+                val.assign(heap.data() + *itOffset + 1, std::min(len, heap.size() - *itOffset - 1));
+                merged.append(val);
+            }
+            merged.flush(pool, 1 << 20);
+        }
+        merged.close(pool);
+    }
+
+    // === per-test results ===
+    // one thread per result file at a time (concatenation is largely I/O bound)
+    std::vector<std::pair<std::pair<unsigned int, uint32_t>, size_t>> jobs(firstFragment.begin(), firstFragment.end());
+    std::atomic<size_t> nextJob(0);
+    std::vector<std::thread> threads;
+    for (unsigned int ixThread = 0; ixThread < nJobs; ++ixThread) {
+        threads.push_back(std::thread([&] {
+            while (true) {
+                size_t ixJob = nextJob++;
+                if (ixJob >= jobs.size())
+                    break;
+                const string name = resultTable::columnName(jobs[ixJob].first.first, jobs[ixJob].first.second);
+                const size_t ixFirst = jobs[ixJob].second;
+                // existing results (isAppend) stay in place
+                const uint64_t nBytesExisting = isAppend ? fileSize(dirname + "/" + name) : 0;
+
+                // A result file has one entry for all DUTs, if any PRR follows the first PTR. Otherwise it stays empty.
+                // The fragment that created the file is either complete, or empty (no PRR after the first PTR).
+                bool isEmpty = true;
+                if (fileSize(sources[ixFirst] + "/" + name) > 0)
+                    isEmpty = false;
+                for (size_t ixFrag = ixFirst + 1; ixFrag < sources.size(); ++ixFrag)
+                    if (duts[ixFrag] > 0)
+                        isEmpty = false;
+                mergedColumn<float> h(dirname + "/" + name, opt.compress, isAppend);
+                for (size_t ixFrag = 0; !isEmpty && (ixFrag < sources.size()); ++ixFrag) {
+                    uint64_t n = 0;
+                    if (ixFrag < ixFirstFragment)
+                        n = (ixFrag >= ixFirst) ? nBytesExisting / sizeof(float) : 0;
+                    else if (ixFrag >= ixFirst)
+                        n = h.appendFile(sources[ixFrag] + "/" + name);
+                    // NaN for files where the test does not exist
+                    h.pad(duts[ixFrag] - n, std::nanf(""));
+                }
+                h.close();
+
+                // === pass / fail bitmaps of a PTR test: same DUTs, zero bits where the test does not exist ===
+                if (!opt.bitmaps || (jobs[ixJob].first.second != resultTable::noPin))
+                    continue;
+                const char *kinds[] = {"fail", "tested"};
+                for (auto kind : kinds) {
+                    const string bitsName = resultTable::bitsName(jobs[ixJob].first.first, kind);
+                    mergedBits b(dirname + "/" + bitsName, nBytesExisting / sizeof(float));
+                    for (size_t ixFrag = 0; !isEmpty && (ixFrag < sources.size()); ++ixFrag) {
+                        uint64_t n = 0;
+                        if (ixFrag < ixFirstFragment)
+                            n = (ixFrag >= ixFirst) ? nBytesExisting / sizeof(float) : 0;
+                        else if (ixFrag >= ixFirst)
+                            n = b.appendFile(sources[ixFrag] + "/" + bitsName, duts[ixFrag]);
+                        b.pad(duts[ixFrag] - n);
+                    }
+                    b.close();
+                }
+            }
+        }));
+    }
+    for (auto it = threads.begin(); it != threads.end(); ++it)
+        it->join();
+
+    // === tiles: slots in order of first appearance (by file, then TEST_NUM, then pin) ===
+    if (opt.nTileDuts > 0) {
+        std::vector<std::pair<size_t, std::pair<unsigned int, uint32_t>>> order;
+        for (auto it = firstFragment.begin(); it != firstFragment.end(); ++it)
+            order.push_back(std::make_pair(it->second, it->first));
+        std::sort(order.begin(), order.end());
+        std::vector<unsigned int> testnumBySlot;
+        std::vector<uint32_t> pinBySlot;
+        for (auto it = order.begin(); it != order.end(); ++it) {
+            testnumBySlot.push_back(it->second.first);
+            pinBySlot.push_back(it->second.second);
+        }
+        uint64_t nDuts = 0;
+        for (auto it = duts.begin(); it != duts.end(); ++it)
+            nDuts += *it;
+        writeTilesFromColumns(dirname, opt.nTileDuts, opt.nTileTests, testnumBySlot, pinBySlot, nDuts, opt.nMaxOpenFiles);
+    }
+
+    cmLog.close();
+}
+
 // =======================
-// === pingPongMailbox ===
+// === conversionCache ===
 // =======================
-//* minimal communication between two threads using one payload message of type T
-template <class T>
-class pingPongMailbox {
+// Folder of fragments (see mergeFragments()), one per distinct input file content, shared between runs e.g. "--cache=/data/stdfooCache".
+// Entries are keyed by a hash of the (possibly compressed) input file. Size, mtime / ctime (nanoseconds) and inode of each path seen
+// before are kept in index.txt, so known files are not re-read. A new entry is converted into a temporary folder and renamed when complete.
+// Entries may be deleted at any time (no eviction of its own).
+class conversionCache {
    public:
-    enum state_e {
-        PING,
-        PONG
+    conversionCache(const string &dirname) : dirname(dirname) {
+        createDirectory(dirname);
+        // === index: size mtime ctime inode key path. Lines of the former format (without ctime / inode) fail to parse ===
+        std::vector<string> lines = readLines(dirname + "/index.txt");
+        for (auto it = lines.begin(); it != lines.end(); ++it) {
+            std::istringstream is(*it);
+            stamp_t s;
+            string key;
+            if (!(is >> s.size >> s.mtime >> s.ctime >> s.inode >> key))
+                continue;  // damaged line: only costs a re-hash
+            string path;
+            std::getline(is >> std::ws, path);
+            this->index[path] = std::make_pair(s, key);
+        }
+    }
+
+    /** returns the cache key for the contents of filename, from the index if its stamp is unchanged, otherwise by reading the file.
+     * Returns "" for input that can't be cached (e.g. pipe). Thread-safe */
+    string getKey(const string &filename) {
+        stamp_t s;
+        string path;
+        if (!getStamp(filename, path, s))
+            return "";
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            auto it = this->index.find(path);
+            // note: keys of an earlier formatVersion are computed again
+            if ((it != this->index.end()) && (it->second.first == s) && !it->second.second.compare(0, versionPrefix().size(), versionPrefix()))
+                return it->second.second;
+        }
+        uint64_t hash;
+        if (!contentHash(filename, hash))
+            return "";
+        std::ostringstream key;
+        key << versionPrefix() << std::hex;
+        key.width(16);
+        key.fill('0');
+        key << hash << "_" << std::dec << s.size;
+
+        std::lock_guard<std::mutex> lock(this->m);
+        this->index[path] = std::make_pair(s, key.str());
+        this->isModified = true;
+        return key.str();
+    }
+
+    //* folder of the fragment for key
+    string getEntry(const string &key) const {
+        return this->dirname + "/" + key;
+    }
+
+    bool hasEntry(const string &key) const {
+        return fileExists(this->getEntry(key) + "/testnums.uint32");
+    }
+
+    //* folder to convert a new entry into (see commitEntry())
+    string getTempEntry(const string &key) const {
+        std::random_device rd;
+        return this->getEntry(key) + ".tmp" + std::to_string(rd());
+    }
+
+    //* publishes a completely converted entry. A concurrent run may have published the same entry first
+    void commitEntry(const string &tempEntry, const string &key) {
+        if (!replaceFile(tempEntry, this->getEntry(key)))
+            removeDirectory(tempEntry);
+    }
+
+    //* writes index.txt (replaced atomically)
+    void close() {
+        if (!this->isModified)
+            return;
+        const string fname = this->dirname + "/index.txt";
+        {
+            std::ofstream h = openForWrite(fname + ".tmp");
+            for (auto it = this->index.begin(); it != this->index.end(); ++it)
+                h << it->second.first.size << " " << it->second.first.mtime << " " << it->second.first.ctime << " " << it->second.first.inode << " " << it->second.second << " " << it->first << "\n";
+            if (!h)
+                fail("failed to write cache index");
+        }
+        if (!replaceFile(fname + ".tmp", fname))
+            fail("failed to replace cache index");
+        this->isModified = false;
+    }
+
+   protected:
+    //* bump if the fragment contents change, so older entries are not used
+    static const unsigned int formatVersion = 2;
+    static string versionPrefix() {
+        return "v" + std::to_string(formatVersion) + "_";
+    }
+    //* identifies a file version without reading it. mtime alone (1 s resolution) misses a rewrite within the same second; replacing
+    //* the file (rename) changes the inode, and any write or rename changes ctime, which can't be set back by the writer
+    struct stamp_t {
+        uint64_t size = 0;
+        //* nanoseconds
+        int64_t mtime = 0;
+        int64_t ctime = 0;
+        uint64_t inode = 0;
+        bool operator==(const stamp_t &other) const {
+            return (this->size == other.size) && (this->mtime == other.mtime) && (this->ctime == other.ctime) && (this->inode == other.inode);
+        }
     };
-    state_e state = PING;
-    pingPongMailbox() {
+
+    //* stamp of a regular file, and its absolute path (key of the index). Returns false if not a regular file
+    static bool getStamp(const string &filename, string &path, stamp_t &s) {
+        struct stat st;
+        if ((stat(filename.c_str(), &st) != 0) || !S_ISREG(st.st_mode))
+            return false;
+        s.size = (uint64_t)st.st_size;
+#if defined(_WIN32)
+        // whole seconds. ctime is the creation time; no inode
+        s.mtime = (int64_t)st.st_mtime * 1000000000;
+        s.ctime = (int64_t)st.st_ctime * 1000000000;
+#elif defined(__APPLE__)
+        s.mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+        s.ctime = (int64_t)st.st_ctimespec.tv_sec * 1000000000 + st.st_ctimespec.tv_nsec;
+#else
+        s.mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+        s.ctime = (int64_t)st.st_ctim.tv_sec * 1000000000 + st.st_ctim.tv_nsec;
+#endif
+        s.inode = (uint64_t)st.st_ino;
+#ifdef _WIN32
+        char buf[_MAX_PATH];
+        path = _fullpath(buf, filename.c_str(), sizeof(buf)) ? string(buf) : filename;
+#else
+        char *p = realpath(filename.c_str(), NULL);
+        path = p ? string(p) : filename;
+        free(p);
+#endif
+        return true;
     }
-    state_e getState() {
-        std::lock_guard<std::mutex> lk(this->m);
-        return this->state;
+
+    //* 64-bit hash of the file contents (four independent multiply-rotate lanes, 32 bytes per step). Returns false on read error
+    static bool contentHash(const string &filename, uint64_t &hash) {
+        const uint64_t P1 = 0x9E3779B185EBCA87ULL;
+        const uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+        auto rotl = [](uint64_t v, unsigned int n) { return (v << n) | (v >> (64 - n)); };
+        auto round = [&](uint64_t acc, uint64_t v) { return rotl(acc + v * P2, 31) * P1; };
+        uint64_t acc[4] = {P1 + P2, P2, 0, 0 - P1};
+
+        FILE *f = fopen(filename.c_str(), "rb");
+        if (!f)
+            return false;
+        std::vector<unsigned char> buf(1 << 20);
+        uint64_t nTot = 0;
+        while (true) {
+            size_t n = fread(buf.data(), 1, buf.size(), f);
+            nTot += n;
+            if (n < buf.size())
+                memset(buf.data() + n, 0, (32 - n % 32) % 32);  // zero-pad last stripe (length is mixed in below)
+            for (size_t pos = 0; pos < n; pos += 32) {
+                const unsigned char *p = buf.data() + pos;
+                for (unsigned int ixLane = 0; ixLane < 4; ++ixLane) {
+                    uint64_t v;
+                    memcpy(&v, p + 8 * ixLane, sizeof(v));
+                    acc[ixLane] = round(acc[ixLane], v);
+                }
+            }
+            if (n < buf.size())
+                break;
+        }
+        bool isError = ferror(f) != 0;
+        fclose(f);
+
+        uint64_t h = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+        for (unsigned int ixLane = 0; ixLane < 4; ++ixLane)
+            h = (h ^ round(0, acc[ixLane])) * P1 + P2;
+        h ^= nTot;
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P1;
+        h ^= h >> 32;
+        hash = h;
+        return !isError;
     }
-    T getPayload() {
-        std::lock_guard<std::mutex> lk(this->m);
-        return this->payload;
+
+    string dirname;
+    std::mutex m;
+    //* by absolute path: stamp when key was computed
+    std::map<string, std::pair<stamp_t, string>> index;
+    bool isModified = false;
+};
+
+/** converts each file in flist independently, nJobs at a time, then merges the results into dirname.
+ * isAppend: adds to the existing results in dirname (see mergeFragments())
+ * With opt.cacheDir, fragments are taken from / added to the conversion cache. Only files not seen before are converted
+ * run: counters and timers, one pipelineStats per thread (NULL: none) */
+void convertFilesParallel(const string &dirname, const std::vector<string> &flist, const options &opt, bool isAppend, runStats *run = NULL) {
+    std::unique_ptr<conversionCache> cache;
+    if (!opt.cacheDir.empty())
+        cache.reset(new conversionCache(opt.cacheDir));
+
+    // === cache keys (reads each file not seen before) ===
+    std::vector<string> keys(flist.size());
+    if (cache) {
+        std::atomic<size_t> nextFile(0);
+        std::vector<std::thread> threads;
+        for (unsigned int ixThread = 0; ixThread < opt.nJobs; ++ixThread) {
+            threads.push_back(std::thread([&] {
+                while (true) {
+                    size_t ixFile = nextFile++;
+                    if (ixFile >= flist.size())
+                        break;
+                    keys[ixFile] = cache->getKey(flist[ixFile]);
+                }
+            }));
+        }
+        for (auto it = threads.begin(); it != threads.end(); ++it)
+            it->join();
     }
-    void wait() {
-        std::unique_lock<std::mutex> lk(this->m);
-        this->evt.wait(lk);
+
+    // === fragment per file: cache entry, or temporary subfolder ===
+    std::vector<string> fragments;
+    // files to convert, with their destination folder
+    std::vector<std::pair<size_t, string>> jobs;
+    std::set<string> keysToConvert;
+    for (size_t ix = 0; ix < flist.size(); ++ix) {
+        if (keys[ix].empty()) {
+            fragments.push_back(dirname + "/_fragment" + std::to_string(ix + 1));
+            createDirectory(fragments.back());
+            jobs.push_back(std::make_pair(ix, fragments.back()));
+            continue;
+        }
+        fragments.push_back(cache->getEntry(keys[ix]));
+        // same contents may appear more than once
+        if (!cache->hasEntry(keys[ix]) && keysToConvert.insert(keys[ix]).second) {
+            jobs.push_back(std::make_pair(ix, cache->getTempEntry(keys[ix])));
+            createDirectory(jobs.back().second);
+        }
     }
-    //* change of state unlocks other wait()ing thread
-    void setState(state_e state, T payload) {
-        std::lock_guard<std::mutex> lk(this->m);
-        this->state = state;
-        this->payload = payload;
-        this->evt.notify_all();
+    if (cache)
+        cout << "cache: " << (flist.size() - jobs.size()) << " of " << flist.size() << " files reused" << endl;
+    if (run) {
+        std::vector<bool> isConverted(flist.size(), false);
+        for (auto it = jobs.begin(); it != jobs.end(); ++it)
+            isConverted[it->first] = true;
+        for (size_t ix = 0; ix < flist.size(); ++ix)
+            if (!isConverted[ix])
+                run->skipFile(flist[ix]);
     }
 
-   protected:
-    std::mutex m;
-    std::condition_variable evt;
-    T payload;
-};
+    // === divide the open file limit between jobs ===
+    options optJob = opt;
+    optJob.nMaxOpenFiles = std::max(opt.nMaxOpenFiles / opt.nJobs, 1u);
+    optJob.container = false;  // only the merged result
+    optJob.nTileDuts = 0;       // tiles are built from the merged columns
+    optJob.compress = false;    // merged columns are encoded by mergeFragments() (fragments may be cache entries, see conversionCache)
+    if (cache)
+        optJob.bitmaps = true;  // cache entries serve runs with and without --bitmaps
 
-#ifndef NO_LIBZ
-//* feeds one file into reader at a time, .stdf.gz
-void main_readerDotGz(string filename, blockingCircBuf &reader) {
-    // === feed file ===
-    gzFile_s *f = gzopen(filename.c_str(), "rb");
-    if (!f) {
-        cerr << "failed to open '" << filename << "' for read";
-        fail("");
+    std::atomic<size_t> nextJob(0);
+    std::vector<std::thread> threads;
+    for (unsigned int ixThread = 0; ixThread < opt.nJobs; ++ixThread) {
+        // one pipelineStats per thread (single writer per counter)
+        pipelineStats *stats = run ? &run->pipeline(ixThread) : NULL;
+        threads.push_back(std::thread([&, stats] {
+            while (true) {
+                size_t ixJob = nextJob++;
+                if (ixJob >= jobs.size())
+                    break;
+                const size_t ixFile = jobs[ixJob].first;
+                convertFiles(jobs[ixJob].second, std::vector<string>(1, flist[ixFile]), optJob, stats);
+                if (!keys[ixFile].empty())
+                    cache->commitEntry(jobs[ixJob].second, keys[ixFile]);
+            }
+        }));
     }
-    while (!gzeof(f)) {
-        unsigned int nBytesMax;
-        unsigned char *dest;
-        bool eos = reader.getLargestPossiblePush(/*nBytesMin*/ 1, &nBytesMax,
-                                                 &dest);
-        if (eos)  // pro forma. We're not using this direction for signaling. E.g. unrecoverable error on other end
-            break;
-        unsigned int nRead = gzread(f, (void *)dest, nBytesMax);
-        reader.reportPush(nRead);
-    }  // while not EOF
-    cout << "finished " << filename << endl;
-    gzclose(f);
+    for (auto it = threads.begin(); it != threads.end(); ++it)
+        it->join();
+    if (cache)
+        cache->close();
+
+    mergeFragments(dirname, fragments, flist, opt, isAppend);
+    for (size_t ix = 0; ix < flist.size(); ++ix)
+        if (keys[ix].empty())
+            removeDirectory(fragments[ix]);
 }
-#endif
-//* feeds one file into reader at a time, uncompressed .stdf
-void main_reader(string filename, blockingCircBuf &reader) {
-    // === feed file ===
-    FILE *f = fopen(filename.c_str(), "rb");
-    if (!f) {
-        cerr << "failed to open '" << filename << "' for read";
-        fail("");
-    }
-    while (!feof(f)) {
-        unsigned int nBytesMax;
-        unsigned char *dest;
-        bool eos = reader.getLargestPossiblePush(/*nBytesMin*/ 1, &nBytesMax,
-                                                 &dest);
-        if (eos)  // pro forma. We're not using this direction for signaling. E.g. unrecoverable error on other end
-            break;
-        unsigned int nRead = fread((void *)dest, 1, nBytesMax, f);
-        reader.reportPush(nRead);
-    }  // while not EOF
-    cout << "finished " << filename << endl;
-    fclose(f);
+
+//* adds the files in flist to the existing results in dirname. Cost is proportional to the new data (existing results are not re-read)
+void appendFiles(const string &dirname, const std::vector<string> &flist, const options &opt, runStats *run = NULL) {
+    if (opt.container || fileExists(dirname + "/container.stdfoo"))
+        fail("--append: not supported for container output");
+    if (!fileExists(dirname + "/testnums.uint32") || !fileExists(dirname + "/dutsPerFile.uint32") || !fileExists(dirname + "/filenames.txt"))
+        fail("--append: no existing results in output folder");
+    if ((opt.nTileDuts > 0) || fileExists(dirname + "/tileDims.uint32"))
+        fail("--append: not supported for tiled output");
+    if (fileExists(dirname + "/site.uint8.blk"))
+        fail("--append: not supported for compressed output");
+    if (fileExists(dirname + "/lossy.txt"))
+        fail("--append: not supported for lossy output");
+    std::vector<uint32_t> testnums = readBinaryFile<uint32_t>(dirname + "/testnums.uint32");
+    if (!testnums.empty() && (opt.bitmaps != fileExists(dirname + "/" + resultTable::bitsName(testnums[0], "tested"))))
+        fail(opt.bitmaps ? "--append: existing results have no bitmaps (convert them with --bitmaps)" : "--append: existing results have bitmaps (use --bitmaps)");
+    convertFilesParallel(dirname, flist, opt, /*isAppend*/ true, run);
 }
 
-//* processes one file out of "reader" at a time into "writer"
-void main_writer(string filename, blockingCircBuf &reader, stdfWriter &writer) {
-    unsigned int nBytesAvailable = 0;  // defval is never used
-    bool startup = true;
-    while (true) {
-        unsigned char *ptr;
-        // === get at least 2 bytes to know size of following record ===
-        // we also read the REC_TYP, REC_SUB bytes for sanity check at startup
-        bool shutdown = reader.getLargestPossiblePop(4, &nBytesAvailable, &ptr);
-        if (shutdown)
-            goto breakOuterLoop;
+// ====================
+// === lossy output ===
+// ====================
+// --lossy=BOUND replaces result columns by 16-bit values where the worst-case error stays within BOUND * (highLim - lowLim) of the test.
+// Decoded in double precision as offset + scale * q (uint16 q, 65535: NaN), or as IEEE half precision (half: columns with infinite results).
+// lossy.txt lists the converted columns, one line "name<TAB>encoding<TAB>offset<TAB>scale" per column. Other columns remain float.
+#ifndef STDFOO_NO_MAIN  // used by main() only
 
-        if (startup) {
-            unsigned char *ptrCopy = ptr + 2;  // skip 16-bit record length
-            uint16_t SUB_TYP = decode<uint16_t>(ptrCopy);
+//* IEEE 754 binary16, round to nearest even. NaN gives the canonical half NaN, out of range gives infinity
+static uint16_t floatToHalf(float val) {
+    uint32_t x;
+    memcpy(&x, &val, sizeof(x));
+    uint16_t sign = (uint16_t)((x >> 16) & 0x8000);
+    uint32_t absx = x & 0x7FFFFFFF;
+    if (absx > 0x7F800000)
+        return sign | 0x7E00;  // NaN
+    if (absx >= 0x477FF000)
+        return sign | 0x7C00;  // 65520 and above round to infinity
+    if (absx < 0x38800000)     // below 2^-14: subnormal half in units of 2^-24 (1024: smallest normal)
+        return sign | (uint16_t)std::nearbyint(std::fabs(val) * 16777216.0f);
+    uint32_t h = (absx - 0x38000000) >> 13;  // rebias the exponent (127 => 15), 10 mantissa bits
+    uint32_t rem = absx & 0x1FFF;
+    if ((rem > 0x1000) || ((rem == 0x1000) && (h & 1)))
+        ++h;  // carry into the exponent is correct
+    return sign | (uint16_t)h;
+}
 
-            if (SUB_TYP == 0x0A00) {         // REC_TYP==0 and REC_SUB==10
-                                             // OK...
-            } else if (SUB_TYP == 0x000A) {  // above but swapped => wrong endian-ness
-                fail("Big Endian STDF file format is not supported");
-            } else {
-                fail("invalid STDF file ('first record must be FAR')");  // see  STDF spec v4 "Notes on "Initial Sequence" page 14
+static float halfToFloat(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+    if (exp == 0) {
+        float val = std::ldexp((float)mant, -24);
+        return sign ? -val : val;
+    }
+    uint32_t x = sign | ((exp == 31) ? 0x7F800000 | (mant << 13) : ((exp + 112) << 23) | (mant << 13));
+    float val;
+    memcpy(&val, &x, sizeof(val));
+    return val;
+}
+
+/** encodes one result column (float file fname, ".float" stripped: base) if all values are within tol after decoding.
+ * Returns the lossy.txt line or "" (column remains float) */
+static string quantizeColumn(const string &base, const string &name, double tol) {
+    if (!(tol > 0))
+        return "";  // no limits, or an empty range
+    std::vector<float> vals = readBinaryFile<float>(base + ".float");
+
+    // === offset, scale: finest step covering the range of the column ===
+    const uint16_t nanCode = 65535;
+    double lo = INFINITY;
+    double hi = -INFINITY;
+    bool hasInf = false;
+    for (auto it = vals.begin(); it != vals.end(); ++it) {
+        if (std::isnan(*it))
+            continue;
+        hasInf |= std::isinf(*it);
+        lo = std::min(lo, (double)*it);
+        hi = std::max(hi, (double)*it);
+    }
+    std::vector<uint16_t> q(vals.size());
+    if (!hasInf) {
+        double offset = (lo <= hi) ? lo : 0;
+        double scale = (hi > lo) ? std::min((hi - lo) / (nanCode - 1), 2 * tol) : 1;
+        bool isValid = true;
+        for (size_t ix = 0; isValid && (ix < vals.size()); ++ix) {
+            if (std::isnan(vals[ix])) {
+                q[ix] = nanCode;
+                continue;
             }
-            startup = false;
+            double code = std::min(std::nearbyint((vals[ix] - offset) / scale), (double)(nanCode - 1));
+            q[ix] = (uint16_t)code;
+            isValid = std::fabs(offset + scale * code - vals[ix]) <= tol;
         }
+        if (isValid) {
+            std::ofstream h = openForWrite(base + ".uint16");
+            h.write((const char *)q.data(), q.size() * sizeof(uint16_t));
+            std::ostringstream line;
+            line.precision(17);
+            line << name << "\tuint16\t" << offset << "\t" << scale << "\n";
+            return line.str();
+        }
+    }
 
-        unsigned char *ptrCopy = ptr;  // don't want decode() to advance pointer
-        uint16_t recordSize = decode<uint16_t>(ptrCopy);
-        unsigned int recordSizeWithHeader = recordSize + 4;
-
-        // === keep reading until required record length is available ===
-        while (nBytesAvailable < recordSizeWithHeader) {
-            shutdown = reader.getLargestPossiblePop(recordSizeWithHeader,
-                                                    &nBytesAvailable, &ptr);
-            if (shutdown)
-                goto breakOuterLoop;
-        }  // while less data than record length
+    // === half precision (infinite results, which have no uint16 code) ===
+    for (size_t ix = 0; ix < vals.size(); ++ix) {
+        q[ix] = floatToHalf(vals[ix]);
+        if (!std::isnan(vals[ix]) && !(std::fabs((double)halfToFloat(q[ix]) - vals[ix]) <= tol) && (halfToFloat(q[ix]) != vals[ix]))
+            return "";
+    }
+    std::ofstream h = openForWrite(base + ".half");
+    h.write((const char *)q.data(), q.size() * sizeof(uint16_t));
+    return name + "\thalf\t0\t1\n";
+}
 
-        // === process record in-place ===
-        writer.stdfRecord((unsigned char *)ptr);
+//* converts the result columns in dirname to 16 bits where the error bound allows (see above)
+static void quantizeResults(const string &dirname, double bound, unsigned int nThreads) {
+    // === error tolerance per column, from the test limits ===
+    std::vector<std::pair<string, double>> columns;
+    std::vector<uint32_t> testnums = readBinaryFile<uint32_t>(dirname + "/testnums.uint32");
+    std::vector<float> lowLim = readBinaryFile<float>(dirname + "/lowLim.float");
+    std::vector<float> highLim = readBinaryFile<float>(dirname + "/highLim.float");
+    for (size_t ix = 0; ix < testnums.size(); ++ix)
+        columns.push_back(std::make_pair(std::to_string(testnums[ix]), bound * ((double)highLim.at(ix) - lowLim.at(ix))));
+    std::vector<uint32_t> mprTestnums = readBinaryFile<uint32_t>(dirname + "/mprTestnums.uint32");
+    std::vector<uint32_t> mprPins = readBinaryFile<uint32_t>(dirname + "/mprPins.uint32");
+    std::vector<float> mprLowLim = readBinaryFile<float>(dirname + "/mprLowLim.float");
+    std::vector<float> mprHighLim = readBinaryFile<float>(dirname + "/mprHighLim.float");
+    for (size_t ix = 0; ix < mprTestnums.size(); ++ix)
+        for (uint32_t pin = 0; pin < mprPins.at(ix); ++pin)
+            columns.push_back(std::make_pair(std::to_string(mprTestnums[ix]) + "_" + std::to_string(pin), bound * ((double)mprHighLim.at(ix) - mprLowLim.at(ix))));
 
-        // === release processed length of input data ===
-        reader.pop(recordSizeWithHeader);
-    }  // while true (records in file)
+    // === one column at a time per thread ===
+    std::vector<string> lines(columns.size());
+    std::atomic<size_t> nextColumn(0);
+    std::vector<std::thread> threads;
+    for (unsigned int ixThread = 0; ixThread < nThreads; ++ixThread) {
+        threads.push_back(std::thread([&] {
+            while (true) {
+                size_t ix = nextColumn++;
+                if (ix >= columns.size())
+                    break;
+                lines[ix] = quantizeColumn(dirname + "/" + columns[ix].first, columns[ix].first + ".float", columns[ix].second);
+            }
+        }));
+    }
+    for (auto it = threads.begin(); it != threads.end(); ++it)
+        it->join();
 
-breakOuterLoop:
-    if (nBytesAvailable != 0) {
-        // end-of-file with unconsumed bytes
-        cerr << "Warning: " << filename
-             << " has incorrect format (partial record)" << endl;
+    // === index first, then remove the float columns (readers use a float file if present) ===
+    std::ofstream h = openForWrite(dirname + "/lossy.txt");
+    unsigned int nUint16 = 0;
+    unsigned int nHalf = 0;
+    for (size_t ix = 0; ix < lines.size(); ++ix) {
+        h << lines[ix];
+        nUint16 += (lines[ix].find("\tuint16\t") != string::npos) ? 1 : 0;
+        nHalf += (lines[ix].find("\thalf\t") != string::npos) ? 1 : 0;
     }
-    writer.reportFile(filename);
+    h.close();
+    if (!h)
+        fail("failed to write lossy.txt");
+    for (size_t ix = 0; ix < lines.size(); ++ix)
+        if (!lines[ix].empty())
+            remove((dirname + "/" + columns[ix].first + ".float").c_str());
+    cout << "lossy: " << nUint16 << " of " << columns.size() << " result columns as uint16, " << nHalf << " as half" << endl;
 }
+#endif
 
-//* determine whether the filename indicates .gz compressed
-bool isDotGz(string fname) {
-    if (fname.length() < 3)
-        return false;
-    string ending = fname.substr(fname.length() - 3, 3);
-    if (ending.compare(".gz"))
-        return false;  // differs
-    return true;
-}
+// ==============
+// === whatif ===
+// ==============
+// STDFoo.exe whatif [--jobs=N] resultfolder reportfolder limits1.txt [limits2.txt ...]
+// Evaluates candidate limit sets on converted results (any output format) in a single pass over all DUTs: blocks of whatifBlockLen DUTs,
+// each read from all result columns once, checked against all sets, then released (memory stays bounded for any number of DUTs).
+// Set 0 are the limits in the folder (lowLim.float, highLim.float). Each limits file replaces the limits of the tests it lists.
+// A missing result (NaN) passes. The first failing test of a DUT is the lowest failing TEST_NUM.
+#ifndef STDFOO_NO_MAIN  // used by main() only
 
-//* determine whether the filename indicates .gz compressed
-bool isDotTxt(string fname) {
-    if (fname.length() < 4)
-        return false;
-    string ending = fname.substr(fname.length() - 4, 4);
-    if (ending.compare(".txt"))
-        return false;  // differs
-    return true;
+//* splits text into lines (newline-terminated). Also used by gather
+static std::vector<string> splitLines(stdfooReader::span<char> text) {
+    std::vector<string> retVal;
+    const char *p = text.begin();
+    while (p < text.end()) {
+        const char *eol = std::find(p, text.end(), '\n');
+        retVal.push_back(string(p, eol));
+        p = eol + 1;
+    }
+    return retVal;
 }
 
-void buildFileList(int argc, char **argv, std::vector<string> &flist) {
-    for (int ixFile = 2; ixFile < argc; ++ixFile) {
-        string filename(argv[ixFile]);
-        if (isDotTxt(filename)) {
-            std::ifstream h(filename);  // RAII auto-close
-            if (!h.is_open()) {
-                cerr << "failed to open '" << filename << " for read'\n";
-                fail("");
-            }
-            while (h >> filename)
-                if (filename.length() > 0)
-                    flist.push_back(filename);
-        } else {
-            flist.push_back(filename);
+//* DUTs per block (multiple of 64: whole mask words)
+static const size_t whatifBlockLen = 1 << 16;
+
+//* limits of all PTR tests, in order of testnums.uint32. No limit: infinite
+struct whatifSet {
+    string name;
+    std::vector<float> lo;
+    std::vector<float> hi;
+};
+
+/** replaces limits of set with those from a limits file, one "testnum,lowLim,highLim" line per test (e.g. examples/myLimits.txt). Other lines
+ * are skipped. Returns the number of tests that do not exist in the results */
+static unsigned int readWhatifLimits(const string &fname, const std::map<uint32_t, size_t> &ixByTestnum, whatifSet &set) {
+    std::ifstream is(fname, std::ifstream::binary);
+    if (!is.is_open()) {
+        cerr << "failed to open limits file '" << fname << "'" << endl;
+        fail("");
+    }
+    unsigned int nUnknown = 0;
+    string line;
+    while (std::getline(is, line)) {
+        if (!line.empty() && (line.back() == '\r'))
+            line.pop_back();
+        // === testnum, lowLim, highLim ===
+        std::vector<string> fields;
+        std::stringstream ss(line);
+        string field;
+        while (std::getline(ss, field, ','))
+            fields.push_back(field);
+        unsigned int testnum;
+        if ((fields.size() != 3) || !options::parseUnsigned(fields[0], testnum))
+            continue;
+        char *end1;
+        char *end2;
+        float lo = strtof(fields[1].c_str(), &end1);
+        float hi = strtof(fields[2].c_str(), &end2);
+        if ((end1 == fields[1].c_str()) || *end1 || (end2 == fields[2].c_str()) || *end2)
+            continue;
+        std::map<uint32_t, size_t>::const_iterator it = ixByTestnum.find(testnum);
+        if (it == ixByTestnum.end()) {
+            ++nUnknown;
+            continue;
         }
+        set.lo[it->second] = std::isnan(lo) ? -INFINITY : lo;
+        set.hi[it->second] = std::isnan(hi) ? INFINITY : hi;
     }
+    return nUnknown;
+}
 
-    // === try to open any input file ===
-    // so we don't fail unnecessarily in the middle of a long conversion job
-    for (auto it = flist.begin(); it != flist.end(); ++it) {
-        std::ifstream h(*it);  // RAII auto-close
-        if (!h.is_open()) {
-            cerr << "failed to open '" << *it << " for read'\n";
-            fail("");
+//* per-thread totals, entry ixSet * nTests + ixTest
+struct whatifCounts {
+    std::vector<uint64_t> fails;
+    std::vector<uint64_t> firstFails;
+    //* per set
+    std::vector<uint64_t> nPass;
+    std::vector<uint64_t> nNewPass;
+    //* softbin of DUTs failing the set that pass set 0, per set
+    std::vector<std::map<uint16_t, uint64_t>> newFailBins;
+};
+
+/** checks DUTs first..first+n-1 against all sets. Appends the newly failing DUTs (fail set ixSet > 0, pass set 0) to newFails[ixSet] */
+static void whatifBlock(stdfooReader::outputFolder &folder, const std::vector<uint32_t> &testnums, const std::vector<whatifSet> &sets, uint64_t first, size_t n,
+                        whatifCounts &counts, std::vector<std::vector<uint64_t>> &newFails) {
+    using stdfooReader::kernels;
+    const size_t nTests = testnums.size();
+    const size_t nWords = (n + 63) / 64;
+    // === DUTs without a fail so far, per set ===
+    std::vector<uint64_t> alive(sets.size() * nWords, ~(uint64_t)0);
+    if (n % 64)
+        for (size_t ixSet = 0; ixSet < sets.size(); ++ixSet)
+            alive[ixSet * nWords + nWords - 1] = ((uint64_t)1 << (n % 64)) - 1;
+    std::vector<uint64_t> pass(sets.size() * nWords);
+    std::vector<uint64_t> firstFail(nWords);
+    std::vector<float> scratch(n);
+    for (size_t ixTest = 0; ixTest < nTests; ++ixTest) {
+        const string name = std::to_string(testnums[ixTest]) + ".float";
+        size_t nValid;
+        const float *v = folder.block<float>(name, first, n, scratch.data(), nValid);
+        if (nValid < n) {
+            // test without results for the end of the block: missing
+            if (v != scratch.data())
+                memcpy(scratch.data(), v, nValid * sizeof(float));
+            std::fill(scratch.begin() + nValid, scratch.end(), NAN);
+            v = scratch.data();
+        }
+        for (size_t ixSet = 0; ixSet < sets.size(); ++ixSet) {
+            uint64_t *p = &pass[ixSet * nWords];
+            // === sets with the same limits share the check ===
+            size_t ixSame = 0;
+            while ((ixSame < ixSet) && ((sets[ixSame].lo[ixTest] != sets[ixSet].lo[ixTest]) || (sets[ixSame].hi[ixTest] != sets[ixSet].hi[ixTest])))
+                ++ixSame;
+            if (ixSame < ixSet)
+                memcpy(p, &pass[ixSame * nWords], nWords * sizeof(uint64_t));
+            else
+                kernels::inRange(v, n, sets[ixSet].lo[ixTest], sets[ixSet].hi[ixTest], /*nanPasses*/ true, p);
+            counts.fails[ixSet * nTests + ixTest] += n - kernels::popcount(p, nWords);
+
+            // === first fail: failing DUTs that are still alive ===
+            uint64_t *a = &alive[ixSet * nWords];
+            memcpy(firstFail.data(), a, nWords * sizeof(uint64_t));
+            kernels::andNotInto(firstFail.data(), p, nWords);
+            counts.firstFails[ixSet * nTests + ixTest] += kernels::popcount(firstFail.data(), nWords);
+            kernels::andInto(a, p, nWords);
         }
+        folder.release(name, first, n);
+    }
+
+    // === yield, newly failing / passing DUTs compared to set 0 ===
+    std::vector<uint16_t> binScratch(n);
+    size_t nBins;
+    const uint16_t *softbin = folder.block<uint16_t>("softbin.uint16", first, n, binScratch.data(), nBins);
+    std::vector<uint64_t> &delta = firstFail;
+    for (size_t ixSet = 0; ixSet < sets.size(); ++ixSet) {
+        const uint64_t *a = &alive[ixSet * nWords];
+        counts.nPass[ixSet] += kernels::popcount(a, nWords);
+        if (ixSet == 0)
+            continue;
+        memcpy(delta.data(), a, nWords * sizeof(uint64_t));
+        kernels::andNotInto(delta.data(), &alive[0], nWords);
+        counts.nNewPass[ixSet] += kernels::popcount(delta.data(), nWords);
+        for (size_t ixWord = 0; ixWord < nWords; ++ixWord)
+            for (uint64_t w = alive[ixWord] & ~a[ixWord]; w; w &= w - 1) {
+                size_t ix = 64 * ixWord + (size_t)__builtin_ctzll(w);
+                newFails[ixSet].push_back(first + ix);
+                if (ix < nBins)
+                    ++counts.newFailBins[ixSet][softbin[ix]];
+            }
     }
 }
 
-// ============
-// === main ===
-// ============
-int main(int argc, char **argv) {
-    if (argc <= 2) {
-        cerr << "usage: " << argv[0] << " outputfolder inputfile.stdf.gz"
-             << endl;
+static int whatifMain(int argc, char **argv) {
+    // === arguments ===
+    unsigned int nThreads = std::max(1u, std::thread::hardware_concurrency());
+    int ixArg = 1;
+    for (; (ixArg < argc) && !string(argv[ixArg]).compare(0, 2, "--"); ++ixArg) {
+        string arg(argv[ixArg]);
+        if (arg.compare(0, 7, "--jobs=") || !options::parseUnsigned(arg.substr(7), nThreads))
+            fail("whatif: expecting --jobs=N (0: one thread per CPU core)");
+        if (nThreads == 0)
+            nThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (argc < ixArg + 3) {
+        cerr << "usage: STDFoo.exe whatif [--jobs=N] resultfolder reportfolder limits1.txt [limits2.txt ...]" << endl;
         fail("");
     }
-    string dirname(argv[1]);
-    createDirectory(dirname);
+    const string reportDir(argv[ixArg + 1]);
 
-    std::vector<string> flist;
-    buildFileList(argc, argv, flist);
+    try {
+        stdfooReader::outputFolder folder(argv[ixArg]);
+        stdfooReader::span<uint32_t> tn = folder.testnums();
+        const std::vector<uint32_t> testnums(tn.begin(), tn.end());
+        std::map<uint32_t, size_t> ixByTestnum;
+        for (size_t ix = 0; ix < testnums.size(); ++ix)
+            ixByTestnum[testnums[ix]] = ix;
 
-    unsigned int nCirc = 65600 * 128;    // max. read-ahead (performance parameter. This number gives best performance on 5 GB testcase)
-    unsigned int nChunkMax = 65535 + 4;  // max. single pop size. STDF 4-byte header is not included in 16-bit count
-    pingPongMailbox<string> mailbox;
+        // === limit sets ===
+        std::vector<whatifSet> sets(1);
+        sets[0].name = "(folder limits)";
+        stdfooReader::span<float> lo = folder.lowLim();
+        stdfooReader::span<float> hi = folder.highLim();
+        if ((lo.size() != testnums.size()) || (hi.size() != testnums.size()))
+            fail("whatif: inconsistent lowLim.float / highLim.float");
+        for (size_t ix = 0; ix < testnums.size(); ++ix) {
+            sets[0].lo.push_back(std::isnan(lo[ix]) ? -INFINITY : lo[ix]);
+            sets[0].hi.push_back(std::isnan(hi[ix]) ? INFINITY : hi[ix]);
+        }
+        for (int ix = ixArg + 2; ix < argc; ++ix) {
+            sets.push_back(sets[0]);
+            sets.back().name = argv[ix];
+            unsigned int nUnknown = readWhatifLimits(argv[ix], ixByTestnum, sets.back());
+            if (nUnknown)
+                cout << argv[ix] << ": " << nUnknown << " limits for tests without results ignored" << endl;
+        }
 
-    blockingCircBuf reader(nCirc, nChunkMax);
-    std::thread readerThread([&flist, &reader, &mailbox] {
-        for (auto it = flist.begin(); it != flist.end(); ++it) {
-            string filename(*it);
+        // === one pass over all DUTs, blocks shared by the threads ===
+        const size_t nTests = testnums.size();
+        const uint64_t nDuts = folder.nDuts();
+        const size_t nBlocks = (size_t)((nDuts + whatifBlockLen - 1) / whatifBlockLen);
+        std::vector<whatifCounts> counts(nThreads);
+        // newFails per block and set, in DUT order once concatenated
+        std::vector<std::vector<std::vector<uint64_t>>> newFails(nBlocks, std::vector<std::vector<uint64_t>>(sets.size()));
+        std::atomic<size_t> nextBlock(0);
+        std::vector<std::thread> threads;
+        std::exception_ptr err;
+        std::mutex errMutex;
+        for (unsigned int ixThread = 0; ixThread < nThreads; ++ixThread) {
+            whatifCounts &c = counts[ixThread];
+            c.fails.assign(sets.size() * nTests, 0);
+            c.firstFails.assign(sets.size() * nTests, 0);
+            c.nPass.assign(sets.size(), 0);
+            c.nNewPass.assign(sets.size(), 0);
+            c.newFailBins.resize(sets.size());
+            threads.push_back(std::thread([&, ixThread] {
+                try {
+                    while (true) {
+                        size_t ixBlock = nextBlock++;
+                        if (ixBlock >= nBlocks)
+                            break;
+                        uint64_t first = (uint64_t)ixBlock * whatifBlockLen;
+                        size_t n = (size_t)std::min((uint64_t)whatifBlockLen, nDuts - first);
+                        whatifBlock(folder, testnums, sets, first, n, counts[ixThread], newFails[ixBlock]);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errMutex);
+                    err = std::current_exception();
+                    nextBlock = nBlocks;
+                }
+            }));
+        }
+        for (auto it = threads.begin(); it != threads.end(); ++it)
+            it->join();
+        if (err)
+            std::rethrow_exception(err);
 
-            // === wait for downstream processing to finish ===
-            // this thread owns the "PING" end of the mailbox
-            while (mailbox.getState() != mailbox.PING) {
-                mailbox.wait();
+        // === totals ===
+        whatifCounts &tot = counts[0];
+        for (unsigned int ixThread = 1; ixThread < nThreads; ++ixThread) {
+            for (size_t ix = 0; ix < tot.fails.size(); ++ix) {
+                tot.fails[ix] += counts[ixThread].fails[ix];
+                tot.firstFails[ix] += counts[ixThread].firstFails[ix];
+            }
+            for (size_t ixSet = 0; ixSet < sets.size(); ++ixSet) {
+                tot.nPass[ixSet] += counts[ixThread].nPass[ixSet];
+                tot.nNewPass[ixSet] += counts[ixThread].nNewPass[ixSet];
+                for (auto it = counts[ixThread].newFailBins[ixSet].begin(); it != counts[ixThread].newFailBins[ixSet].end(); ++it)
+                    tot.newFailBins[ixSet][it->first] += it->second;
             }
+        }
 
-            reader.setShutdown(false);
+        // === report ===
+        createDirectory(reportDir);
+        std::vector<string> testnames = splitLines(folder.column<char>("testnames.txt", true));
+        testnames.resize(nTests);
+        std::ofstream summary = openForWrite(reportDir + "/whatif.txt");
+        std::ofstream pareto = openForWrite(reportDir + "/whatifPareto.txt");
+        std::ofstream bins = openForWrite(reportDir + "/whatifBins.txt");
+        summary << "set\tlimits\tDUTs\tpass\tyield\tnewFails\tnewPasses\n";
+        pareto << "set\trank\ttestnum\tfirstFails\tfails\ttestname\n";
+        bins << "set\tsoftbin\tnewFails\n";
+        for (size_t ixSet = 0; ixSet < sets.size(); ++ixSet) {
+            const string prefix = reportDir + "/set" + std::to_string(ixSet);
+            std::ofstream h = openForWrite(prefix + ".fails.uint64");
+            h.write((const char *)&tot.fails[ixSet * nTests], nTests * sizeof(uint64_t));
+            h = openForWrite(prefix + ".firstFails.uint64");
+            h.write((const char *)&tot.firstFails[ixSet * nTests], nTests * sizeof(uint64_t));
+            uint64_t nNewFail = 0;
+            if (ixSet > 0) {
+                h = openForWrite(prefix + ".newFails.uint64");
+                for (size_t ixBlock = 0; ixBlock < nBlocks; ++ixBlock) {
+                    const std::vector<uint64_t> &duts = newFails[ixBlock][ixSet];
+                    h.write((const char *)duts.data(), duts.size() * sizeof(uint64_t));
+                    nNewFail += duts.size();
+                }
+            }
+            h.close();
+            if (!h)
+                fail("whatif: failed to write report");
 
-            // === notify downstream processing ===
-            mailbox.setState(mailbox.PONG, filename);
+            double yield = nDuts ? 100.0 * (double)tot.nPass[ixSet] / (double)nDuts : 0;
+            summary << ixSet << "\t" << sets[ixSet].name << "\t" << nDuts << "\t" << tot.nPass[ixSet] << "\t" << yield << "\t" << nNewFail << "\t" << tot.nNewPass[ixSet] << "\n";
+            cout << "set " << ixSet << " " << sets[ixSet].name << ": yield " << yield << " % (" << tot.nPass[ixSet] << " of " << nDuts << ")";
+            if (ixSet > 0)
+                cout << ", " << nNewFail << " newly failing, " << tot.nNewPass[ixSet] << " newly passing";
+            cout << endl;
 
-            // === feed data ===
-#ifndef NO_LIBZ
-            if (isDotGz(filename))
-                main_readerDotGz(filename, reader);
-            else
-                main_reader(filename, reader);
-#else
-            main_reader(filename, reader);
+            // === first-fail Pareto, descending ===
+            std::vector<size_t> order;
+            for (size_t ixTest = 0; ixTest < nTests; ++ixTest)
+                if (tot.firstFails[ixSet * nTests + ixTest] > 0)
+                    order.push_back(ixTest);
+            const uint64_t *ff = &tot.firstFails[ixSet * nTests];
+            std::stable_sort(order.begin(), order.end(), [ff](size_t a, size_t b) { return ff[a] > ff[b]; });
+            for (size_t rank = 0; rank < order.size(); ++rank) {
+                size_t ixTest = order[rank];
+                pareto << ixSet << "\t" << rank + 1 << "\t" << testnums[ixTest] << "\t" << ff[ixTest] << "\t" << tot.fails[ixSet * nTests + ixTest] << "\t" << testnames[ixTest] << "\n";
+            }
+            for (auto it = tot.newFailBins[ixSet].begin(); it != tot.newFailBins[ixSet].end(); ++it)
+                bins << ixSet << "\t" << it->first << "\t" << it->second << "\n";
+        }
+        summary.close();
+        pareto.close();
+        bins.close();
+        if (!summary || !pareto || !bins)
+            fail("whatif: failed to write report");
+    } catch (const std::exception &e) {
+        cerr << "whatif: " << e.what() << endl;
+        fail("");
+    }
+    return 0;
+}
 #endif
-            reader.setShutdown(true);
+
+// ==============
+// === gather ===
+// ==============
+// STDFoo.exe gather [--jobs=N] [--duts=FILE] [--softbin=LIST] [--hardbin=LIST] [--site=LIST] [--file=LIST] resultfolder gatherfolder
+// All results of a subset of DUTs, e.g. 10k DUTs out of millions across all tests: the DUTs listed in FILE (if given) that match all given
+// predicates. Without any, all DUTs. FILE: DUT positions (base 0) one per line, or binary if named *.uint64 (e.g. whatif setK.newFails.uint64).
+// LIST: comma-separated values; --file takes positions in filenames.txt (base 0).
+// The sorted positions are read from each result column once (outputFolder::gather: coalesced preadv ranges), columns in parallel.
+// gatherfolder:
+//   duts.uint64     DUT positions (base 0), ascending
+//   results.float   DUT x column matrix, column-major (all DUTs of the first column, then the next).
+//                   Octave: reshape(fread(h, 'float'), nDuts, nColumns)
+//   columns.txt     one line per column: testnum, pin (base 0, "-" for PTR), testname. PTR tests as in testnums.uint32, then MPR pins
+//   hardbin.uint16, softbin.uint16, site.uint8, fileIndex.uint32 (base 0), PART_ID.txt: per DUT
+#ifndef STDFOO_NO_MAIN  // used by main() only
+
+//* columns gathered in parallel, then written (memory: gatherBatchColumns * nDuts floats)
+static const size_t gatherBatchColumns = 64;
+
+//* comma-separated unsigned values e.g. "1,2,5"
+static bool parseGatherList(const string &str, std::set<unsigned int> &vals) {
+    std::istringstream is(str);
+    string item;
+    while (std::getline(is, item, ',')) {
+        unsigned int val;
+        if (!options::parseUnsigned(item, val))
+            return false;
+        vals.insert(val);
+    }
+    return !vals.empty();
+}
+
+//* DUT positions (base 0) from a text file (one per line) or a binary .uint64 file
+static std::vector<uint64_t> readGatherDuts(const string &fname) {
+    std::ifstream is(fname, std::ifstream::binary);
+    if (!is.is_open()) {
+        cerr << "failed to open DUT list '" << fname << "'" << endl;
+        fail("");
+    }
+    std::vector<uint64_t> retVal;
+    const string ext(".uint64");
+    if ((fname.size() >= ext.size()) && !fname.compare(fname.size() - ext.size(), ext.size(), ext)) {
+        uint64_t val;
+        while (is.read((char *)&val, sizeof(val)))
+            retVal.push_back(val);
+        return retVal;
+    }
+    string line;
+    while (std::getline(is, line)) {
+        std::istringstream fields(line);
+        uint64_t val;
+        if (!!(fields >> val)) {
+            retVal.push_back(val);
+        } else if (line.find_first_not_of(" \t\r") != string::npos) {
+            cerr << "gather: expecting one DUT position (base 0) per line in '" << fname << "'" << endl;
+            fail("");
         }
+    }
+    return retVal;
+}
+
+static void writeGatherFile(const string &fname, const void *p, size_t nBytes) {
+    std::ofstream h = openForWrite(fname);
+    h.write((const char *)p, (std::streamsize)nBytes);
+    h.close();
+    if (!h) {
+        cerr << "gather: failed to write " << fname << endl;
+        fail("");
+    }
+}
 
-        while (mailbox.getState() != mailbox.PING) {
-            mailbox.wait();
+static int gatherMain(int argc, char **argv) {
+    // === arguments ===
+    unsigned int nThreads = std::max(1u, std::thread::hardware_concurrency());
+    string dutsFile;
+    std::set<unsigned int> softbins;
+    std::set<unsigned int> hardbins;
+    std::set<unsigned int> sites;
+    std::set<unsigned int> files;
+    int ixArg = 1;
+    for (; (ixArg < argc) && !string(argv[ixArg]).compare(0, 2, "--"); ++ixArg) {
+        string arg(argv[ixArg]);
+        bool isValid;
+        if (!arg.compare(0, 7, "--jobs=")) {
+            isValid = options::parseUnsigned(arg.substr(7), nThreads);
+            if (nThreads == 0)
+                nThreads = std::max(1u, std::thread::hardware_concurrency());
+        } else if (!arg.compare(0, 7, "--duts=")) {
+            dutsFile = arg.substr(7);
+            isValid = !dutsFile.empty();
+        } else if (!arg.compare(0, 10, "--softbin=")) {
+            isValid = parseGatherList(arg.substr(10), softbins);
+        } else if (!arg.compare(0, 10, "--hardbin=")) {
+            isValid = parseGatherList(arg.substr(10), hardbins);
+        } else if (!arg.compare(0, 7, "--site=")) {
+            isValid = parseGatherList(arg.substr(7), sites);
+        } else if (!arg.compare(0, 7, "--file=")) {
+            isValid = parseGatherList(arg.substr(7), files);
+        } else {
+            isValid = false;
         }
+        if (!isValid) {
+            cerr << "gather: invalid argument '" << arg << "'" << endl;
+            fail("");
+        }
+    }
+    if (argc != ixArg + 2) {
+        cerr << "usage: STDFoo.exe gather [--jobs=N] [--duts=FILE] [--softbin=LIST] [--hardbin=LIST] [--site=LIST] [--file=LIST] resultfolder gatherfolder" << endl;
+        fail("");
+    }
+    const string gatherDir(argv[ixArg + 1]);
 
-        // === notify downstream processing there is no more data ===
-        mailbox.setState(mailbox.PONG, /*agreed protocol: empty string => done*/
-                         "");
-    });
+    try {
+        stdfooReader::outputFolder folder(argv[ixArg]);
+        const uint64_t nDutsTotal = folder.nDuts();
+        stdfooReader::span<uint32_t> dutsPerFile = folder.dutsPerFile();
+        std::vector<uint64_t> firstDut(1, 0);
+        for (size_t ix = 0; ix < dutsPerFile.size(); ++ix)
+            firstDut.push_back(firstDut.back() + dutsPerFile[ix]);
 
-    stdfWriter writer(dirname);
-    std::thread recordParserThread([&reader, &writer, &mailbox] {
-        while (true) {
-            // === wait for news ===
-            // this thread owns the "PONG" end of the mailbox
-            while (mailbox.getState() != mailbox.PONG) {
-                mailbox.wait();
+        // === DUT selection, ascending ===
+        std::vector<uint64_t> candidates;
+        if (!dutsFile.empty()) {
+            candidates = readGatherDuts(dutsFile);
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            if (!candidates.empty() && (candidates.back() >= nDutsTotal)) {
+                cerr << "gather: DUT position " << candidates.back() << " out of range (" << nDutsTotal << " DUTs)" << endl;
+                fail("");
             }
-            string filename = mailbox.getPayload();
-            if (filename.length() == 0) {
-                break;
+        }
+        std::vector<uint64_t> duts;
+        {
+            stdfooReader::span<uint16_t> sbin = softbins.empty() ? stdfooReader::span<uint16_t>() : folder.softbin();
+            stdfooReader::span<uint16_t> hbin = hardbins.empty() ? stdfooReader::span<uint16_t>() : folder.hardbin();
+            stdfooReader::span<uint8_t> site = sites.empty() ? stdfooReader::span<uint8_t>() : folder.site();
+            const uint64_t nCandidates = dutsFile.empty() ? nDutsTotal : candidates.size();
+            size_t ixFile = 0;
+            for (uint64_t ix = 0; ix < nCandidates; ++ix) {
+                const uint64_t dut = dutsFile.empty() ? ix : candidates[(size_t)ix];
+                if (!softbins.empty() && ((dut >= sbin.size()) || !softbins.count(sbin[(size_t)dut])))
+                    continue;
+                if (!hardbins.empty() && ((dut >= hbin.size()) || !hardbins.count(hbin[(size_t)dut])))
+                    continue;
+                if (!sites.empty() && ((dut >= site.size()) || !sites.count(site[(size_t)dut])))
+                    continue;
+                if (!files.empty()) {
+                    while (firstDut[ixFile + 1] <= dut)
+                        ++ixFile;
+                    if (!files.count((unsigned int)ixFile))
+                        continue;
+                }
+                duts.push_back(dut);
             }
-            main_writer(filename, reader, writer);
-            mailbox.setState(mailbox.PING, /*don't-care return payload*/
-                             "");
         }
-    });
+        const size_t nDuts = duts.size();
 
-    bool backgroundWriteRunning = true;
-    std::thread backgroundWriterThread([&writer, &backgroundWriteRunning] {
-        while (backgroundWriteRunning) {
-            bool wroteSomeData = writer.flush();
-            // suspend if idle (don't go into a spin loop if inbound data is slow).
-            // Note: Could use a condition variable signaled on data but sleep() is simple and stupid with minimal overhead.
-            if (!wroteSomeData)
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        // === per DUT ===
+        createDirectory(gatherDir);
+        writeGatherFile(gatherDir + "/duts.uint64", duts.data(), nDuts * sizeof(uint64_t));
+        {
+            std::vector<uint16_t> bins(nDuts);
+            folder.gather<uint16_t>("hardbin.uint16", duts.data(), nDuts, bins.data(), 0);
+            writeGatherFile(gatherDir + "/hardbin.uint16", bins.data(), nDuts * sizeof(uint16_t));
+            folder.gather<uint16_t>("softbin.uint16", duts.data(), nDuts, bins.data(), 0);
+            writeGatherFile(gatherDir + "/softbin.uint16", bins.data(), nDuts * sizeof(uint16_t));
+            std::vector<uint8_t> site(nDuts);
+            folder.gather<uint8_t>("site.uint8", duts.data(), nDuts, site.data(), 0);
+            writeGatherFile(gatherDir + "/site.uint8", site.data(), nDuts * sizeof(uint8_t));
+            std::vector<uint32_t> fileIndex(nDuts);
+            for (size_t ix = 0; ix < nDuts; ++ix)
+                fileIndex[ix] = (uint32_t)(std::upper_bound(firstDut.begin(), firstDut.end(), duts[ix]) - firstDut.begin() - 1);
+            writeGatherFile(gatherDir + "/fileIndex.uint32", fileIndex.data(), nDuts * sizeof(uint32_t));
+
+            // PART_ID: length byte, then the characters (see PART_ID.heap)
+            std::vector<uint64_t> offsets(nDuts);
+            folder.gather<uint64_t>("PART_ID.offsets.uint64", duts.data(), nDuts, offsets.data(), ~(uint64_t)0);
+            stdfooReader::span<uint8_t> heap = folder.column<uint8_t>("PART_ID.heap", true);
+            std::ofstream h = openForWrite(gatherDir + "/PART_ID.txt");
+            for (size_t ix = 0; ix < nDuts; ++ix) {
+                const uint64_t pos = offsets[ix];
+                if ((pos < heap.size()) && (heap[(size_t)pos] < heap.size() - pos))
+                    h.write((const char *)heap.data() + pos + 1, heap[(size_t)pos]);
+                h << "\n";
+            }
+            h.close();
+            if (!h)
+                fail("gather: failed to write PART_ID.txt");
         }
-    });
 
-    readerThread.join();
-    recordParserThread.join();
-    reader.setShutdown(true);  // redundant unless no files
-    backgroundWriteRunning = false;
-    backgroundWriterThread.join();
-    writer.close();
+        // === columns: PTR tests, then MPR pins ===
+        std::vector<string> names;
+        std::ofstream columns = openForWrite(gatherDir + "/columns.txt");
+        {
+            stdfooReader::span<uint32_t> testnums = folder.testnums();
+            std::vector<string> testnames = splitLines(folder.column<char>("testnames.txt", true));
+            testnames.resize(testnums.size());
+            for (size_t ix = 0; ix < testnums.size(); ++ix) {
+                names.push_back(std::to_string(testnums[ix]) + ".float");
+                columns << testnums[ix] << "\t-\t" << testnames[ix] << "\n";
+            }
+            stdfooReader::span<uint32_t> mprTestnums = folder.column<uint32_t>("mprTestnums.uint32", true);
+            stdfooReader::span<uint32_t> mprPins = folder.column<uint32_t>("mprPins.uint32", true);
+            std::vector<string> mprTestnames = splitLines(folder.column<char>("mprTestnames.txt", true));
+            mprTestnames.resize(mprTestnums.size());
+            for (size_t ix = 0; ix < std::min(mprTestnums.size(), mprPins.size()); ++ix)
+                for (uint32_t pin = 0; pin < mprPins[ix]; ++pin) {
+                    names.push_back(std::to_string(mprTestnums[ix]) + "_" + std::to_string(pin) + ".float");
+                    columns << mprTestnums[ix] << "\t" << pin << "\t" << mprTestnames[ix] << "\n";
+                }
+        }
+        columns.close();
+        if (!columns)
+            fail("gather: failed to write columns.txt");
+
+        // === results: batches of columns in parallel, written in order ===
+        stdfooReader::threadPool pool(nThreads);
+        std::ofstream results = openForWrite(gatherDir + "/results.float");
+        std::vector<float> batch;
+        for (size_t ixFirst = 0; ixFirst < names.size(); ixFirst += gatherBatchColumns) {
+            const size_t nColumns = std::min(names.size() - ixFirst, gatherBatchColumns);
+            batch.resize(nColumns * nDuts);
+            std::vector<std::future<void>> done;
+            for (size_t ix = 0; ix < nColumns; ++ix) {
+                float *dest = batch.data() + ix * nDuts;
+                const string &name = names[ixFirst + ix];
+                done.push_back(pool.submit([&folder, &name, &duts, dest] { folder.gather<float>(name, duts.data(), duts.size(), dest, NAN); }));
+            }
+            for (auto it = done.begin(); it != done.end(); ++it)
+                it->get();
+            results.write((const char *)batch.data(), (std::streamsize)(batch.size() * sizeof(float)));
+        }
+        results.close();
+        if (!results)
+            fail("gather: failed to write results.float");
+        cout << "gather: " << nDuts << " of " << nDutsTotal << " DUTs x " << names.size() << " columns" << endl;
+    } catch (const std::exception &e) {
+        cerr << "gather: " << e.what() << endl;
+        fail("");
+    }
     return 0;
 }
+#endif
+
+// ============
+// === main ===
+// ============
+#ifndef STDFOO_NO_MAIN  // e.g. benchmarks that include this file
+int main(int argc, char **argv) {
+    if ((argc > 1) && (string(argv[1]) == "whatif"))
+        return whatifMain(argc - 1, argv + 1);
+    if ((argc > 1) && (string(argv[1]) == "gather"))
+        return gatherMain(argc - 1, argv + 1);
+    options opt;
+    int ixArg = opt.parse(argc, argv);
+    if (argc <= ixArg + 1) {
+        cerr << "usage: " << argv[0] << " [--jobs=N] [--parse-jobs=N] [--inflate-jobs=N] [--inflate=builtin|zlib] [--no-mmap] [--max-open-files=N] [--container] [--tiles=KxM] [--compress] [--lossy=BOUND] [--bitmaps] [--append] [--cache=DIR] [--stats-json=FILE] [--progress[=SECONDS]] outputfolder inputfile.stdf.gz"
+             << endl;
+        cerr << "       " << argv[0] << " whatif [--jobs=N] resultfolder reportfolder limits1.txt [limits2.txt ...]" << endl;
+        cerr << "       " << argv[0] << " gather [--jobs=N] [--duts=FILE] [--softbin=LIST] [--hardbin=LIST] [--site=LIST] [--file=LIST] resultfolder gatherfolder" << endl;
+        fail("");
+    }
+    string dirname(argv[ixArg]);
+    createDirectory(dirname);
+
+    std::vector<string> flist;
+    buildFileList(argc, argv, ixArg + 1, flist);
+
+    const bool isParallel = opt.append || ((opt.nJobs > 1) && (flist.size() > 1)) || !opt.cacheDir.empty();
+    runStats run(opt, flist, isParallel ? opt.nJobs : 1);
+    if (opt.append)
+        appendFiles(dirname, flist, opt, &run);
+    else if (isParallel)
+        convertFilesParallel(dirname, flist, opt, /*isAppend*/ false, &run);
+    else
+        convertFiles(dirname, flist, opt, &run.pipeline(0));
+    if (opt.lossyBound > 0)
+        quantizeResults(dirname, opt.lossyBound, std::max(1u, std::thread::hardware_concurrency()));
+    run.finish();
+    return 0;
+}
+#endif
@@ -1,6 +1,11 @@
-function o = STDFoo(folder)
+function o = STDFoo(folder, backend)
     if (nargin < 1 || !ischar(folder))
-        error('usage: STDFoo(folder) where folder argument (string) points to the output folder from STDFoo.exe e.g. result of STDFoo.exe folder file1.stdf file2.stdf...)');
+        error('usage: STDFoo(folder [, backend]) where folder argument (string) points to the output folder from STDFoo.exe e.g. result of STDFoo.exe folder file1.stdf file2.stdf...)');
+    end
+    if (nargin > 1)
+        % 'm': plain .m code (default), 'oct': native backend STDFooOct.oct if on the path (see STDFooOct.cc). Applies to all open folders
+        assert(any(strcmp(backend, {'m', 'oct'})), 'backend must be ''m'' or ''oct''');
+        hasOct(strcmp(backend, 'oct'));
     end
     
     % handle-based storage
@@ -47,6 +52,53 @@ function o = STDFoo(folder)
         r = db.(key).highLim; 
         if (nargin > 0) r = r(index); end 
     end
+    function loadMpr()
+        % MPR index files are read on first use
+        if (~isfield(db.(key), 'mprTestnums'))
+            db.(key).mprTestnums = readBinary(folder, 'mprTestnums.uint32', 'uint32');
+            db.(key).mprPins = readBinary(folder, 'mprPins.uint32', 'uint32');
+            db.(key).mprTestnames = readString(folder, 'mprTestnames.txt');
+            db.(key).mprUnits = readString(folder, 'mprUnits.txt');
+            db.(key).mprLowLim = readBinary(folder, 'mprLowLim.float', 'single');
+            db.(key).mprHighLim = readBinary(folder, 'mprHighLim.float', 'single');
+        end
+    end
+    function r = tests_getMprTestnums(index) 
+        assert((nargin >= 0) && (nargin <= 1), 'expecting 0 or 1 args');
+        loadMpr();
+        r = db.(key).mprTestnums; 
+        if (nargin > 0) r = r(index); end 
+    end
+    function r = tests_getMprPins(index) 
+        assert((nargin >= 0) && (nargin <= 1), 'expecting 0 or 1 args');
+        loadMpr();
+        r = db.(key).mprPins; 
+        if (nargin > 0) r = r(index); end 
+    end
+    function r = tests_getMprTestnames(index) 
+        assert((nargin >= 0) && (nargin <= 1), 'expecting 0 or 1 args');
+        loadMpr();
+        r = db.(key).mprTestnames; 
+        if (nargin > 0) r = r(index); end 
+    end
+    function r = tests_getMprUnits(index) 
+        assert((nargin >= 0) && (nargin <= 1), 'expecting 0 or 1 args');
+        loadMpr();
+        r = db.(key).mprUnits; 
+        if (nargin > 0) r = r(index); end 
+    end
+    function r = tests_getMprLowLim(index) 
+        assert((nargin >= 0) && (nargin <= 1), 'expecting 0 or 1 args');
+        loadMpr();
+        r = db.(key).mprLowLim; 
+        if (nargin > 0) r = r(index); end 
+    end
+    function r = tests_getMprHighLim(index) 
+        assert((nargin >= 0) && (nargin <= 1), 'expecting 0 or 1 args');
+        loadMpr();
+        r = db.(key).mprHighLim; 
+        if (nargin > 0) r = r(index); end 
+    end
     function r = DUTs_getHardbin(index) 
         assert((nargin >= 0) && (nargin <= 1), 'expecting 0 or 1 args');
         r = db.(key).hardbin; 
@@ -64,33 +116,43 @@ function o = STDFoo(folder)
     end
     function r = DUTs_getPartId(index)
         assert((nargin >= 0) && (nargin <= 1), 'expecting 0 or 1 args');
+        if hasOct()
+            % native: converts only the selected DUTs, no per-DUT cache
+            if (nargin > 0)
+                r = STDFooOct('heap', folder, 'PART_ID', index);
+            else
+                r = STDFooOct('heap', folder, 'PART_ID');
+            end
+            return;
+        end
         if (~isfield(db.(key), 'partId'))
-            db.(key).partId = readString(folder, 'PART_ID.txt');
+            db.(key).partId = readHeap(folder, 'PART_ID');
         end
-
-        % remove final line ('terminator' vs 'separator')
-        nDuts = numel(db.(key).site);
-        if numel(db.(key).partId) == nDuts + 1
-            db.(key).partId(end) = [];
+        if (nargin > 0) 
+            r = heapStrings(db.(key).partId, index); 
+        else
+            r = heapStrings(db.(key).partId); 
         end
-        
-        r = db.(key).partId; 
-        if (nargin > 0) r = r(index); end 
     end
     function r = DUTs_getPartTxt(index) 
         assert((nargin >= 0) && (nargin <= 1), 'expecting 0 or 1 args');
+        if hasOct()
+            % native: converts only the selected DUTs, no per-DUT cache
+            if (nargin > 0)
+                r = STDFooOct('heap', folder, 'PART_TXT', index);
+            else
+                r = STDFooOct('heap', folder, 'PART_TXT');
+            end
+            return;
+        end
         if (~isfield(db.(key), 'partTxt'))
-            db.(key).partTxt = readString(folder, 'PART_TXT.txt');
+            db.(key).partTxt = readHeap(folder, 'PART_TXT');
         end
-
-        % remove final line ('terminator' vs 'separator')
-        nDuts = numel(db.(key).site);
-        if numel(db.(key).partTxt) == nDuts + 1
-            db.(key).partTxt(end) = [];
+        if (nargin > 0) 
+            r = heapStrings(db.(key).partTxt, index); 
+        else
+            r = heapStrings(db.(key).partTxt); 
         end
-
-        r = db.(key).partTxt; 
-        if (nargin > 0) r = r(index); end
     end
     function r = files_getFiles(index) 
         assert((nargin >= 0) && (nargin <= 1), 'expecting 0 or 1 args');
@@ -104,6 +166,9 @@ function o = STDFoo(folder)
     end
 
     db.(key) = struct(); % clean out existing data
+    if hasOct()
+        STDFooOct('close', folder); % the folder may have been converted again
+    end
     db.(key).folder = folder;
     db.(key).data = struct();
     db.(key).testnums = readBinary(folder, 'testnums.uint32', 'uint32');
@@ -119,12 +184,23 @@ function o = STDFoo(folder)
 
     o.DUTs.getResultByTestnum=@(varargin)DUTs_getResultByTestnum(db, o, varargin{:}); % boilerplate wrapper prepending db, o args
     o.DUTs.uncacheResultByTestnum=@(varargin)DUTs_uncacheResultByTestnum(db, o, varargin{:}); % boilerplate wrapper prepending db, o args
+    o.DUTs.getResultsByDut=@(varargin)DUTs_getResultsByDut(db, o, varargin{:}); % boilerplate wrapper prepending db, o args
+    o.DUTs.getMprResult=@(varargin)DUTs_getMprResult(db, o, varargin{:}); % boilerplate wrapper prepending db, o args
+    o.DUTs.getFailed=@(varargin)DUTs_getBitmap(db, o, 'fail', varargin{:}); % boilerplate wrapper prepending db, o args
+    o.DUTs.getTested=@(varargin)DUTs_getBitmap(db, o, 'tested', varargin{:}); % boilerplate wrapper prepending db, o args
     o.tests.getTestnums=@tests_getTestnums;
     o.tests.getTestname=@tests_getTestname;
     o.tests.getTestnames=@tests_getTestnames;
     o.tests.getUnits=@tests_getUnits;
     o.tests.getLowLim=@tests_getLowLim;
     o.tests.getHighLim=@tests_getHighLim;
+    o.tests.getMprTestnums=@tests_getMprTestnums;
+    o.tests.getMprPins=@tests_getMprPins;
+    o.tests.getMprTestnames=@tests_getMprTestnames;
+    o.tests.getMprUnits=@tests_getMprUnits;
+    o.tests.getMprLowLim=@tests_getMprLowLim;
+    o.tests.getMprHighLim=@tests_getMprHighLim;
+    o.tests.getStats=@(varargin)tests_getStats(db, o, varargin{:}); % boilerplate wrapper prepending db, o args
     o.DUTs.getHardbin=@DUTs_getHardbin;
     o.DUTs.getSoftbin=@DUTs_getSoftbin;
     o.DUTs.getSite=@DUTs_getSite;
@@ -136,6 +212,7 @@ function o = STDFoo(folder)
     o.files.getFiles=@files_getFiles;
     o.files.getDutsPerFile=@files_getDutsPerFile;
     o.files.getMaskByFileindex = @(varargin)files_getMaskByFileindex(db, o, varargin{:}); % boilerplate wrapper prepending db, o args
+    o.files.getDutsByFileindex = @(varargin)files_getDutsByFileindex(db, o, varargin{:}); % boilerplate wrapper prepending db, o args
 end
 
 function r = getnDUTs(db, o) %db, o for object
@@ -144,21 +221,41 @@ function r = getnDUTs(db, o) %db, o for object
     r = numel(db.(key).site); 
 end
 
-% note: mask needs 1 bit / DUT
+% note: mask needs 1 bit / DUT. getDutsByFileindex selects the same DUTs without a per-DUT array
 function r = files_getMaskByFileindex(db, o, fileindex) %db, o for object
     assert(nargin == 2 + 1, 'need one input argument fileindex');
     assert(numel(fileindex)==1, 'fileindex must be scalar');
-    key = o.key;
-    lastIndexInFile = cumsum(db.(key).dutsPerFile);
-    firstIndexInFile = [1; lastIndexInFile(1:end-1)+1];
     r = false(getnDUTs(db, o), 1);
-    r(firstIndexInFile(fileindex):lastIndexInFile(fileindex)) = true;
+    r(files_getDutsByFileindex(db, o, fileindex)) = true;
+end
+
+% DUT indices (base 1) of the given file as range first:last, e.g. as index for getResultByTestnum. The DUTs of a file are one run
+function r = files_getDutsByFileindex(db, o, fileindex) %db, o for object
+    assert(nargin == 2 + 1, 'need one input argument fileindex');
+    assert(numel(fileindex)==1, 'fileindex must be scalar');
+    key = o.key;
+    if hasOct()
+        runs = STDFooOct('fileRuns', db.(key).folder); % [first, count] per file
+    else
+        nDuts = double(db.(key).dutsPerFile);
+        runs = [cumsum(nDuts) - nDuts + 1, nDuts];
+    end
+    r = runs(fileindex, 1) : runs(fileindex, 1) + runs(fileindex, 2) - 1;
 end
 
 % note: getMaskByFileindex is usually much more efficient (1 bit logical indexing vs 64-bit double)
 function r = DUTs_getFileindex(db, o, index) %db, o for object
     assert((nargin >= 2) && (nargin <= 3), 'expecting 0 or 1 args');
     key = o.key;
+    if hasOct()
+        % native: only the selected DUTs, without a table for all DUTs
+        if (nargin > 2)
+            r = STDFooOct('fileIndex', db.(key).folder, index);
+        else
+            r = STDFooOct('fileIndex', db.(key).folder);
+        end
+        return;
+    end
     lastIndexInFile = cumsum(db.(key).dutsPerFile);
     firstIndexInFile = [1; lastIndexInFile(1:end-1)+1];
     r = zeros(getnDUTs(db, o), 1);
@@ -171,6 +268,10 @@ end
 function r = DUTs_getIndexInFile(db, o) %db, o for object
     assert(nargin == 2, 'expecting 0 args');
     key = o.key;
+    if hasOct()
+        r = STDFooOct('indexInFile', db.(key).folder);
+        return;
+    end
     lastIndexInFile = cumsum(db.(key).dutsPerFile);
     firstIndexInFile = [1; lastIndexInFile(1:end-1)+1];
     nDutsInFile = lastIndexInFile - firstIndexInFile + 1;
@@ -180,25 +281,157 @@ function r = DUTs_getIndexInFile(db, o) %db, o for object
     end
 end
 
-function data = DUTs_getResultByTestnum(db, o, testnum) %db, o for object
-    assert(nargin == 2+1, 'need exactly one argument (testnum), which may be vector or scalar');
+% optional index (logical mask or DUT index, base 1): rows to return. With STDFooOct.oct, a column that is not cached yet is then converted for
+% those rows only and not added to the cache. STDFooOct keeps the file memory-mapped until the folder is opened again (STDFoo(folder)) or
+% clear STDFooOct
+function data = DUTs_getResultByTestnum(db, o, testnum, index) %db, o for object
+    assert((nargin == 2+1) || (nargin == 2+2), 'need argument testnum, which may be vector or scalar, and optionally index');
     key = o.key;
     if numel(testnum) > 1
         % multiple testnums: return one column per testnum. 
         % preallocate data
-        data = nan(getnDUTs(db, o), numel(testnum));
-        for ix = 1 : numel(testnum)
-            data(:, ix) = DUTs_getResultByTestnum(db, o, testnum(ix));
+        if (nargin < 2+2)
+            data = nan(getnDUTs(db, o), numel(testnum));
+            for ix = 1 : numel(testnum)
+                data(:, ix) = DUTs_getResultByTestnum(db, o, testnum(ix));
+            end
+        else
+            if islogical(index) nRows = nnz(index); else nRows = numel(index); end
+            data = nan(nRows, numel(testnum));
+            for ix = 1 : numel(testnum)
+                data(:, ix) = DUTs_getResultByTestnum(db, o, testnum(ix), index);
+            end
         end
     else
         % single testnum
         datakey = sprintf('d%i', testnum);
+        if (nargin == 2+2) && ~isfield(db.(key).data, datakey) && hasOct()
+            data = STDFooOct('column', db.(key).folder, sprintf('%i.float', testnum), 'float', index);
+            return;
+        end
         if ~isfield(db.(key).data, datakey)
             folder = db.(key).folder;
             db.(key).data.(datakey) = readBinary(folder, sprintf('%i.float', testnum), 'float');
         end
         data = db.(key).data.(datakey);
+        if (nargin == 2+2) data = data(index); data = data(:); end
+    end
+end
+
+% MPR results of testnum (scalar), one column per pin (position in RTN_RSLT, base 0, default: all pins)
+function data = DUTs_getMprResult(db, o, testnum, pin) %db, o for object
+    assert((nargin == 2+1) || (nargin == 2+2), 'need arguments testnum (scalar) and optionally pin (base 0), which may be vector or scalar');
+    assert(numel(testnum) == 1, 'need scalar testnum');
+    key = o.key;
+    folder = db.(key).folder;
+    if (nargin < 2+2)
+        mprTestnums = readBinary(folder, 'mprTestnums.uint32', 'uint32');
+        mprPins = readBinary(folder, 'mprPins.uint32', 'uint32');
+        assert(sum(mprTestnums == testnum) == 1, 'MPR test with testnum not found');
+        pin = 0 : mprPins(mprTestnums == testnum) - 1;
+    end
+    data = nan(getnDUTs(db, o), numel(pin));
+    for ix = 1 : numel(pin)
+        datakey = sprintf('d%i_%i', testnum, pin(ix));
+        if ~isfield(db.(key).data, datakey)
+            db.(key).data.(datakey) = readBinary(folder, sprintf('%i_%i.float', testnum, pin(ix)), 'float');
+        end
+        r = db.(key).data.(datakey);
+        data(1:numel(r), ix) = r;
+    end
+end
+
+% pass / fail bitmap (kind 'fail' or 'tested') of PTR testnum from TEST_FLG, as logical column. Needs STDFoo.exe --bitmaps
+function data = DUTs_getBitmap(db, o, kind, testnum) %db, o for object
+    assert(nargin == 3+1, 'need exactly one argument (testnum), which may be vector or scalar');
+    key = o.key;
+    folder = db.(key).folder;
+    nDuts = getnDUTs(db, o);
+    data = false(nDuts, numel(testnum));
+    for ix = 1 : numel(testnum)
+        if hasOct()
+            data(:, ix) = STDFooOct('bits', folder, sprintf('%i.%s.bits', testnum(ix), kind));
+            continue;
+        end
+        bytes = readBinary(folder, sprintf('%i.%s.bits', testnum(ix), kind), 'uint8');
+        % DUT k is bit mod(k-1, 8) (LSB first) of byte floor((k-1) / 8)
+        bits = logical(bitget(repmat(bytes(:).', 8, 1), repmat((1:8).', 1, numel(bytes))));
+        bits = bits(:);
+        if ~isempty(bits)
+            data(:, ix) = bits(1:nDuts);
+        end
+    end
+end
+
+% all results of the given DUTs (one row per DUT, one column per test in order of getTestnums). Needs STDFoo.exe --tiles=KxM
+function data = DUTs_getResultsByDut(db, o, dutIndex) %db, o for object
+    assert(nargin == 2+1, 'need exactly one argument (DUT index, base 1), which may be vector or scalar');
+    key = o.key;
+    folder = db.(key).folder;
+    dims = readBinary(folder, 'tileDims.uint32', 'uint32');
+    K = dims(1);
+    M = dims(2);
+    testnumBySlot = readBinary(folder, 'tileTestOrder.uint32', 'uint32');
+    firstTile = readBinary(folder, 'tiles.index.uint64', 'uint64');
+    [~, colBySlot] = ismember(testnumBySlot, db.(key).testnums);
+    
+    [fname, offset, nBytes] = locateFile(folder, 'tiles.float');
+    if isinf(nBytes)
+        d = dir(fname);
+        nBytes = d.bytes;
     end
+    nTiles = nBytes / (4 * K * M);
+    firstTile(end+1) = nTiles; % end of last block
+    
+    h = fopen(fname, 'rb');
+    data = nan(numel(dutIndex), numel(db.(key).testnums));
+    for ix = 1 : numel(dutIndex)
+        ixBlock = floor((dutIndex(ix) - 1) / K);
+        ixRow = mod(dutIndex(ix) - 1, K);
+        for ixTile = 0 : firstTile(ixBlock + 2) - firstTile(ixBlock + 1) - 1
+            % row of M results within the tile
+            fseek(h, offset + 4 * ((firstTile(ixBlock + 1) + ixTile) * K * M + ixRow * M), 'bof');
+            row = fread(h, M, 'single');
+            slots = ixTile * M + (1 : M);
+            valid = slots <= numel(colBySlot);
+            valid(valid) = colBySlot(slots(valid)) > 0; % MPR results are not in getTestnums()
+            data(ix, colBySlot(slots(valid))) = row(valid);
+        end
+    end
+    fclose(h);
+end
+
+% per-test statistics collected during conversion (PTR tests in order of getTestnums, see README "Statistics"). Fields count, nan, mean, sigma,
+% m2, min, max, cpk (column vectors), hist (one row per test). Field site / file: the same, one column per site (field sites) / input file
+function r = tests_getStats(db, o) %db, o for object
+    assert(nargin == 2, 'expecting 0 args');
+    key = o.key;
+    if ~isfield(db.(key), 'stats')
+        folder = db.(key).folder;
+        nTests = numel(db.(key).testnums);
+        r = readStatsLevel(folder, 'stats.', nTests, 1);
+        r.sites = readBinary(folder, 'stats.sites.uint8', 'uint8');
+        r.siteDuts = readBinary(folder, 'stats.siteDuts.uint64', 'uint64');
+        r.site = readStatsLevel(folder, 'stats.site.', nTests, numel(r.sites));
+        r.file = readStatsLevel(folder, 'stats.file.', nTests, numel(db.(key).files));
+        db.(key).stats = r;
+    end
+    r = db.(key).stats;
+end
+
+% one level of stats.* files. Files are test-major (all groups of the first test, then the next test)
+function r = readStatsLevel(folder, prefix, nTests, nGroups)
+    names = {'count', 'nan', 'mean', 'sigma', 'm2', 'min', 'max', 'cpk'};
+    types = {'uint64', 'uint64', 'double', 'double', 'double', 'single', 'single', 'double'};
+    exts = {'uint64', 'uint64', 'double', 'double', 'double', 'float', 'float', 'double'};
+    r = struct();
+    for ix = 1 : numel(names)
+        data = readBinary(folder, [prefix, names{ix}, '.', exts{ix}], types{ix});
+        r.(names{ix}) = reshape(data, nGroups, nTests).';
+    end
+    hist = readBinary(folder, [prefix, 'hist.uint32'], 'uint32');
+    nBins = numel(hist) / (nTests * nGroups);
+    r.hist = permute(reshape(hist, nBins, nGroups, nTests), [3, 1, 2]); % test x bin x group
 end
 
 function data = DUTs_uncacheResultByTestnum(db, o, testnum) %db, o for object
@@ -220,26 +453,285 @@ function data = DUTs_uncacheResultByTestnum(db, o, testnum) %db, o for object
 end
 
 % reads binary file into numerical vector 
-function data = readBinary(folder, fname, bintype)
-    fname = [folder, '/', fname];
+function data = readBinary(folder, name, bintype)
+    if hasOct()
+        data = STDFooOct('column', folder, name, bintype);
+        return;
+    end
+    [fname, offset, nBytes] = locateFile(folder, name);
+    if isinf(nBytes) && ~exist(fname, 'file')
+        if exist([fname, '.blk'], 'file')
+            data = readBlk([fname, '.blk'], bintype); % STDFoo.exe --compress
+            return;
+        end
+        [encoding, qOffset, qScale] = lossyEncoding(folder, name);
+        if ~isempty(encoding)
+            data = readLossy(folder, name, encoding, qOffset, qScale); % STDFoo.exe --lossy=BOUND
+            return;
+        end
+    end
     h = fopen(fname, 'rb');
     if (h < 0)
         error('failed to open "%s" with type "%s"', fname, bintype);
     end
-    data = fread(h, bintype);
+    fseek(h, offset, 'bof');
+    if isinf(nBytes)
+        data = fread(h, bintype);
+    else
+        data = fread(h, nBytes / elementSize(bintype), bintype);
+    end
     fclose(h);
 end
     
+% decodes a block-encoded column (STDFoo.exe --compress, format see STDFooCodec.hpp) into numerical vector
+function data = readBlk(fname, bintype)
+    h = fopen(fname, 'rb');
+    if (h < 0)
+        error('failed to open "%s"', fname);
+    end
+    raw = fread(h, Inf, 'uint8=>uint8');
+    fclose(h);
+    assert((numel(raw) >= 16 + 24) && strcmp(char(raw(1:8)).', 'STDFooBk') && (raw(9) == 1), 'not a block-encoded column: "%s"', fname);
+    elemSize = double(raw(10));
+    assert(elemSize == elementSize(bintype), 'unexpected element size in "%s"', fname);
+    wordtype = sprintf('uint%i', 8 * elemSize);
+    trailer = raw(end - 23 : end);
+    assert(strcmp(char(trailer(17:24)).', 'STDFooBi'), 'corrupt block-encoded column: "%s"', fname);
+    nBlocks = double(typecast(trailer(1:8), 'uint64'));
+    nValues = double(typecast(trailer(9:16), 'uint64'));
+    indexPos = numel(raw) - 24 - 8 * nBlocks; % base 0
+    offsets = [double(typecast(raw(indexPos + 1 : indexPos + 8 * nBlocks), 'uint64')); indexPos];
+    bitweights = 2 .^ (0:7).';
+    
+    data = zeros(nValues, 1, wordtype);
+    ixOut = 0;
+    for ixBlock = 1 : nBlocks
+        b = raw(offsets(ixBlock) + 1 : offsets(ixBlock + 1));
+        n = double(b(1)) + 256 * double(b(2));
+        flags = double(b(4));
+        p = b(5:end);
+        switch b(3)
+            case 0 % raw
+                v = typecast(p(1 : n * elemSize), wordtype);
+            case 1 % one value, repeated
+                v = repmat(typecast(p(1 : elemSize), wordtype), n, 1);
+            case 2 % floats: optional presence bitmap, XOR with previous value in byte planes
+                present = true(n, 1);
+                if bitand(flags, 1)
+                    nMaskBytes = ceil(n / 8);
+                    bits = bitand(repmat(double(p(1 : nMaskBytes)).', 8, 1), repmat(bitweights, 1, nMaskBytes)) > 0;
+                    present = bits(1 : n).';
+                    p = p(nMaskBytes + 1 : end);
+                end
+                nPresent = sum(present);
+                x = zeros(nPresent, 1, 'uint32');
+                for k = 0 : 3
+                    if bitand(flags, bitshift(16, k))
+                        x = bitor(x, bitshift(uint32(p(1 : nPresent)), 8 * k));
+                        p = p(nPresent + 1 : end);
+                    end
+                end
+                % undo the XOR chain (prefix XOR in log2(n) steps)
+                step = 1;
+                while step < nPresent
+                    x(step + 1 : end) = bitxor(x(step + 1 : end), x(1 : end - step));
+                    step = step * 2;
+                end
+                v = repmat(uint32(hex2dec('7FC00000')), n, 1); % missing result: NaN
+                v(present) = x;
+            case 3 % runs of value, uint16 length
+                nRuns = double(p(1)) + 256 * double(p(2));
+                r = reshape(p(3 : 2 + nRuns * (elemSize + 2)), elemSize + 2, nRuns);
+                vals = typecast(reshape(r(1 : elemSize, :), [], 1), wordtype);
+                lens = double(r(elemSize + 1, :)) + 256 * double(r(elemSize + 2, :));
+                ixRun = zeros(n, 1);
+                ixRun(cumsum([1, lens(1 : end - 1)])) = 1;
+                v = vals(cumsum(ixRun));
+            case 4 % base value, bit-packed offsets
+                base = typecast(p(1 : elemSize), wordtype);
+                nBits = double(p(elemSize + 1));
+                nPackedBytes = ceil(n * nBits / 8);
+                bits = bitand(repmat(double(p(elemSize + 2 : elemSize + 1 + nPackedBytes)).', 8, 1), repmat(bitweights, 1, nPackedBytes)) > 0;
+                bits = reshape(bits(1 : n * nBits), nBits, n);
+                v = base + cast(((2 .^ (0 : nBits - 1)) * bits).', wordtype);
+            otherwise
+                error('unknown block mode %i in "%s"', b(3), fname);
+        end
+        assert(numel(v) == n, 'corrupt block in "%s"', fname);
+        data(ixOut + 1 : ixOut + n) = v;
+        ixOut = ixOut + n;
+    end
+    assert(ixOut == nValues, 'corrupt block-encoded column: "%s"', fname);
+    if raw(11)
+        data = typecast(data, 'single');
+    end
+    data = double(data); % as fread()
+end
+    
+% encoding of result column "name" from lossy.txt (STDFoo.exe --lossy=BOUND). Empty: not converted
+function [encoding, qOffset, qScale] = lossyEncoding(folder, name)
+    persistent tables = struct('fname', {}, 'datenum', {}, 'map', {});
+    encoding = '';
+    qOffset = 0;
+    qScale = 1;
+    lname = [folder, '/lossy.txt'];
+    d = dir(lname);
+    if isempty(d)
+        return;
+    end
+    
+    % === read table (once per version) ===
+    ix = find(strcmp({tables.fname}, lname));
+    if isempty(ix) || (tables(ix).datenum ~= d.datenum)
+        h = fopen(lname, 'rb');
+        tmp = fread(h, [1, Inf], 'char=>char');
+        fclose(h);
+        c = textscan(tmp, '%s %s %f %f', 'delimiter', char(9));
+        map = containers.Map();
+        for ixLine = 1 : numel(c{1})
+            map(c{1}{ixLine}) = {c{2}{ixLine}, c{3}(ixLine), c{4}(ixLine)};
+        end
+        if isempty(ix)
+            ix = numel(tables) + 1;
+        end
+        tables(ix).fname = lname;
+        tables(ix).datenum = d.datenum;
+        tables(ix).map = map;
+    end
+    
+    if isKey(tables(ix).map, name)
+        entry = tables(ix).map(name);
+        [encoding, qOffset, qScale] = entry{:};
+    end
+end
+
+% decodes 16-bit result column "name" (e.g. 1000.float stored as 1000.uint16 or 1000.half)
+function data = readLossy(folder, name, encoding, qOffset, qScale)
+    stem = name(1 : end - numel('.float'));
+    switch encoding
+        case 'uint16'
+            q = readBinary(folder, [stem, '.uint16'], 'uint16');
+            data = qOffset + qScale * q;
+            data(q == 65535) = NaN;
+        case 'half'
+            h = readBinary(folder, [stem, '.half'], 'uint16');
+            s = 1 - 2 * (h >= 32768);
+            e = mod(floor(h / 1024), 32);
+            m = mod(h, 1024);
+            data = s .* (m / 1024 + (e > 0)) .* 2 .^ (max(e, 1) - 15); % e == 0: subnormal
+            isInf = (e == 31) & (m == 0);
+            data(isInf) = s(isInf) * Inf;
+            data((e == 31) & (m > 0)) = NaN;
+        otherwise
+            error('unsupported encoding "%s" of "%s"', encoding, name);
+    end
+end
+
 % reads newline-separated file into cell array of strings
 function celldata = readString(folder, fname)
-    fname = [folder, '/', fname];
+    if hasOct()
+        celldata = STDFooOct('strings', folder, fname);
+        return;
+    end
+    [fname, offset, nBytes] = locateFile(folder, fname);
     h = fopen(fname, 'rb');
     if (h < 0)
         error('failed to open "%s"', fname);
     end
-    tmp = fread(h, [1, Inf], 'char=>char');
+    fseek(h, offset, 'bof');
+    tmp = fread(h, [1, nBytes], 'char=>char');
     fclose(h);
     celldata = strsplit(tmp, char(10), 'collapsedelimiters', false).';
     assert(isempty(celldata{end}), 'expecting newline termination after last line');
     celldata(end) = [];
 end
+
+% reads (name).heap and (name).offsets.uint64 (per-DUT strings e.g. PART_ID)
+function h = readHeap(folder, name)
+    h = struct();
+    h.heap = readBinary(folder, [name, '.heap'], 'uint8');
+    h.offsets = readBinary(folder, [name, '.offsets.uint64'], 'uint64');
+end
+
+% cell array of strings for the given DUTs (default: all). Each entry is a length byte followed by the characters, repeated values share one entry
+function celldata = heapStrings(h, index)
+    offsets = h.offsets;
+    if (nargin > 1) offsets = offsets(index); end
+    [entries, ~, ixEntry] = unique(offsets(:));
+    strs = cell(numel(entries), 1);
+    for ix = 1 : numel(entries)
+        pos = entries(ix) + 1; % base 1
+        strs{ix} = char(h.heap(pos + 1 : pos + h.heap(pos))).';
+    end
+    celldata = strs(ixEntry);
+end
+
+% whether reads go through STDFooOct.oct (native backend, see STDFooOct.cc): selected by STDFoo(folder, 'oct') and the oct-file is on the path.
+% Otherwise all reads use the .m code below. Off by default: exampleAndSelftest compares both
+function r = hasOct(enable)
+    persistent isEnabled = false;
+    if (nargin > 0)
+        isEnabled = enable && (exist('STDFooOct') == 3);
+    end
+    r = isEnabled;
+end
+
+% returns where to read result "name" from: the file itself (offset 0, size Inf) or its region in container.stdfoo (STDFoo.exe --container)
+function [fname, offset, nBytes] = locateFile(folder, name)
+    persistent manifests = struct('fname', {}, 'datenum', {}, 'map', {});
+    cname = [folder, '/container.stdfoo'];
+    d = dir(cname);
+    if isempty(d)
+        fname = [folder, '/', name];
+        offset = 0;
+        nBytes = Inf;
+        return;
+    end
+    
+    % === read manifest (once per container version) ===
+    ix = find(strcmp({manifests.fname}, cname));
+    if isempty(ix) || (manifests(ix).datenum ~= d.datenum)
+        h = fopen(cname, 'rb');
+        magic = fread(h, [1, 8], 'char=>char');
+        assert(strcmp(magic, 'STDFooCt'), 'not a STDFoo container: "%s"', cname);
+        version = fread(h, 1, 'uint32');
+        assert(version == 1, 'unsupported container version %i', version);
+        fread(h, 1, 'uint32'); % alignment
+        manifestOffset = fread(h, 1, 'uint64');
+        manifestSize = fread(h, 1, 'uint64');
+        fseek(h, manifestOffset, 'bof');
+        tmp = fread(h, [1, manifestSize], 'char=>char');
+        fclose(h);
+        c = textscan(tmp, '%s %f %f', 'delimiter', char(9));
+        map = containers.Map(c{1}, num2cell([c{2}, c{3}], 2));
+        if isempty(ix)
+            ix = numel(manifests) + 1;
+        end
+        manifests(ix).fname = cname;
+        manifests(ix).datenum = d.datenum;
+        manifests(ix).map = map;
+    end
+    
+    if ~isKey(manifests(ix).map, name)
+        error('"%s" not found in "%s"', name, cname);
+    end
+    entry = manifests(ix).map(name);
+    fname = cname;
+    offset = entry(1);
+    nBytes = entry(2);
+end
+
+function r = elementSize(bintype)
+    switch bintype
+        case 'uint8'
+            r = 1;
+        case 'uint16'
+            r = 2;
+        case {'uint32', 'single', 'float'}
+            r = 4;
+        case {'uint64', 'double'}
+            r = 8;
+        otherwise
+            error('unsupported type "%s"', bintype);
+    end
+end
@@ -0,0 +1,526 @@
+// Block-encoded columns for STDFoo (STDFoo.exe --compress). No library dependencies.
+// A column (e.g. 1000.float.blk, hardbin.uint16.blk) is a sequence of independently decodable blocks of up to blockLen values, with an index of
+// block offsets at the end of the file for random access:
+// - header (16 bytes): "STDFooBk", uint8 version (1), uint8 element size (1, 2, 4, 8), uint8 isFloat, uint8 reserved, uint32 blockLen
+// - blocks: uint16 number of values n, uint8 mode, uint8 flags, then the payload (see mode_e)
+// - index: uint64 file offset of each block, then uint64 number of blocks, uint64 number of values, "STDFooBi"
+// All numbers are little endian.
+#ifndef STDFOO_CODEC_HPP
+#define STDFOO_CODEC_HPP
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstring>  // memcpy
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace stdfooCodec {
+
+//* values per block
+static const uint32_t blockLen = 1024;
+static const unsigned int headerSize = 16;
+static const unsigned int trailerSize = 24;
+
+enum mode_e {
+    //* n values as is
+    MODE_RAW = 0,
+    //* one value, repeated n times (e.g. NaN padding of a test that does not exist in one input file)
+    MODE_CONST = 1,
+    /** floats: XOR of each value with the previous one, split into 4 byte planes (least significant first). Slowly varying results leave the
+     * upper planes zero, which are not stored (flags bit 4 + k: plane k is stored). Flags bit 0: the payload starts with a presence bitmap
+     * (bit i set: value i is present, otherwise the canonical NaN 0x7FC00000). The XOR chain and planes cover only the present values */
+    MODE_XOR = 2,
+    //* integers: uint16 number of runs, then value, uint16 run length per run
+    MODE_RLE = 3,
+    //* integers: base value, uint8 bits per value, then (value - base) bit-packed, least significant bit first
+    MODE_BITPACK = 4
+};
+
+//* missing result (NaN as written by STDFoo)
+static const uint32_t canonicalNan = 0x7FC00000;
+
+// ====================
+// === blockEncoder ===
+// ====================
+//* encodes a column of T (float or unsigned integer) as it is written, block by block
+template <class T>
+class blockEncoder {
+   public:
+    blockEncoder() : pending(), offsets(), pos(0), nValues(0), isStarted(false) {
+    }
+
+    //* appends the encoding of all completed blocks to out (the first call also writes the header)
+    void add(const T *vals, size_t n, std::vector<unsigned char> &out) {
+        this->start(out);
+        // === complete the pending block ===
+        if (!this->pending.empty()) {
+            size_t nCopy = std::min(n, (size_t)blockLen - this->pending.size());
+            this->pending.insert(this->pending.end(), vals, vals + nCopy);
+            vals += nCopy;
+            n -= nCopy;
+            if (this->pending.size() < blockLen)
+                return;
+            this->encodeBlock(this->pending.data(), blockLen, out);
+            this->pending.clear();
+        }
+        // === full blocks straight from the input ===
+        while (n >= blockLen) {
+            this->encodeBlock(vals, blockLen, out);
+            vals += blockLen;
+            n -= blockLen;
+        }
+        this->pending.assign(vals, vals + n);
+    }
+
+    //* appends the remaining values, the index and trailer to out. The column is complete
+    void finish(std::vector<unsigned char> &out) {
+        this->start(out);
+        if (!this->pending.empty())
+            this->encodeBlock(this->pending.data(), this->pending.size(), out);
+        this->pending.clear();
+        for (size_t ix = 0; ix < this->offsets.size(); ++ix)
+            put<uint64_t>(out, this->offsets[ix]);
+        put<uint64_t>(out, this->offsets.size());
+        put<uint64_t>(out, this->nValues);
+        out.insert(out.end(), "STDFooBi", "STDFooBi" + 8);
+    }
+
+   protected:
+    template <class U>
+    static void put(std::vector<unsigned char> &out, U val) {
+        const unsigned char *p = (const unsigned char *)&val;
+        out.insert(out.end(), p, p + sizeof(U));
+    }
+
+    void start(std::vector<unsigned char> &out) {
+        if (this->isStarted)
+            return;
+        size_t n0 = out.size();
+        out.insert(out.end(), "STDFooBk", "STDFooBk" + 8);
+        out.push_back(1);  // version
+        out.push_back((unsigned char)sizeof(T));
+        out.push_back(std::is_floating_point<T>::value ? 1 : 0);
+        out.push_back(0);
+        put<uint32_t>(out, blockLen);
+        this->pos += out.size() - n0;
+        this->isStarted = true;
+    }
+
+    void encodeBlock(const T *vals, size_t n, std::vector<unsigned char> &out) {
+        size_t n0 = out.size();
+        this->offsets.push_back(this->pos);
+        encode(vals, n, out);
+        this->pos += out.size() - n0;
+        this->nValues += n;
+    }
+
+    static void blockHeader(std::vector<unsigned char> &out, size_t n, mode_e mode, uint8_t flags) {
+        put<uint16_t>(out, (uint16_t)n);
+        out.push_back((unsigned char)mode);
+        out.push_back(flags);
+    }
+
+    //* picks the smallest of the applicable modes
+    static void encode(const float *vals, size_t n, std::vector<unsigned char> &out) {
+        uint32_t w[blockLen];
+        memcpy(w, vals, n * sizeof(float));
+        bool isConst = true;
+        size_t nPresent = 0;
+        uint32_t prev = 0;
+        uint32_t orAll = 0;
+        uint32_t x[blockLen];
+        for (size_t ix = 0; ix < n; ++ix) {
+            isConst &= w[ix] == w[0];
+            if (w[ix] == canonicalNan)
+                continue;
+            x[nPresent++] = w[ix] ^ prev;
+            orAll |= w[ix] ^ prev;
+            prev = w[ix];
+        }
+        if (isConst) {
+            blockHeader(out, n, MODE_CONST, 0);
+            put<uint32_t>(out, w[0]);
+            return;
+        }
+
+        bool hasMask = nPresent < n;
+        unsigned int nPlanes = 0;
+        uint8_t flags = hasMask ? 1 : 0;
+        for (unsigned int k = 0; k < 4; ++k)
+            if ((orAll >> (8 * k)) & 0xFF) {
+                flags |= (uint8_t)(0x10 << k);
+                ++nPlanes;
+            }
+        size_t nBytesXor = (hasMask ? (n + 7) / 8 : 0) + nPlanes * nPresent;
+        if (nBytesXor >= n * sizeof(float)) {
+            blockHeader(out, n, MODE_RAW, 0);
+            out.insert(out.end(), (const unsigned char *)vals, (const unsigned char *)(vals + n));
+            return;
+        }
+
+        blockHeader(out, n, MODE_XOR, flags);
+        if (hasMask) {
+            size_t ixMask = out.size();
+            out.resize(ixMask + (n + 7) / 8, 0);
+            for (size_t ix = 0; ix < n; ++ix)
+                if (w[ix] != canonicalNan)
+                    out[ixMask + ix / 8] |= (unsigned char)(1 << (ix % 8));
+        }
+        for (unsigned int k = 0; k < 4; ++k) {
+            if (!(flags & (0x10 << k)))
+                continue;
+            size_t ixPlane = out.size();
+            out.resize(ixPlane + nPresent);
+            for (size_t ix = 0; ix < nPresent; ++ix)
+                out[ixPlane + ix] = (unsigned char)(x[ix] >> (8 * k));
+        }
+    }
+
+    template <class U>
+    static void encode(const U *vals, size_t n, std::vector<unsigned char> &out) {
+        static_assert(std::is_unsigned<U>::value, "blockEncoder: float or unsigned integer columns");
+        U lo = vals[0];
+        U hi = vals[0];
+        size_t nRuns = 1;
+        for (size_t ix = 1; ix < n; ++ix) {
+            lo = std::min(lo, vals[ix]);
+            hi = std::max(hi, vals[ix]);
+            nRuns += (vals[ix] != vals[ix - 1]) ? 1 : 0;
+        }
+        if (lo == hi) {
+            blockHeader(out, n, MODE_CONST, 0);
+            put<U>(out, lo);
+            return;
+        }
+        unsigned int nBits = 0;
+        while ((nBits < 8 * sizeof(U)) && ((uint64_t)(hi - lo) >> nBits))
+            ++nBits;
+        size_t nBytesRaw = n * sizeof(U);
+        size_t nBytesRle = 2 + nRuns * (sizeof(U) + 2);
+        size_t nBytesPacked = (nBits <= 32) ? sizeof(U) + 1 + (n * nBits + 7) / 8 : nBytesRaw;
+
+        if ((nBytesRle < nBytesPacked) && (nBytesRle < nBytesRaw)) {
+            blockHeader(out, n, MODE_RLE, 0);
+            put<uint16_t>(out, (uint16_t)nRuns);
+            size_t ixStart = 0;
+            for (size_t ix = 1; ix <= n; ++ix) {
+                if ((ix < n) && (vals[ix] == vals[ixStart]))
+                    continue;
+                put<U>(out, vals[ixStart]);
+                put<uint16_t>(out, (uint16_t)(ix - ixStart));
+                ixStart = ix;
+            }
+        } else if (nBytesPacked < nBytesRaw) {
+            blockHeader(out, n, MODE_BITPACK, 0);
+            put<U>(out, lo);
+            out.push_back((unsigned char)nBits);
+            uint64_t acc = 0;
+            unsigned int nAcc = 0;
+            for (size_t ix = 0; ix < n; ++ix) {
+                acc |= (uint64_t)(vals[ix] - lo) << nAcc;
+                nAcc += nBits;
+                while (nAcc >= 8) {
+                    out.push_back((unsigned char)acc);
+                    acc >>= 8;
+                    nAcc -= 8;
+                }
+            }
+            if (nAcc > 0)
+                out.push_back((unsigned char)acc);
+        } else {
+            blockHeader(out, n, MODE_RAW, 0);
+            out.insert(out.end(), (const unsigned char *)vals, (const unsigned char *)(vals + n));
+        }
+    }
+
+    //* values of the incomplete last block
+    std::vector<T> pending;
+    //* file offset of each block
+    std::vector<uint64_t> offsets;
+    //* number of bytes written so far
+    uint64_t pos;
+    uint64_t nValues;
+    bool isStarted;
+};
+
+// ===================
+// === blockDecode ===
+// ===================
+/** decodes one block of src (nBytes up to the next block) into dest (room for blockLen values). Returns the number of values.
+ * Throws std::runtime_error on corrupt data */
+template <class T>
+class blockDecode {
+   public:
+    static size_t decode(const unsigned char *src, size_t nBytes, T *dest) {
+        const unsigned char *end = src + nBytes;
+        need(src, end, 4);
+        size_t n = (size_t)src[0] | ((size_t)src[1] << 8);
+        mode_e mode = (mode_e)src[2];
+        uint8_t flags = src[3];
+        src += 4;
+        if (n > blockLen)
+            fail("block too long");
+        switch (mode) {
+            case MODE_RAW:
+                need(src, end, n * sizeof(T));
+                memcpy(dest, src, n * sizeof(T));
+                break;
+            case MODE_CONST: {
+                need(src, end, sizeof(T));
+                T val;
+                memcpy(&val, src, sizeof(T));
+                for (size_t ix = 0; ix < n; ++ix)
+                    dest[ix] = val;
+                break;
+            }
+            default:
+                decodeMode(src, end, n, mode, flags, dest);
+        }
+        return n;
+    }
+
+   protected:
+    static void fail(const char *msg) {
+        throw std::runtime_error(std::string("corrupt block-encoded column: ") + msg);
+    }
+    static void need(const unsigned char *src, const unsigned char *end, size_t n) {
+        if ((size_t)(end - src) < n)
+            fail("block truncated");
+    }
+
+    static void decodeMode(const unsigned char *src, const unsigned char *end, size_t n, mode_e mode, uint8_t flags, float *dest) {
+        if (mode != MODE_XOR)
+            fail("unknown mode");
+        const unsigned char *mask = NULL;
+        size_t nPresent = n;
+        if (flags & 1) {
+            need(src, end, (n + 7) / 8);
+            mask = src;
+            src += (n + 7) / 8;
+            nPresent = 0;
+            for (size_t ix = 0; ix < n; ++ix)
+                nPresent += (mask[ix / 8] >> (ix % 8)) & 1;
+        }
+        const unsigned char *planes[4];
+        for (unsigned int k = 0; k < 4; ++k) {
+            planes[k] = NULL;
+            if (flags & (0x10 << k)) {
+                need(src, end, nPresent);
+                planes[k] = src;
+                src += nPresent;
+            }
+        }
+        if (!mask) {
+            unplane(planes, n, (uint32_t *)dest);
+            return;
+        }
+        // === present values, then spread out ===
+        uint32_t tmp[blockLen];
+        unplane(planes, nPresent, tmp);
+        size_t ixPresent = 0;
+        for (size_t ix = 0; ix < n; ++ix) {
+            uint32_t w = ((mask[ix / 8] >> (ix % 8)) & 1) ? tmp[ixPresent++] : canonicalNan;
+            memcpy(dest + ix, &w, sizeof(w));
+        }
+    }
+
+    //* joins byte planes (NULL: zero) into words and undoes the XOR chain
+    static void unplane(const unsigned char *const planes[4], size_t n, uint32_t *dest) {
+        size_t ix = 0;
+        uint32_t prev = 0;
+#ifdef __SSE2__
+        // === 16 values per step: interleave the planes, then prefix XOR within 4 lanes plus the carry from the previous lanes ===
+        const __m128i zero = _mm_setzero_si128();
+        __m128i carry = zero;
+        for (; ix + 16 <= n; ix += 16) {
+            __m128i b[4];
+            for (unsigned int k = 0; k < 4; ++k)
+                b[k] = planes[k] ? _mm_loadu_si128((const __m128i *)(planes[k] + ix)) : zero;
+            __m128i lo01 = _mm_unpacklo_epi8(b[0], b[1]);
+            __m128i hi01 = _mm_unpackhi_epi8(b[0], b[1]);
+            __m128i lo23 = _mm_unpacklo_epi8(b[2], b[3]);
+            __m128i hi23 = _mm_unpackhi_epi8(b[2], b[3]);
+            __m128i w[4] = {_mm_unpacklo_epi16(lo01, lo23), _mm_unpackhi_epi16(lo01, lo23), _mm_unpacklo_epi16(hi01, hi23), _mm_unpackhi_epi16(hi01, hi23)};
+            for (unsigned int k = 0; k < 4; ++k) {
+                __m128i v = w[k];
+                v = _mm_xor_si128(v, _mm_slli_si128(v, 4));
+                v = _mm_xor_si128(v, _mm_slli_si128(v, 8));
+                v = _mm_xor_si128(v, carry);
+                carry = _mm_shuffle_epi32(v, 0xFF);
+                _mm_storeu_si128((__m128i *)(dest + ix + 4 * k), v);
+            }
+        }
+        prev = (uint32_t)_mm_cvtsi128_si32(carry);
+#endif
+        for (; ix < n; ++ix) {
+            uint32_t w = 0;
+            for (unsigned int k = 0; k < 4; ++k)
+                if (planes[k])
+                    w |= (uint32_t)planes[k][ix] << (8 * k);
+            prev ^= w;
+            dest[ix] = prev;
+        }
+    }
+
+    template <class U>
+    static void decodeMode(const unsigned char *src, const unsigned char *end, size_t n, mode_e mode, uint8_t /*flags*/, U *dest) {
+        if (mode == MODE_RLE) {
+            need(src, end, 2);
+            size_t nRuns = (size_t)src[0] | ((size_t)src[1] << 8);
+            src += 2;
+            need(src, end, nRuns * (sizeof(U) + 2));
+            size_t ix = 0;
+            for (size_t ixRun = 0; ixRun < nRuns; ++ixRun) {
+                U val;
+                memcpy(&val, src, sizeof(U));
+                size_t len = (size_t)src[sizeof(U)] | ((size_t)src[sizeof(U) + 1] << 8);
+                src += sizeof(U) + 2;
+                if (ix + len > n)
+                    fail("run too long");
+                for (size_t ixEnd = ix + len; ix < ixEnd; ++ix)
+                    dest[ix] = val;
+            }
+            if (ix != n)
+                fail("runs too short");
+        } else if (mode == MODE_BITPACK) {
+            need(src, end, sizeof(U) + 1);
+            U base;
+            memcpy(&base, src, sizeof(U));
+            unsigned int nBits = src[sizeof(U)];
+            src += sizeof(U) + 1;
+            if (nBits > 32)
+                fail("too many bits");
+            need(src, end, (n * nBits + 7) / 8);
+            const uint64_t valMask = ((uint64_t)1 << nBits) - 1;
+            uint64_t acc = 0;
+            unsigned int nAcc = 0;
+            for (size_t ix = 0; ix < n; ++ix) {
+                while (nAcc < nBits) {
+                    acc |= (uint64_t)*(src++) << nAcc;
+                    nAcc += 8;
+                }
+                dest[ix] = (U)(base + (U)(acc & valMask));
+                acc >>= nBits;
+                nAcc -= nBits;
+            }
+        } else {
+            fail("unknown mode");
+        }
+    }
+};
+
+// ====================
+// === columnReader ===
+// ====================
+//* random access to a block-encoded column file. Throws std::runtime_error on errors
+template <class T>
+class columnReader {
+   public:
+    explicit columnReader(const std::string &fname) : is(fname, std::ifstream::binary), offsets(), nValues(0), buf() {
+        if (!is.is_open())
+            throw std::runtime_error("failed to open " + fname);
+        // === header ===
+        unsigned char hdr[headerSize];
+        this->readAt(0, hdr, headerSize);
+        if (memcmp(hdr, "STDFooBk", 8) || (hdr[8] != 1))
+            throw std::runtime_error("not a block-encoded column: " + fname);
+        uint32_t len;
+        memcpy(&len, hdr + 12, sizeof(len));
+        if ((hdr[9] != sizeof(T)) || (hdr[10] != (std::is_floating_point<T>::value ? 1 : 0)) || (len != blockLen))
+            throw std::runtime_error("unexpected element type / block size: " + fname);
+
+        // === trailer, index ===
+        this->is.seekg(0, std::ifstream::end);
+        uint64_t fileSize = (uint64_t)this->is.tellg();
+        unsigned char trailer[trailerSize];
+        if (fileSize < headerSize + sizeof(trailer))
+            throw std::runtime_error("truncated block-encoded column: " + fname);
+        this->readAt(fileSize - sizeof(trailer), trailer, sizeof(trailer));
+        uint64_t nBlocks;
+        memcpy(&nBlocks, trailer, sizeof(nBlocks));
+        memcpy(&this->nValues, trailer + 8, sizeof(this->nValues));
+        uint64_t indexPos = fileSize - sizeof(trailer) - 8 * nBlocks;
+        if (memcmp(trailer + 16, "STDFooBi", 8) || (nBlocks > fileSize / 8) || (indexPos < headerSize) || (this->nValues > nBlocks * blockLen))
+            throw std::runtime_error("corrupt block-encoded column: " + fname);
+        this->offsets.resize(nBlocks + 1);
+        this->readAt(indexPos, (unsigned char *)this->offsets.data(), nBlocks * 8);
+        this->offsets[nBlocks] = indexPos;  // end of the last block
+    }
+
+    //* number of values
+    uint64_t size() const {
+        return this->nValues;
+    }
+
+    //* decodes values first..first+n-1 into dest (reads only the blocks that contain them, in one piece)
+    void read(uint64_t first, size_t n, T *dest) {
+        if (first + n > this->nValues)
+            throw std::runtime_error("read beyond end of column");
+        if (n == 0)
+            return;
+        uint64_t ixFirstBlock = first / blockLen;
+        uint64_t ixEndBlock = (first + n + blockLen - 1) / blockLen;
+        uint64_t pos0 = this->offsets[ixFirstBlock];
+        if (this->offsets[ixEndBlock] < pos0)
+            throw std::runtime_error("corrupt block index");
+        this->buf.resize((size_t)(this->offsets[ixEndBlock] - pos0));
+        this->readAt(pos0, this->buf.data(), this->buf.size());
+
+        T block[blockLen];
+        for (uint64_t ixBlock = ixFirstBlock; ixBlock < ixEndBlock; ++ixBlock) {
+            size_t ixInBlock = (size_t)(first % blockLen);
+            size_t nCopy = std::min(n, (size_t)blockLen - ixInBlock);
+            if ((ixInBlock == 0) && (nCopy == blockLen)) {
+                this->decodeBlock(ixBlock, pos0, dest);  // in place
+            } else {
+                this->decodeBlock(ixBlock, pos0, block);
+                memcpy(dest, block + ixInBlock, nCopy * sizeof(T));
+            }
+            dest += nCopy;
+            first += nCopy;
+            n -= nCopy;
+        }
+    }
+
+    std::vector<T> readAll() {
+        std::vector<T> retVal((size_t)this->nValues);
+        if (!retVal.empty())
+            this->read(0, retVal.size(), retVal.data());
+        return retVal;
+    }
+
+   protected:
+    void readAt(uint64_t pos, unsigned char *dest, size_t n) {
+        this->is.seekg((std::streamoff)pos);
+        this->is.read((char *)dest, n);
+        if ((size_t)this->is.gcount() != n)
+            throw std::runtime_error("read failed");
+    }
+
+    //* decodes block ixBlock from buf, which holds the file contents from pos0
+    void decodeBlock(uint64_t ixBlock, uint64_t pos0, T *dest) {
+        uint64_t pos = this->offsets[ixBlock];
+        uint64_t end = this->offsets[ixBlock + 1];
+        if ((pos < pos0) || (end < pos) || (end - pos0 > this->buf.size()))
+            throw std::runtime_error("corrupt block index");
+        size_t n = blockDecode<T>::decode(this->buf.data() + (pos - pos0), (size_t)(end - pos), dest);
+        size_t nExpected = (ixBlock + 2 < this->offsets.size()) ? blockLen : (size_t)(this->nValues - ixBlock * blockLen);
+        if (n != nExpected)
+            throw std::runtime_error("corrupt block-encoded column: unexpected block length");
+    }
+
+    std::ifstream is;
+    //* file offset of each block, then of the index (end of the last block)
+    std::vector<uint64_t> offsets;
+    uint64_t nValues;
+    //* encoded blocks of the current read()
+    std::vector<unsigned char> buf;
+};
+}  // namespace stdfooCodec
+#endif
@@ -0,0 +1,1483 @@
+// Self-contained gzip (RFC 1952) / deflate (RFC 1951) decoder for STDFoo. No library dependencies.
+// Table-driven: one lookup per literal / length / distance for codes up to 10 (9) bits, second-level tables otherwise.
+#ifndef STDFOO_INFLATE_HPP
+#define STDFOO_INFLATE_HPP
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <cstring>  // memcpy
+#include <deque>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stdfooInflate {
+
+// =============
+// === crc32 ===
+// =============
+//* gzip CRC-32 (slice-by-8) */
+class crc32 {
+   public:
+    static uint32_t update(uint32_t crc, const unsigned char *p, size_t n) {
+        const uint32_t(&t)[8][256] = tables();
+        crc = ~crc;
+        while (n >= 8) {
+            uint32_t lo = crc ^ ((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+            uint32_t hi = (uint32_t)p[4] | ((uint32_t)p[5] << 8) | ((uint32_t)p[6] << 16) | ((uint32_t)p[7] << 24);
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                  t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+            p += 8;
+            n -= 8;
+        }
+        while (n--)
+            crc = t[0][(crc ^ *(p++)) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    //* CRC of the concatenation of A and B from crcA, crcB and the length of B (as zlib's crc32_combine)
+    static uint32_t combine(uint32_t crcA, uint32_t crcB, uint64_t nB) {
+        if (nB == 0)
+            return crcA;
+        // === operator for one zero bit, then squared to 2, 4, ... zero bits; applied per set bit of the zero byte count ===
+        uint32_t even[32];
+        uint32_t odd[32];
+        odd[0] = 0xEDB88320u;
+        for (unsigned int ix = 1; ix < 32; ++ix)
+            odd[ix] = 1u << (ix - 1);
+        gf2Square(even, odd);  // 2 zero bits
+        gf2Square(odd, even);  // 4 zero bits
+        while (true) {
+            gf2Square(even, odd);  // first pass: one zero byte
+            if (nB & 1)
+                crcA = gf2Times(even, crcA);
+            nB >>= 1;
+            if (nB == 0)
+                break;
+            gf2Square(odd, even);
+            if (nB & 1)
+                crcA = gf2Times(odd, crcA);
+            nB >>= 1;
+            if (nB == 0)
+                break;
+        }
+        return crcA ^ crcB;
+    }
+
+   protected:
+    static uint32_t gf2Times(const uint32_t *mat, uint32_t vec) {
+        uint32_t sum = 0;
+        for (; vec; vec >>= 1, ++mat)
+            if (vec & 1)
+                sum ^= *mat;
+        return sum;
+    }
+    static void gf2Square(uint32_t *square, const uint32_t *mat) {
+        for (unsigned int ix = 0; ix < 32; ++ix)
+            square[ix] = gf2Times(mat, mat[ix]);
+    }
+    static const uint32_t (&tables())[8][256] {
+        static uint32_t t[8][256];
+        static bool init = [] {
+            for (uint32_t ix = 0; ix < 256; ++ix) {
+                uint32_t c = ix;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                t[0][ix] = c;
+            }
+            for (uint32_t ix = 0; ix < 256; ++ix)
+                for (int k = 1; k < 8; ++k)
+                    t[k][ix] = t[0][t[k - 1][ix] & 0xFF] ^ (t[k - 1][ix] >> 8);
+            return true;
+        }();
+        (void)init;
+        return t;
+    }
+};
+
+// ====================
+// === huffmanTable ===
+// ====================
+//* canonical Huffman decoding table. Entry: [31:16] value, [15:12] extra bits, [11:8] kind, [7:0] bits to consume */
+class huffmanTable {
+   public:
+    enum kind_e {
+        LITERAL = 0,
+        LENGTH = 1,
+        END_OF_BLOCK = 2,
+        SUBTABLE = 3,
+        DISTANCE = 4,
+        INVALID = 5
+    };
+
+    //* builds the table from code lengths. "symbolEntry" gives the entry (without length) for each symbol. Returns false if over-subscribed */
+    bool build(const uint8_t *lengths, unsigned int nSymbols, unsigned int primaryBits, const uint32_t *symbolEntry) {
+        this->primaryBits = primaryBits;
+        unsigned int count[16] = {0};
+        for (unsigned int ix = 0; ix < nSymbols; ++ix)
+            ++count[lengths[ix]];
+        count[0] = 0;
+
+        // === check for over-subscription. Incomplete codes are legal (e.g. single distance code) ===
+        int left = 1;
+        for (unsigned int len = 1; len < 16; ++len) {
+            left <<= 1;
+            left -= count[len];
+            if (left < 0)
+                return false;
+        }
+
+        // === first canonical code per length ===
+        unsigned int nextCode[16];
+        unsigned int code = 0;
+        for (unsigned int len = 1; len < 16; ++len) {
+            nextCode[len] = code;
+            code = (code + count[len]) << 1;
+        }
+
+        // === reversed codes (deflate is LSB first). Subtable size per primary prefix ===
+        std::vector<uint16_t> rev(nSymbols);
+        std::vector<uint8_t> subBits(1u << primaryBits, 0);
+        for (unsigned int ix = 0; ix < nSymbols; ++ix) {
+            unsigned int len = lengths[ix];
+            if (len == 0)
+                continue;
+            unsigned int c = nextCode[len]++;
+            unsigned int r = 0;
+            for (unsigned int b = 0; b < len; ++b)
+                r |= ((c >> b) & 1) << (len - 1 - b);
+            rev[ix] = (uint16_t)r;
+            if (len > primaryBits) {
+                unsigned int prefix = r & ((1u << primaryBits) - 1);
+                subBits[prefix] = std::max(subBits[prefix], (uint8_t)(len - primaryBits));
+            }
+        }
+
+        // === allocate ===
+        size_t nEntries = (size_t)1 << primaryBits;
+        std::vector<uint32_t> subStart(subBits.size(), 0);
+        for (size_t prefix = 0; prefix < subBits.size(); ++prefix)
+            if (subBits[prefix]) {
+                subStart[prefix] = (uint32_t)nEntries;
+                nEntries += (size_t)1 << subBits[prefix];
+            }
+        this->entries.assign(nEntries, (uint32_t)INVALID << 8);
+        for (size_t prefix = 0; prefix < subBits.size(); ++prefix)
+            if (subBits[prefix])
+                this->entries[prefix] = (subStart[prefix] << 16) | ((uint32_t)subBits[prefix] << 12) | ((uint32_t)SUBTABLE << 8) | primaryBits;
+
+        // === fill ===
+        for (unsigned int ix = 0; ix < nSymbols; ++ix) {
+            unsigned int len = lengths[ix];
+            if (len == 0)
+                continue;
+            unsigned int r = rev[ix];
+            if (len <= primaryBits) {
+                for (unsigned int pos = r; pos < (1u << primaryBits); pos += 1u << len)
+                    this->entries[pos] = symbolEntry[ix] | len;
+            } else {
+                unsigned int prefix = r & ((1u << primaryBits) - 1);
+                unsigned int subLen = len - primaryBits;
+                for (unsigned int pos = r >> primaryBits; pos < (1u << subBits[prefix]); pos += 1u << subLen)
+                    this->entries[subStart[prefix] + pos] = symbolEntry[ix] | subLen;
+            }
+        }
+        return true;
+    }
+
+    //* number of bits resolved by the first lookup
+    unsigned int primaryBits;
+    std::vector<uint32_t> entries;
+};
+
+// ===================
+// === gzipDecoder ===
+// ===================
+//* streaming gzip decoder. Input is pulled through readInput(), decoded data returned by read() */
+class gzipDecoder {
+   public:
+    //* input callback: fills up to n bytes, returns number of bytes (0: end of data)
+    typedef size_t (*readInput_t)(void *ctx, unsigned char *dest, size_t n);
+
+    //* gzip: expect gzip member framing (multiple members are concatenated). Otherwise decode a single raw deflate stream
+    gzipDecoder(readInput_t readInput, void *ctx, bool gzip = true) : in(inBufSize + 8), window(windowSize + outChunk + 258 + 16) {
+        this->readInput = readInput;
+        this->ctx = ctx;
+        this->gzip = gzip;
+        this->state = gzip ? MEMBER_HEADER : BLOCK_HEADER;
+        initStaticEntries();
+    }
+
+    /** returns up to n decoded bytes. Returns 0 at end of data. Throws std::runtime_error on corrupt data, once all data decoded before
+     * it has been returned (truncated file: every complete symbol, as zlib) */
+    size_t read(unsigned char *dest, size_t n) {
+        while (this->readPos == this->outPos) {
+            if (!this->error.empty())
+                throw std::runtime_error(this->error);
+            if (this->state == DONE)
+                return 0;
+            // === all output consumed: keep 32k history, continue decoding ===
+            if (this->outPos > windowSize) {
+                memmove(this->window.data(), this->window.data() + this->outPos - windowSize, windowSize);
+                this->outPos = windowSize;
+                this->readPos = windowSize;
+                this->crcPos = windowSize;
+            }
+            try {
+                this->decode();
+            } catch (std::runtime_error &e) {
+                this->error = e.what();  // raised after window[readPos..outPos)
+            }
+        }
+        size_t nAvail = this->outPos - this->readPos;
+        if (n > nAvail)
+            n = nAvail;
+        memcpy(dest, this->window.data() + this->readPos, n);
+        this->readPos += n;
+        return n;
+    }
+
+    /** raw deflate only, before the first read(): the stream continues at bit nSkipBits (0..7) of the input, after nHistory bytes of
+     * output (up to 32k). See parallelGzipDecoder */
+    void resume(const unsigned char *history, size_t nHistory, unsigned int nSkipBits) {
+        nHistory = std::min(nHistory, (size_t)windowSize);
+        memcpy(this->window.data(), history, nHistory);
+        this->outPos = nHistory;
+        this->readPos = nHistory;
+        this->crcPos = nHistory;
+        this->getBits(nSkipBits);
+    }
+
+    // ======================
+    // === table entries ===
+    // ======================
+    static uint32_t entry(uint32_t value, uint32_t extra, uint32_t kind) {
+        return (value << 16) | (extra << 12) | (kind << 8);
+    }
+    //* huffmanTable entries (without length) of the literal / length and distance alphabets
+    static void initSymbolEntries(uint32_t (&litlenEntry)[288], uint32_t (&distEntry)[32]) {
+        static const uint16_t lenBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const uint8_t lenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const uint16_t distBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const uint8_t distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        for (uint32_t ix = 0; ix < 256; ++ix)
+            litlenEntry[ix] = entry(ix, 0, huffmanTable::LITERAL);
+        litlenEntry[256] = entry(0, 0, huffmanTable::END_OF_BLOCK);
+        for (uint32_t ix = 0; ix < 29; ++ix)
+            litlenEntry[257 + ix] = entry(lenBase[ix], lenExtra[ix], huffmanTable::LENGTH);
+        litlenEntry[286] = litlenEntry[287] = entry(0, 0, huffmanTable::INVALID);
+        for (uint32_t ix = 0; ix < 30; ++ix)
+            distEntry[ix] = entry(distBase[ix], distExtra[ix], huffmanTable::DISTANCE);
+        distEntry[30] = distEntry[31] = entry(0, 0, huffmanTable::INVALID);
+    }
+
+   protected:
+    static const size_t inBufSize = 1 << 20;
+    static const size_t windowSize = 1 << 15;
+    static const size_t outChunk = 1 << 20;
+    enum state_e {
+        MEMBER_HEADER,
+        BLOCK_HEADER,
+        STORED,
+        HUFFMAN,
+        MEMBER_TRAILER,
+        DONE
+    };
+
+    // ==================
+    // === bit reader ===
+    // ==================
+    //* tops up the bit buffer to at least 56 bits (zero-padded beyond end of input).
+    //* Note: bits above bitcnt may hold look-ahead from the next input byte; refilling ORs identical data on top */
+    inline void refill() {
+        if (this->inEnd - this->inPos >= 8) {
+            uint64_t v;
+            memcpy(&v, this->in.data() + this->inPos, 8);  // note: little endian host
+            this->bitbuf |= v << this->bitcnt;
+            this->inPos += (63 - this->bitcnt) >> 3;
+            this->bitcnt |= 56;
+            return;
+        }
+        while (this->bitcnt < 56) {
+            if (this->inPos == this->inEnd) {
+                // === refill input buffer, keeping nothing (all unread bytes are consumed byte-wise here) ===
+                this->inPos = 0;
+                this->inEnd = this->inputEof ? 0 : this->readInput(this->ctx, this->in.data(), inBufSize);
+                if (this->inEnd == 0) {
+                    this->inputEof = true;
+                    ++this->nPadBytes;
+                    this->bitcnt += 8;  // zero byte
+                    continue;
+                }
+                if (this->inEnd >= 8)
+                    return this->refill();
+            }
+            this->bitbuf |= (uint64_t)this->in[this->inPos++] << this->bitcnt;
+            this->bitcnt += 8;
+        }
+    }
+    inline uint32_t bits(unsigned int n) {
+        return (uint32_t)(this->bitbuf & ((1ull << n) - 1));
+    }
+    inline void consume(unsigned int n) {
+        this->bitbuf >>= n;
+        this->bitcnt -= n;
+    }
+    inline uint32_t getBits(unsigned int n) {
+        if (this->bitcnt < n)
+            this->refill();
+        uint32_t v = this->bits(n);
+        this->consume(n);
+        return v;
+    }
+    //* true if decoding went beyond the end of input (truncated file)
+    bool overrun() {
+        return this->bitcnt < 8 * this->nPadBytes;
+    }
+    //* true if all input has been consumed, up to padding (byte aligned)
+    bool inputExhausted() {
+        this->refill();
+        return this->bitcnt - (this->bitcnt & 7) <= 8 * this->nPadBytes;
+    }
+    void alignToByte() {
+        this->consume(this->bitcnt & 7);
+    }
+    static void corrupt(const char *msg) {
+        throw std::runtime_error(std::string("corrupt gzip data: ") + msg);
+    }
+
+    void initStaticEntries() {
+        initSymbolEntries(this->litlenEntry, this->distEntry);
+    }
+
+    // ===============
+    // === headers ===
+    // ===============
+    void memberHeader() {
+        if (this->getBits(8) != 0x1f || this->getBits(8) != 0x8b)
+            corrupt("bad magic");
+        if (this->getBits(8) != 8)
+            corrupt("unknown compression method");
+        uint32_t flg = this->getBits(8);
+        this->getBits(16);  // MTIME
+        this->getBits(16);
+        this->getBits(16);  // XFL, OS
+        if (flg & 4) {      // FEXTRA
+            uint32_t xlen = this->getBits(16);
+            while (xlen--)
+                this->getBits(8);
+        }
+        if (flg & 8)  // FNAME
+            while (this->getBits(8) != 0 && !this->overrun()) {
+            }
+        if (flg & 16)  // FCOMMENT
+            while (this->getBits(8) != 0 && !this->overrun()) {
+            }
+        if (flg & 2)  // FHCRC
+            this->getBits(16);
+        if (this->overrun())
+            corrupt("truncated header");
+        this->crc = 0;
+        this->isize = 0;
+        this->crcPos = this->outPos;
+    }
+
+    void memberTrailer() {
+        this->updateCrc();
+        this->alignToByte();
+        uint32_t crc = this->getBits(16);
+        crc |= this->getBits(16) << 16;
+        uint32_t isize = this->getBits(16);
+        isize |= this->getBits(16) << 16;
+        if (this->overrun())
+            corrupt("truncated file");
+        if (crc != this->crc)
+            corrupt("CRC mismatch");
+        if (isize != this->isize)
+            corrupt("length mismatch");
+
+        // === another member follows? Trailing garbage is ignored (as gzip does) ===
+        if (this->inputExhausted() || (this->bits(16) != 0x8b1f))
+            this->state = DONE;
+        else
+            this->state = MEMBER_HEADER;
+    }
+
+    //* accounts output written since last call for CRC / ISIZE
+    void updateCrc() {
+        if (!this->gzip)
+            return;
+        this->crc = crc32::update(this->crc, this->window.data() + this->crcPos, this->outPos - this->crcPos);
+        this->isize += (uint32_t)(this->outPos - this->crcPos);
+        this->crcPos = this->outPos;
+    }
+
+    void blockHeader() {
+        this->finalBlock = this->getBits(1);
+        uint32_t type = this->getBits(2);
+        if (type == 0) {
+            // === stored ===
+            this->alignToByte();
+            uint32_t len = this->getBits(16);
+            uint32_t nlen = this->getBits(16);
+            if ((len ^ 0xFFFF) != nlen)
+                corrupt("stored block length");
+            this->storedRemaining = len;
+            this->state = STORED;
+        } else if (type == 1) {
+            // === fixed Huffman ===
+            if (this->fixedLitlen.entries.empty()) {
+                uint8_t l[288];
+                for (unsigned int ix = 0; ix < 288; ++ix)
+                    l[ix] = (ix < 144) ? 8 : (ix < 256) ? 9 : (ix < 280) ? 7 : 8;
+                uint8_t d[32];
+                for (unsigned int ix = 0; ix < 32; ++ix)
+                    d[ix] = 5;
+                this->fixedLitlen.build(l, 288, 10, this->litlenEntry);
+                this->fixedDist.build(d, 32, 9, this->distEntry);
+            }
+            this->curLitlen = &this->fixedLitlen;
+            this->curDist = &this->fixedDist;
+            this->state = HUFFMAN;
+        } else if (type == 2) {
+            this->dynamicHeader();
+            this->curLitlen = &this->dynLitlen;
+            this->curDist = &this->dynDist;
+            this->state = HUFFMAN;
+        } else {
+            corrupt("invalid block type");
+        }
+        if (this->overrun())
+            corrupt("truncated block header");
+    }
+
+    void dynamicHeader() {
+        static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        uint32_t hlit = this->getBits(5) + 257;
+        uint32_t hdist = this->getBits(5) + 1;
+        uint32_t hclen = this->getBits(4) + 4;
+        if ((hlit > 286) || (hdist > 30))
+            corrupt("too many codes");
+        uint8_t clLen[19] = {0};
+        for (uint32_t ix = 0; ix < hclen; ++ix)
+            clLen[order[ix]] = (uint8_t)this->getBits(3);
+        uint32_t clEntry[19];
+        for (uint32_t ix = 0; ix < 19; ++ix)
+            clEntry[ix] = entry(ix, 0, huffmanTable::LITERAL);
+        huffmanTable cl;
+        if (!cl.build(clLen, 19, 7, clEntry))
+            corrupt("code length code");
+
+        // === read literal/length + distance code lengths (one sequence) ===
+        uint8_t lengths[286 + 30];
+        uint32_t n = 0;
+        while (n < hlit + hdist) {
+            if (this->bitcnt < 16)
+                this->refill();
+            uint32_t e = cl.entries[this->bits(7)];
+            if (((e >> 8) & 0xF) == huffmanTable::INVALID)
+                corrupt("code length symbol");
+            this->consume(e & 0xFF);
+            uint32_t sym = e >> 16;
+            if (sym < 16) {
+                lengths[n++] = (uint8_t)sym;
+                continue;
+            }
+            uint32_t rep;
+            uint8_t val = 0;
+            if (sym == 16) {
+                if (n == 0)
+                    corrupt("repeat without previous length");
+                val = lengths[n - 1];
+                rep = 3 + this->getBits(2);
+            } else if (sym == 17) {
+                rep = 3 + this->getBits(3);
+            } else {
+                rep = 11 + this->getBits(7);
+            }
+            if (n + rep > hlit + hdist)
+                corrupt("code lengths overflow");
+            while (rep--)
+                lengths[n++] = val;
+            if (this->overrun())
+                corrupt("truncated code lengths");
+        }
+        if (lengths[256] == 0)
+            corrupt("missing end-of-block code");
+        if (!this->dynLitlen.build(lengths, hlit, 10, this->litlenEntry) || !this->dynDist.build(lengths + hlit, hdist, 9, this->distEntry))
+            corrupt("over-subscribed code");
+    }
+
+    // ================
+    // === decoding ===
+    // ================
+    //* decodes until at least outChunk bytes are available, or the stream ends
+    void decode() {
+        size_t outLimit = this->outPos + outChunk;
+        while ((this->state != DONE) && (this->outPos < outLimit)) {
+            switch (this->state) {
+                case MEMBER_HEADER:
+                    this->memberHeader();
+                    this->state = BLOCK_HEADER;
+                    break;
+                case BLOCK_HEADER:
+                    this->blockHeader();
+                    break;
+                case STORED: {
+                    this->alignToByte();
+                    while (this->storedRemaining && (this->outPos < outLimit)) {
+                        // drain bit buffer bytewise, then copy directly from the input buffer
+                        if (this->bitcnt >= 8) {
+                            unsigned char c = (unsigned char)this->getBits(8);
+                            if (this->overrun())
+                                corrupt("truncated stored block");
+                            this->window[this->outPos++] = c;
+                            --this->storedRemaining;
+                            continue;
+                        }
+                        if (this->inPos == this->inEnd) {
+                            this->refill();
+                            if (this->overrun())
+                                corrupt("truncated stored block");
+                            continue;
+                        }
+                        // bypassing the bit buffer: drop its look-ahead bits (see refill())
+                        this->bitbuf = 0;
+                        size_t n = std::min(std::min((size_t)this->storedRemaining, this->inEnd - this->inPos), outLimit - this->outPos);
+                        memcpy(this->window.data() + this->outPos, this->in.data() + this->inPos, n);
+                        this->inPos += n;
+                        this->outPos += n;
+                        this->storedRemaining -= (uint32_t)n;
+                    }
+                    if (this->storedRemaining == 0)
+                        this->endOfBlock();
+                    break;
+                }
+                case HUFFMAN:
+                    if (this->huffman(outLimit))
+                        this->endOfBlock();
+                    break;
+                case MEMBER_TRAILER:
+                    this->memberTrailer();
+                    break;
+                case DONE:
+                    break;
+            }
+        }
+        this->updateCrc();
+    }
+
+    void endOfBlock() {
+        if (!this->finalBlock)
+            this->state = BLOCK_HEADER;
+        else if (this->gzip)
+            this->state = MEMBER_TRAILER;
+        else
+            this->state = DONE;
+    }
+
+    /** decodes symbols until end of block (returns true) or outLimit is reached (returns false). On error, outPos stays behind the last
+     * symbol decoded from input (not from the zero padding at the end of a truncated file) */
+    bool huffman(size_t outLimit) {
+        const uint32_t *litlen = this->curLitlen->entries.data();
+        const uint32_t litlenMask = (1u << this->curLitlen->primaryBits) - 1;
+        const uint32_t *dist = this->curDist->entries.data();
+        const uint32_t distMask = (1u << this->curDist->primaryBits) - 1;
+        unsigned char *out = this->window.data();
+        size_t outPos = this->outPos;
+        // end of input reached: check each symbol for overrun
+        bool isPadded = this->nPadBytes > 0;
+
+        while (outPos < outLimit) {
+            // 56 bits cover one complete length (15 + 5) / distance (15 + 13) pair
+            if (this->bitcnt < 48) {
+                this->refill();
+                isPadded = this->nPadBytes > 0;
+            }
+            uint32_t e = litlen[this->bitbuf & litlenMask];
+            uint32_t kind = (e >> 8) & 0xF;
+            if (kind == huffmanTable::SUBTABLE) {
+                this->consume(e & 0xFF);
+                e = litlen[(e >> 16) + this->bits((e >> 12) & 0xF)];
+                kind = (e >> 8) & 0xF;
+            }
+            this->consume(e & 0xFF);
+            if (isPadded && this->overrun())
+                break;
+            if (kind == huffmanTable::LITERAL) {
+                out[outPos++] = (unsigned char)(e >> 16);
+                continue;
+            }
+            this->outPos = outPos;
+            if (kind == huffmanTable::END_OF_BLOCK)
+                return true;
+            if (kind != huffmanTable::LENGTH)
+                corrupt("invalid literal/length code");
+            uint32_t extra = (e >> 12) & 0xF;
+            uint32_t len = (e >> 16) + this->bits(extra);
+            this->consume(extra);
+
+            uint32_t d = dist[this->bitbuf & distMask];
+            if (((d >> 8) & 0xF) == huffmanTable::SUBTABLE) {
+                this->consume(d & 0xFF);
+                d = dist[(d >> 16) + this->bits((d >> 12) & 0xF)];
+            }
+            this->consume(d & 0xFF);
+            extra = (d >> 12) & 0xF;
+            size_t distance = (d >> 16) + this->bits(extra);
+            this->consume(extra);
+            if (isPadded && this->overrun())
+                break;
+            if (((d >> 8) & 0xF) != huffmanTable::DISTANCE)
+                corrupt("invalid distance code");
+            if (distance > outPos)
+                corrupt("distance too far back");
+
+            // === copy match (may overlap). Window has slack for 16 bytes overrun ===
+            const unsigned char *src = out + outPos - distance;
+            unsigned char *dst = out + outPos;
+            outPos += len;
+            if (distance >= 8) {
+                unsigned char *end = dst + len;
+                do {
+                    memcpy(dst, src, 8);
+                    dst += 8;
+                    src += 8;
+                } while (dst < end);
+            } else {
+                while (len--)
+                    *(dst++) = *(src++);
+            }
+        }
+        this->outPos = outPos;
+        if (this->overrun())
+            corrupt("truncated block");
+        return false;
+    }
+
+    // === input ===
+    readInput_t readInput;
+    void *ctx;
+    std::vector<unsigned char> in;
+    size_t inPos = 0;
+    size_t inEnd = 0;
+    bool inputEof = false;
+    uint64_t bitbuf = 0;
+    unsigned int bitcnt = 0;
+    //* zero bytes appended beyond end of input
+    unsigned int nPadBytes = 0;
+
+    // === output: 32k history followed by decoded data ===
+    std::vector<unsigned char> window;
+    size_t outPos = 0;
+    size_t readPos = 0;
+
+    // === state ===
+    bool gzip;
+    state_e state;
+    bool finalBlock = false;
+    uint32_t storedRemaining = 0;
+    uint32_t crc = 0;
+    uint32_t isize = 0;
+    size_t crcPos = 0;
+    uint32_t litlenEntry[288];
+    uint32_t distEntry[32];
+    huffmanTable fixedLitlen;
+    huffmanTable fixedDist;
+    huffmanTable dynLitlen;
+    huffmanTable dynDist;
+    huffmanTable *curLitlen = nullptr;
+    huffmanTable *curDist = nullptr;
+    //* raised by read() once the data decoded before it has been returned
+    std::string error;
+};
+
+//* gzipDecoder input callback for data in memory
+struct memoryInput {
+    const unsigned char *p;
+    size_t n;
+    static size_t read(void *ctx, unsigned char *dest, size_t n) {
+        memoryInput *m = (memoryInput *)ctx;
+        n = std::min(n, m->n);
+        memcpy(dest, m->p, n);
+        m->p += n;
+        m->n -= n;
+        return n;
+    }
+};
+
+//* decodes a complete raw deflate stream "in" into "out" (of known decoded size). Returns false on error */
+inline bool inflateRaw(const unsigned char *in, size_t nIn, unsigned char *out, size_t nOut) {
+    memoryInput src = {in, nIn};
+    try {
+        gzipDecoder d(memoryInput::read, &src, /*gzip*/ false);
+        size_t pos = 0;
+        while (pos < nOut) {
+            size_t n = d.read(out + pos, nOut - pos);
+            if (n == 0)
+                return false;
+            pos += n;
+        }
+        unsigned char dummy;
+        return d.read(&dummy, 1) == 0;
+    } catch (std::runtime_error &) {
+        return false;
+    }
+}
+
+// =====================
+// === chunkInflater ===
+// =====================
+/** decodes deflate blocks of an in-memory stream from any block boundary, without the preceding 32k history (basis of parallelGzipDecoder).
+ * Output are symbols: byte values below "marker". A back-reference into the unknown history gives marker + position in that history
+ * (0 .. windowSize - 1, the byte before the first output is windowSize - 1), converted by resolve() once the history is known */
+class chunkInflater {
+   public:
+    static const size_t windowSize = 1 << 15;
+    static const uint16_t marker = 256;
+
+    struct result {
+        //* bit position of the first block header (~0: no block found)
+        uint64_t startBit = ~(uint64_t)0;
+        //* bit position following the last block decoded
+        uint64_t endBit = 0;
+        //* the last block decoded was the final block of the deflate stream
+        bool isFinal = false;
+        std::vector<uint16_t> out;
+        //* empty if ok. Otherwise "out" holds the symbols before the error
+        std::string error;
+    };
+
+    chunkInflater(const unsigned char *data, size_t n) : data(data), n(n) {
+        gzipDecoder::initSymbolEntries(this->litlenEntry, this->distEntry);
+        uint8_t l[288];
+        for (unsigned int ix = 0; ix < 288; ++ix)
+            l[ix] = (ix < 144) ? 8 : (ix < 256) ? 9 : (ix < 280) ? 7 : 8;
+        uint8_t d[32];
+        for (unsigned int ix = 0; ix < 32; ++ix)
+            d[ix] = 5;
+        this->fixedLitlen.build(l, 288, 10, this->litlenEntry);
+        this->fixedDist.build(d, 32, 9, this->distEntry);
+    }
+
+    //* decodes the blocks from the header at startBit up to the first block header at or after stopBit, or through the final block
+    void decode(uint64_t startBit, uint64_t stopBit, result &r) {
+        r.startBit = startBit;
+        r.isFinal = false;
+        r.error.clear();
+        // === typical compression ratio, to save reallocation ===
+        r.out.resize(std::max(r.out.size(), std::max((size_t)outChunk, (size_t)std::min(stopBit - startBit, (uint64_t)1 << 30))));
+        this->out = &r.out;
+        this->nOut = 0;
+        this->seek(startBit);
+        try {
+            while (this->position() < stopBit) {
+                if (this->position() + 3 > 8 * (uint64_t)this->n)
+                    corrupt("truncated file");
+                bool isFinal = this->getBits(1) != 0;
+                this->block();
+                if (isFinal) {
+                    r.isFinal = true;
+                    break;
+                }
+            }
+        } catch (std::runtime_error &e) {
+            r.error = e.what();
+        }
+        r.endBit = this->position();
+        r.out.resize(this->nOut);
+    }
+
+    /** finds the first bit position in [fromBit, toBit) that starts a plausible non-final dynamic Huffman block: complete codes
+     * (except for a single distance code), code lengths that decode exactly. Returns false if there is none */
+    bool findBlock(uint64_t fromBit, uint64_t toBit, uint64_t &found) {
+        toBit = std::min(toBit, 8 * (uint64_t)this->n);
+        for (uint64_t base = fromBit; base < toBit; base += 48) {
+            // === positions with BFINAL = 0, BTYPE = 2, 48 at a time ===
+            uint64_t w = this->peek(base);
+            uint64_t candidates = ~w & ~(w >> 1) & (w >> 2) & ((1ull << std::min((uint64_t)48, toBit - base)) - 1);
+            for (; candidates; candidates &= candidates - 1) {
+                uint64_t bit = base + ctz(candidates);
+                if (this->isBlockStart(bit)) {
+                    found = bit;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /** converts n symbols to bytes. "window" holds the windowSize bytes preceding the first symbol, of which the last nValid are known.
+     * Returns the number of symbols converted (less than n at a reference to unknown history) */
+    static size_t resolve(const uint16_t *sym, size_t n, const unsigned char *window, size_t nValid, unsigned char *dest) {
+        const size_t firstValid = windowSize - nValid;
+        const size_t blockSize = 4096;
+        for (size_t start = 0; start < n; start += blockSize) {
+            // === usually no markers: plain conversion (vectorized) ===
+            size_t end = std::min(n, start + blockSize);
+            uint16_t any = 0;
+            for (size_t ix = start; ix < end; ++ix) {
+                dest[ix] = (unsigned char)sym[ix];
+                any |= sym[ix];
+            }
+            if (any < marker)
+                continue;
+            for (size_t ix = start; ix < end; ++ix) {
+                uint32_t s = sym[ix];
+                if (s < marker)
+                    continue;
+                s -= marker;
+                if (s < firstValid)
+                    return ix;
+                dest[ix] = window[s];
+            }
+        }
+        return n;
+    }
+
+   protected:
+    static const size_t outChunk = 1 << 20;
+
+    //* see findBlock(). bit has BFINAL = 0, BTYPE = 2
+    bool isBlockStart(uint64_t bit) {
+        uint64_t v = this->peek(bit);
+        if ((((v >> 3) & 31) > 29) || (((v >> 8) & 31) > 29))  // HLIT, HDIST
+            return false;
+        // === code length code must be complete: sum of 2^-length is 1 ===
+        uint32_t hclen = (uint32_t)((v >> 13) & 15) + 4;
+        uint64_t c = this->peek(bit + 17);
+        uint32_t kraft = 0;
+        for (uint32_t ix = 0; ix < hclen; ++ix, c >>= 3)
+            kraft += (0x0102040810204000ull >> (8 * (c & 7))) & 0xFF;  // 2^(7 - length), 0 for unused
+        if (kraft != 128)
+            return false;
+        this->seek(bit + 3);
+        return this->dynamicHeader(/*strict*/ true);
+    }
+    //* index of the lowest set bit (v != 0)
+    static unsigned int ctz(uint64_t v) {
+#if defined(__GNUC__)
+        return (unsigned int)__builtin_ctzll(v);
+#else
+        unsigned int n = 0;
+        for (; !(v & 1); v >>= 1)
+            ++n;
+        return n;
+#endif
+    }
+
+    // ==================
+    // === bit reader ===
+    // ==================
+    //* see gzipDecoder::refill(). Zero-padded beyond the end of data
+    inline void refill() {
+        if (this->bytePos + 8 <= this->n) {
+            uint64_t v;
+            memcpy(&v, this->data + this->bytePos, 8);  // note: little endian host
+            this->bitbuf |= v << this->bitcnt;
+            this->bytePos += (63 - this->bitcnt) >> 3;
+            this->bitcnt |= 56;
+            return;
+        }
+        while (this->bitcnt < 56) {
+            if (this->bytePos < this->n)
+                this->bitbuf |= (uint64_t)this->data[this->bytePos] << this->bitcnt;
+            ++this->bytePos;
+            this->bitcnt += 8;
+        }
+    }
+    inline uint32_t bits(unsigned int n) {
+        return (uint32_t)(this->bitbuf & ((1ull << n) - 1));
+    }
+    inline void consume(unsigned int n) {
+        this->bitbuf >>= n;
+        this->bitcnt -= n;
+    }
+    inline uint32_t getBits(unsigned int n) {
+        if (this->bitcnt < n)
+            this->refill();
+        uint32_t v = this->bits(n);
+        this->consume(n);
+        return v;
+    }
+    uint64_t position() const {
+        return 8 * (uint64_t)this->bytePos - this->bitcnt;
+    }
+    //* true if decoding went beyond the end of data (truncated file)
+    bool overrun() const {
+        return this->position() > 8 * (uint64_t)this->n;
+    }
+    void seek(uint64_t bit) {
+        this->bytePos = (size_t)(bit >> 3);
+        this->bitbuf = 0;
+        this->bitcnt = 0;
+        this->refill();
+        this->consume((unsigned int)(bit & 7));
+    }
+    //* (at least) 57 bits from position "bit" without decoding
+    uint64_t peek(uint64_t bit) const {
+        size_t pos = (size_t)(bit >> 3);
+        uint64_t v = 0;
+        if (pos + 8 <= this->n)
+            memcpy(&v, this->data + pos, 8);
+        else
+            for (size_t ix = 0; pos + ix < this->n; ++ix)
+                v |= (uint64_t)this->data[pos + ix] << (8 * ix);
+        return v >> (bit & 7);
+    }
+    static void corrupt(const char *msg) {
+        throw std::runtime_error(std::string("corrupt gzip data: ") + msg);
+    }
+    //* makes room for n more symbols
+    void reserve(size_t n) {
+        if (this->nOut + n > this->out->size())
+            this->out->resize(std::max(2 * this->out->size(), this->nOut + n));
+    }
+
+    // ==============
+    // === blocks ===
+    // ==============
+    static const uint8_t *clOrder() {
+        static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        return order;
+    }
+    //* Kraft inequality: 0 for a complete code, > 0 incomplete, < 0 over-subscribed
+    static int kraftLeft(const uint8_t *lengths, unsigned int nSymbols) {
+        unsigned int count[16] = {0};
+        for (unsigned int ix = 0; ix < nSymbols; ++ix)
+            ++count[lengths[ix]];
+        int left = 1;
+        for (unsigned int len = 1; len < 16; ++len) {
+            left = 2 * left - (int)count[len];
+            if (left < 0)
+                return -1;
+        }
+        return left;
+    }
+
+    //* decodes one block following BFINAL
+    void block() {
+        uint32_t type = this->getBits(2);
+        if (type == 0) {
+            this->stored();
+        } else if (type == 1) {
+            this->huffman(this->fixedLitlen, this->fixedDist);
+        } else if (type == 2) {
+            if (!this->dynamicHeader(/*strict*/ false))
+                corrupt(this->overrun() ? "truncated block header" : "invalid dynamic block header");
+            this->huffman(this->dynLitlen, this->dynDist);
+        } else {
+            corrupt("invalid block type");
+        }
+    }
+
+    void stored() {
+        this->consume(this->bitcnt & 7);  // align to byte
+        uint32_t len = this->getBits(16);
+        uint32_t nlen = this->getBits(16);
+        if ((len ^ 0xFFFF) != nlen)
+            corrupt(this->overrun() ? "truncated block header" : "stored block length");
+        size_t pos = (size_t)(this->position() >> 3);
+        if (pos + len > this->n)
+            corrupt("truncated stored block");
+        this->reserve(len);
+        uint16_t *dest = this->out->data() + this->nOut;
+        for (uint32_t ix = 0; ix < len; ++ix)
+            dest[ix] = this->data[pos + ix];
+        this->nOut += len;
+        this->seek(8 * (uint64_t)(pos + len));
+    }
+
+    //* reads the code lengths following BTYPE = 2 into dynLitlen / dynDist. Returns false if invalid. strict: see findBlock()
+    bool dynamicHeader(bool strict) {
+        uint32_t hlit = this->getBits(5) + 257;
+        uint32_t hdist = this->getBits(5) + 1;
+        uint32_t hclen = this->getBits(4) + 4;
+        if ((hlit > 286) || (hdist > 30))
+            return false;
+        uint8_t clLen[19] = {0};
+        for (uint32_t ix = 0; ix < hclen; ++ix)
+            clLen[clOrder()[ix]] = (uint8_t)this->getBits(3);
+        uint32_t clEntry[19];
+        for (uint32_t ix = 0; ix < 19; ++ix)
+            clEntry[ix] = gzipDecoder::entry(ix, 0, huffmanTable::LITERAL);
+        if (!this->cl.build(clLen, 19, 7, clEntry))
+            return false;
+
+        // === literal/length + distance code lengths (one sequence) ===
+        uint8_t lengths[286 + 30];
+        uint32_t nLengths = 0;
+        while (nLengths < hlit + hdist) {
+            if (this->bitcnt < 16)
+                this->refill();
+            uint32_t e = this->cl.entries[this->bits(7)];
+            if (((e >> 8) & 0xF) == huffmanTable::INVALID)
+                return false;
+            this->consume(e & 0xFF);
+            uint32_t sym = e >> 16;
+            if (sym < 16) {
+                lengths[nLengths++] = (uint8_t)sym;
+                continue;
+            }
+            uint32_t rep;
+            uint8_t val = 0;
+            if (sym == 16) {
+                if (nLengths == 0)
+                    return false;
+                val = lengths[nLengths - 1];
+                rep = 3 + this->getBits(2);
+            } else if (sym == 17) {
+                rep = 3 + this->getBits(3);
+            } else {
+                rep = 11 + this->getBits(7);
+            }
+            if (nLengths + rep > hlit + hdist)
+                return false;
+            while (rep--)
+                lengths[nLengths++] = val;
+        }
+        if ((lengths[256] == 0) || this->overrun())
+            return false;
+        if (strict) {
+            if (kraftLeft(lengths, hlit) != 0)
+                return false;
+            int left = kraftLeft(lengths + hlit, hdist);
+            if ((left != 0) && (left != 1 << 14) && (left != 1 << 15))  // complete, a single code (length 1) or none
+                return false;
+        }
+        return this->dynLitlen.build(lengths, hlit, 10, this->litlenEntry) && this->dynDist.build(lengths + hlit, hdist, 9, this->distEntry);
+    }
+
+    //* decodes symbols up to end of block
+    void huffman(const huffmanTable &litlenTable, const huffmanTable &distTable) {
+        const uint32_t *litlen = litlenTable.entries.data();
+        const uint32_t litlenMask = (1u << litlenTable.primaryBits) - 1;
+        const uint32_t *dist = distTable.entries.data();
+        const uint32_t distMask = (1u << distTable.primaryBits) - 1;
+        uint16_t *out = this->out->data();
+        size_t outPos = this->nOut;
+        size_t outEnd = this->out->size();
+        //* output before the last refill, known to be decoded from data (not from zero padding)
+        size_t goodPos = outPos;
+
+        while (true) {
+            if (outPos + 258 + 4 > outEnd) {
+                this->nOut = outPos;
+                this->reserve(258 + 4);
+                out = this->out->data();
+                outEnd = this->out->size();
+            }
+            // 56 bits cover one complete length (15 + 5) / distance (15 + 13) pair
+            if (this->bitcnt < 48) {
+                if (this->overrun()) {
+                    this->nOut = goodPos;
+                    corrupt("truncated block");
+                }
+                goodPos = outPos;
+                this->refill();
+            }
+            uint32_t e = litlen[this->bitbuf & litlenMask];
+            uint32_t kind = (e >> 8) & 0xF;
+            if (kind == huffmanTable::SUBTABLE) {
+                this->consume(e & 0xFF);
+                e = litlen[(e >> 16) + this->bits((e >> 12) & 0xF)];
+                kind = (e >> 8) & 0xF;
+            }
+            this->consume(e & 0xFF);
+            if (kind == huffmanTable::LITERAL) {
+                out[outPos++] = (uint16_t)(e >> 16);
+                continue;
+            }
+            if (kind != huffmanTable::LENGTH) {
+                this->nOut = outPos;
+                if (this->overrun()) {
+                    this->nOut = goodPos;
+                    corrupt("truncated block");
+                }
+                if (kind == huffmanTable::END_OF_BLOCK)
+                    return;
+                corrupt("invalid literal/length code");
+            }
+            uint32_t extra = (e >> 12) & 0xF;
+            uint32_t len = (e >> 16) + this->bits(extra);
+            this->consume(extra);
+
+            uint32_t d = dist[this->bitbuf & distMask];
+            if (((d >> 8) & 0xF) == huffmanTable::SUBTABLE) {
+                this->consume(d & 0xFF);
+                d = dist[(d >> 16) + this->bits((d >> 12) & 0xF)];
+            }
+            if (((d >> 8) & 0xF) != huffmanTable::DISTANCE) {
+                this->nOut = outPos;
+                corrupt("invalid distance code");
+            }
+            this->consume(d & 0xFF);
+            extra = (d >> 12) & 0xF;
+            size_t distance = (d >> 16) + this->bits(extra);
+            this->consume(extra);
+
+            // === copy match (may overlap) ===
+            uint16_t *dst = out + outPos;
+            if (distance <= outPos) {
+                // === output has slack for 3 symbols overrun ===
+                const uint16_t *src = dst - distance;
+                if (distance >= 4) {
+                    uint16_t *end = dst + len;
+                    do {
+                        memcpy(dst, src, 8);
+                        dst += 4;
+                        src += 4;
+                    } while (dst < end);
+                } else {
+                    for (uint32_t ix = 0; ix < len; ++ix)
+                        dst[ix] = src[ix];
+                }
+            } else {
+                if (distance > outPos + windowSize) {
+                    this->nOut = outPos;
+                    corrupt("distance too far back");
+                }
+                // === starts in the unknown history: markers, then whatever the match has copied so far ===
+                for (uint32_t ix = 0; ix < len; ++ix) {
+                    size_t p = outPos + ix;
+                    dst[ix] = (p >= distance) ? out[p - distance] : (uint16_t)(marker + windowSize + p - distance);
+                }
+            }
+            outPos += len;
+        }
+    }
+
+    // === input ===
+    const unsigned char *data;
+    size_t n;
+    size_t bytePos = 0;
+    uint64_t bitbuf = 0;
+    unsigned int bitcnt = 0;
+
+    // === output ===
+    std::vector<uint16_t> *out = nullptr;
+    size_t nOut = 0;
+
+    // === tables ===
+    uint32_t litlenEntry[288];
+    uint32_t distEntry[32];
+    huffmanTable cl;
+    huffmanTable fixedLitlen;
+    huffmanTable fixedDist;
+    huffmanTable dynLitlen;
+    huffmanTable dynDist;
+};
+
+// ===========================
+// === parallelGzipDecoder ===
+// ===========================
+/** decodes gzip data held in memory (mapped file) on several threads, also a single member (one deflate stream, e.g. from gzip).
+ * The compressed data is cut into chunks of chunkSize bytes. For each chunk, a worker searches the first dynamic Huffman block header
+ * and decodes from there up to the first block header of the next chunk, without history (chunkInflater). The read() thread uses that
+ * result if the previous chunk ended exactly at its start bit. Otherwise (no block found, false positive, block spanning the chunk) it
+ * decodes the chunk itself from the known block boundary. Back-references to the previous chunk are then resolved and the CRC computed
+ * on worker threads again; CRC / ISIZE of each member are checked as with gzipDecoder. Data with fixed Huffman or stored blocks only
+ * ends up decoded sequentially. A chunk with an error (e.g. truncated file) is decoded by gzipDecoder up to it, so that the output is the
+ * same as from gzipDecoder (and zlib) */
+class parallelGzipDecoder {
+   public:
+    parallelGzipDecoder(const unsigned char *data, size_t n, unsigned int nThreads, size_t chunkSize = 1 << 20)
+        : data(data), n(n), nThreads(std::max(nThreads, 1u)), chunkSize(chunkSize), exact(data, n), window(windowSize) {
+    }
+
+    //* returns up to n decoded bytes. Returns 0 at end of data. Throws std::runtime_error on corrupt data, after all data before it */
+    size_t read(unsigned char *dest, size_t n) {
+        while (this->readPos == this->cur.size()) {
+            if (!this->error.empty()) {
+                std::string msg;
+                msg.swap(this->error);
+                throw std::runtime_error(msg);
+            }
+            if (!this->nextPiece())
+                return 0;
+        }
+        n = std::min(n, this->cur.size() - this->readPos);
+        memcpy(dest, this->cur.data() + this->readPos, n);
+        this->readPos += n;
+        return n;
+    }
+
+    //* compressed bytes decoded so far (read-ahead included)
+    uint64_t getInputPos() const {
+        return this->bitPos >> 3;
+    }
+
+   protected:
+    static const size_t windowSize = chunkInflater::windowSize;
+    //* consecutive speculation misses before probing only every probeInterval-th chunk
+    static const unsigned int maxMisses = 4;
+    static const uint64_t probeInterval = 16;
+    enum state_e {
+        MEMBER_HEADER,
+        BLOCKS,
+        DONE
+    };
+    //* decoded bytes of one chunk
+    struct resolved {
+        std::vector<unsigned char> data;
+        uint32_t crc = 0;
+        std::string error;
+    };
+    //* one chunk on its way to read(), in order
+    struct piece {
+        std::future<resolved> bytes;
+        //* the member ends after this chunk, with the trailer values below
+        bool memberEnd = false;
+        uint32_t crc = 0;
+        uint32_t isize = 0;
+        //* raised after the data of this chunk
+        std::string error;
+    };
+    //* speculative decoding of one chunk
+    struct job {
+        uint64_t chunk;
+        std::future<chunkInflater::result> result;
+    };
+
+    static void corrupt(const char *msg) {
+        throw std::runtime_error(std::string("corrupt gzip data: ") + msg);
+    }
+    static uint32_t le32(const unsigned char *p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    //* parses the member header at byte pos. Returns the position of the deflate stream
+    size_t memberHeader(size_t pos) {
+        const unsigned char *p = this->data;
+        if (pos + 10 > this->n)
+            corrupt("truncated header");
+        if ((p[pos] != 0x1f) || (p[pos + 1] != 0x8b))
+            corrupt("bad magic");
+        if (p[pos + 2] != 8)
+            corrupt("unknown compression method");
+        uint32_t flg = p[pos + 3];
+        pos += 10;  // MTIME, XFL, OS
+        if (flg & 4) {  // FEXTRA
+            if (pos + 2 > this->n)
+                corrupt("truncated header");
+            pos += 2 + ((size_t)p[pos] | ((size_t)p[pos + 1] << 8));
+        }
+        if (flg & 8) {  // FNAME
+            while ((pos < this->n) && p[pos])
+                ++pos;
+            ++pos;
+        }
+        if (flg & 16) {  // FCOMMENT
+            while ((pos < this->n) && p[pos])
+                ++pos;
+            ++pos;
+        }
+        if (flg & 2)  // FHCRC
+            pos += 2;
+        if (pos > this->n)
+            corrupt("truncated header");
+        return pos;
+    }
+
+    //* worker: first block of the chunk that decodes without error up to the next chunk (startBit ~0: none)
+    chunkInflater::result speculate(uint64_t chunk) {
+        chunkInflater::result r;
+        chunkInflater z(this->data, this->n);
+        uint64_t fromBit = 8 * chunk * this->chunkSize;
+        uint64_t stopBit = fromBit + 8 * this->chunkSize;
+        uint64_t startBit;
+        while (z.findBlock(fromBit, stopBit, startBit)) {
+            z.decode(startBit, stopBit, r);
+            if (r.error.empty())
+                return r;
+            fromBit = startBit + 1;
+        }
+        r.startBit = ~(uint64_t)0;
+        r.out.clear();
+        return r;
+    }
+
+    //* worker: converts symbols to bytes with the history before them, computes the CRC
+    static resolved resolveChunk(std::vector<uint16_t> sym, std::vector<unsigned char> history, size_t nValid) {
+        resolved r;
+        r.data.resize(sym.size());
+        size_t nResolved = chunkInflater::resolve(sym.data(), sym.size(), history.data(), nValid, r.data.data());
+        if (nResolved < sym.size()) {
+            r.data.resize(nResolved);
+            r.error = "corrupt gzip data: distance too far back";
+        }
+        r.crc = crc32::update(0, r.data.data(), r.data.size());
+        return r;
+    }
+
+    //* decodes sequentially from bitPos with the known history, up to the error (replaces "error" with gzipDecoder's)
+    resolved decodeTail(std::string &error) {
+        resolved r;
+        memoryInput src = {this->data + (this->bitPos >> 3), this->n - (size_t)(this->bitPos >> 3)};
+        gzipDecoder d(memoryInput::read, &src, /*gzip*/ false);
+        d.resume(this->window.data() + windowSize - this->nValid, this->nValid, (unsigned int)(this->bitPos & 7));
+        std::vector<unsigned char> buf(1 << 16);
+        try {
+            while (size_t nRead = d.read(buf.data(), buf.size()))
+                r.data.insert(r.data.end(), buf.data(), buf.data() + nRead);
+        } catch (std::runtime_error &e) {
+            error = e.what();
+        }
+        r.crc = crc32::update(0, r.data.data(), r.data.size());
+        return r;
+    }
+
+    //* decodes the chunk at bitPos, queues it as a piece
+    void step() {
+        piece p;
+        if (this->state == MEMBER_HEADER) {
+            try {
+                this->bitPos = 8 * (uint64_t)this->memberHeader((size_t)(this->bitPos >> 3));
+            } catch (std::runtime_error &e) {
+                p.error = e.what();
+                std::promise<resolved> none;
+                p.bytes = none.get_future();
+                none.set_value(resolved());
+                this->pieces.push_back(std::move(p));
+                this->state = DONE;
+                return;
+            }
+            this->nValid = 0;
+            this->state = BLOCKS;
+        }
+
+        // === keep nThreads chunks ahead in flight. After repeated misses (e.g. no dynamic blocks) only probe now and then ===
+        uint64_t chunk = this->bitPos / (8 * this->chunkSize);
+        this->nextChunk = std::max(this->nextChunk, chunk + 1);
+        for (; (this->nextChunk <= chunk + this->nThreads) && (this->nextChunk * this->chunkSize < this->n); ++this->nextChunk) {
+            if ((this->nMisses >= maxMisses) && (this->nextChunk % probeInterval != 0))
+                continue;
+            job j;
+            j.chunk = this->nextChunk;
+            j.result = std::async(std::launch::async, &parallelGzipDecoder::speculate, this, j.chunk);
+            this->jobs.push_back(std::move(j));
+        }
+
+        // === speculative result starting exactly here, or decode from here ===
+        chunkInflater::result r;
+        bool isSpeculative = false;
+        while (!this->jobs.empty() && (this->jobs.front().chunk <= chunk)) {
+            if (this->jobs.front().chunk == chunk) {
+                r = this->jobs.front().result.get();
+                isSpeculative = (r.startBit == this->bitPos);
+                this->nMisses = isSpeculative ? 0 : this->nMisses + 1;
+            }
+            this->jobs.pop_front();
+        }
+        if (!isSpeculative)
+            this->exact.decode(this->bitPos, 8 * (chunk + 1) * this->chunkSize, r);
+        if (!r.error.empty()) {
+            // === corrupt or truncated: gzipDecoder up to the error instead, for exactly the data of sequential decoding ===
+            std::string error = r.error;
+            std::promise<resolved> tail;
+            p.bytes = tail.get_future();
+            tail.set_value(this->decodeTail(error));
+            p.error = error;
+            this->pieces.push_back(std::move(p));
+            this->state = DONE;
+            return;
+        }
+
+        // === history for the next chunk (here), all bytes (worker) ===
+        size_t nSym = r.out.size();
+        size_t nTail = std::min(nSym, (size_t)windowSize);
+        std::vector<unsigned char> next(windowSize);
+        memcpy(next.data(), this->window.data() + nTail, windowSize - nTail);
+        bool isValid = chunkInflater::resolve(r.out.data() + nSym - nTail, nTail, this->window.data(), this->nValid, next.data() + windowSize - nTail) == nTail;
+        p.bytes = std::async(std::launch::async, &parallelGzipDecoder::resolveChunk, std::move(r.out), this->window, this->nValid);
+        this->window.swap(next);
+        this->nValid = std::min((size_t)windowSize, this->nValid + nSym);
+        this->bitPos = r.endBit;
+        p.error = r.error;
+        if (!p.error.empty() || !isValid) {
+            this->state = DONE;  // resolveChunk() reports an invalid reference
+        } else if (r.isFinal) {
+            // === member trailer. Another member follows? Trailing garbage is ignored (as gzip does) ===
+            size_t pos = (size_t)((this->bitPos + 7) >> 3);
+            if (pos + 8 > this->n) {
+                p.error = "corrupt gzip data: truncated file";
+                this->state = DONE;
+            } else {
+                p.memberEnd = true;
+                p.crc = le32(this->data + pos);
+                p.isize = le32(this->data + pos + 4);
+                pos += 8;
+                this->bitPos = 8 * (uint64_t)pos;
+                bool isMember = (pos + 2 <= this->n) && (this->data[pos] == 0x1f) && (this->data[pos + 1] == 0x8b);
+                this->state = isMember ? MEMBER_HEADER : DONE;
+            }
+        }
+        this->pieces.push_back(std::move(p));
+    }
+
+    //* makes the next piece current. Returns false at end of data
+    bool nextPiece() {
+        while ((this->pieces.size() <= this->nThreads) && (this->state != DONE))
+            this->step();
+        if (this->pieces.empty())
+            return false;
+        piece p = std::move(this->pieces.front());
+        this->pieces.pop_front();
+        resolved r = p.bytes.get();
+        this->cur.swap(r.data);
+        this->readPos = 0;
+        this->memberCrc = crc32::combine(this->memberCrc, r.crc, this->cur.size());
+        this->memberSize += (uint32_t)this->cur.size();
+        if (!r.error.empty())
+            this->error = r.error;
+        else if (!p.error.empty())
+            this->error = p.error;
+        else if (p.memberEnd) {
+            if (p.crc != this->memberCrc)
+                this->error = "corrupt gzip data: CRC mismatch";
+            else if (p.isize != this->memberSize)
+                this->error = "corrupt gzip data: length mismatch";
+            this->memberCrc = 0;
+            this->memberSize = 0;
+        }
+        if (!this->error.empty()) {
+            // === nothing after an error ===
+            this->state = DONE;
+            this->pieces.clear();
+        }
+        return true;
+    }
+
+    // === input ===
+    const unsigned char *data;
+    size_t n;
+    unsigned int nThreads;
+    size_t chunkSize;
+
+    // === decoding (read() thread) ===
+    state_e state = MEMBER_HEADER;
+    //* next block header (or member header) to decode
+    uint64_t bitPos = 0;
+    chunkInflater exact;
+    //* the windowSize bytes before bitPos, of which the last nValid belong to the current member
+    std::vector<unsigned char> window;
+    size_t nValid = 0;
+
+    // === output ===
+    std::vector<unsigned char> cur;
+    size_t readPos = 0;
+    uint32_t memberCrc = 0;
+    uint32_t memberSize = 0;
+    //* raised once cur is consumed
+    std::string error;
+
+    // === in flight (destroyed first: futures wait for their threads) ===
+    uint64_t nextChunk = 1;
+    unsigned int nMisses = 0;
+    std::deque<piece> pieces;
+    std::deque<job> jobs;
+};
+}  // namespace stdfooInflate
+#endif
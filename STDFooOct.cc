@@ -0,0 +1,222 @@
+// Octave accelerator for STDFoo.m: native access to the output folders of STDFoo.exe through STDFooReader.hpp (memory-mapped columns,
+// container.stdfoo, .blk and lossy columns). Build with "make STDFooOct.oct" (needs mkoctfile from the Octave development package) and put
+// STDFooOct.oct next to STDFoo.m, which uses it for folders opened with STDFoo(folder, 'oct'). Otherwise STDFoo.m runs its plain .m code with
+// the same results (exampleAndSelftest.m compares both).
+// Called by STDFoo.m, one function with the operation as first argument:
+//   STDFooOct('close', folder)                         forgets the folder (unmaps its files, e.g. before it is converted again)
+//   STDFooOct('column', folder, name, type [, index])  numeric column as double (like fread), e.g. name '1000.float', type 'float'
+//   STDFooOct('strings', folder, name)                 newline-terminated text file as cell column of strings
+//   STDFooOct('heap', folder, name [, index])          per-DUT strings of name.heap / name.offsets.uint64, e.g. name 'PART_ID'
+//   STDFooOct('bits', folder, name)                    bitmap of STDFoo.exe --bitmaps as logical column, one entry per DUT
+//   STDFooOct('fileIndex', folder [, index])           input file (base 1) of each DUT
+//   STDFooOct('indexInFile', folder [, index])         position (base 1) of each DUT in its input file
+//   STDFooOct('fileRuns', folder)                      one row [first DUT (base 1), number of DUTs] per input file
+// index: logical mask or DUT indices (base 1). Only the selected entries are converted. The file index is computed from the runs of DUTs per
+// file (dutsPerFile.uint32) for the selected DUTs only, without a table for all DUTs.
+#include <octave/oct.h>
+#include <octave/Cell.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "STDFooReader.hpp"
+
+using stdfooReader::outputFolder;
+using stdfooReader::span;
+
+// ================
+// === folders ===
+// ================
+//* open folders by name. Column maps stay valid until 'close' or until the oct-file is unloaded (clear STDFooOct)
+static std::map<std::string, std::unique_ptr<outputFolder>> &openFolders() {
+    static std::map<std::string, std::unique_ptr<outputFolder>> folders;
+    return folders;
+}
+
+static outputFolder &getFolder(const std::string &dirname) {
+    std::unique_ptr<outputFolder> &f = openFolders()[dirname];
+    if (!f)
+        f.reset(new outputFolder(dirname));
+    return *f;
+}
+
+// =================
+// === selection ===
+// =================
+/** DUT positions (base 0) selected by index (logical mask or index base 1) out of n. Empty octave_value: all */
+static std::vector<uint64_t> selection(const octave_value &index, uint64_t n) {
+    std::vector<uint64_t> retVal;
+    if (index.is_undefined()) {
+        retVal.resize((size_t)n);
+        for (uint64_t ix = 0; ix < n; ++ix)
+            retVal[(size_t)ix] = ix;
+    } else if (index.islogical()) {
+        boolNDArray mask = index.bool_array_value();
+        if ((uint64_t)mask.numel() > n)
+            error("STDFooOct: logical index exceeds %llu DUTs", (unsigned long long)n);
+        const bool *p = mask.data();
+        for (octave_idx_type ix = 0; ix < mask.numel(); ++ix)
+            if (p[ix])
+                retVal.push_back((uint64_t)ix);
+    } else {
+        NDArray ixs = index.array_value();
+        const double *p = ixs.data();
+        retVal.resize((size_t)ixs.numel());
+        for (octave_idx_type ix = 0; ix < ixs.numel(); ++ix) {
+            if (!(p[ix] >= 1) || !(p[ix] <= (double)n) || (p[ix] != (double)(uint64_t)p[ix]))
+                error("STDFooOct: index %g out of bound 1..%llu", p[ix], (unsigned long long)n);
+            retVal[(size_t)ix] = (uint64_t)p[ix] - 1;
+        }
+    }
+    return retVal;
+}
+
+// ==================
+// === operations ===
+// ==================
+//* entries sel of a column of T, as double
+template <class T>
+static ColumnVector gather(outputFolder &f, const std::string &name, const octave_value &index) {
+    span<T> col = f.column<T>(name);
+    std::vector<uint64_t> sel = selection(index, col.size());
+    ColumnVector retVal((octave_idx_type)sel.size());
+    double *dest = retVal.fortran_vec();
+    for (size_t ix = 0; ix < sel.size(); ++ix)
+        dest[ix] = (double)col[(size_t)sel[ix]];
+    return retVal;
+}
+
+static ColumnVector column(outputFolder &f, const std::string &name, const std::string &type, const octave_value &index) {
+    if ((type == "float") || (type == "single"))
+        return gather<float>(f, name, index);
+    if (type == "double")
+        return gather<double>(f, name, index);
+    if (type == "uint8")
+        return gather<uint8_t>(f, name, index);
+    if (type == "uint16")
+        return gather<uint16_t>(f, name, index);
+    if (type == "uint32")
+        return gather<uint32_t>(f, name, index);
+    if (type == "uint64")
+        return gather<uint64_t>(f, name, index);
+    error("STDFooOct: unsupported type \"%s\"", type.c_str());
+}
+
+static Cell strings(outputFolder &f, const std::string &name) {
+    span<uint8_t> bytes = f.column<uint8_t>(name);
+    const char *begin = (const char *)bytes.data();
+    const char *end = begin + bytes.size();
+    if ((begin != end) && (end[-1] != '\n'))
+        error("STDFooOct: expecting newline termination after last line of \"%s\"", name.c_str());
+    std::vector<std::string> lines;
+    for (const char *p = begin; p < end;) {
+        const char *eol = std::find(p, end, '\n');
+        lines.push_back(std::string(p, eol));
+        p = eol + 1;
+    }
+    Cell retVal(dim_vector((octave_idx_type)lines.size(), 1));
+    for (size_t ix = 0; ix < lines.size(); ++ix)
+        retVal((octave_idx_type)ix) = lines[ix];
+    return retVal;
+}
+
+//* entry of each selected DUT: length byte, then the characters (see README, PART_ID.heap)
+static Cell heap(outputFolder &f, const std::string &name, const octave_value &index) {
+    span<uint8_t> h = f.column<uint8_t>(name + ".heap");
+    span<uint64_t> offsets = f.column<uint64_t>(name + ".offsets.uint64");
+    std::vector<uint64_t> sel = selection(index, offsets.size());
+    Cell retVal(dim_vector((octave_idx_type)sel.size(), 1));
+    for (size_t ix = 0; ix < sel.size(); ++ix) {
+        uint64_t pos = offsets[(size_t)sel[ix]];
+        if ((pos >= h.size()) || (h[(size_t)pos] > h.size() - pos - 1))
+            error("STDFooOct: corrupt %s.heap", name.c_str());
+        retVal((octave_idx_type)ix) = std::string((const char *)h.data() + pos + 1, h[(size_t)pos]);
+    }
+    return retVal;
+}
+
+static boolNDArray bits(outputFolder &f, const std::string &name) {
+    const uint64_t n = f.nDuts();
+    span<uint8_t> bytes = f.column<uint8_t>(name);
+    boolNDArray retVal(dim_vector((octave_idx_type)n, 1), false);
+    bool *dest = retVal.fortran_vec();
+    const uint64_t nBits = std::min(n, (uint64_t)bytes.size() * 8);
+    for (uint64_t ix = 0; ix < nBits; ++ix)
+        dest[ix] = (bytes[(size_t)(ix / 8)] >> (ix % 8)) & 1;  // least significant bit first
+    return retVal;
+}
+
+/** input file (base 1) or position in the file (base 1) of the selected DUTs. One binary search per DUT in the cumulative DUT counts, in
+ * place of a table for all DUTs */
+static ColumnVector fileIndex(outputFolder &f, const octave_value &index, bool isPosInFile) {
+    span<uint32_t> duts = f.dutsPerFile();
+    std::vector<uint64_t> firstDut(1, 0);
+    for (size_t ix = 0; ix < duts.size(); ++ix)
+        firstDut.push_back(firstDut.back() + duts[ix]);
+    std::vector<uint64_t> sel = selection(index, f.nDuts());
+    ColumnVector retVal((octave_idx_type)sel.size());
+    double *dest = retVal.fortran_vec();
+    size_t ixFile = 0;
+    for (size_t ix = 0; ix < sel.size(); ++ix) {
+        // ascending selection: the file of the previous DUT, or a later one
+        if ((sel[ix] < firstDut[ixFile]) || (sel[ix] >= firstDut[ixFile + 1]))
+            ixFile = (size_t)(std::upper_bound(firstDut.begin(), firstDut.end(), sel[ix]) - firstDut.begin()) - 1;
+        while (firstDut[ixFile + 1] == firstDut[ixFile])
+            ++ixFile;  // file without DUTs
+        dest[ix] = isPosInFile ? (double)(sel[ix] - firstDut[ixFile] + 1) : (double)(ixFile + 1);
+    }
+    return retVal;
+}
+
+//* DUTs of each input file as run: first DUT (base 1) and count. The DUTs of a file are contiguous, so no per-DUT mask is needed
+static Matrix fileRuns(outputFolder &f) {
+    span<uint32_t> duts = f.dutsPerFile();
+    Matrix retVal((octave_idx_type)duts.size(), 2);
+    uint64_t first = 0;
+    for (size_t ix = 0; ix < duts.size(); ++ix) {
+        retVal((octave_idx_type)ix, 0) = (double)(first + 1);
+        retVal((octave_idx_type)ix, 1) = (double)duts[ix];
+        first += duts[ix];
+    }
+    return retVal;
+}
+
+// ==============
+// === DEFUN ===
+// ==============
+DEFUN_DLD(STDFooOct, args, /*nargout*/, "-*- texinfo -*-\n@deftypefn {} {@var{r} =} STDFooOct (@var{op}, @var{folder}, ...)\nNative column access for STDFoo.m (see STDFooOct.cc)\n@end deftypefn") {
+    const int nArgs = args.length();
+    if ((nArgs < 2) || !args(0).is_string() || !args(1).is_string())
+        print_usage();
+    const std::string op = args(0).string_value();
+    const std::string dirname = args(1).string_value();
+    // optional argument ix (missing: undefined)
+    auto optArg = [&args, nArgs](int ix) { return (ix < nArgs) ? args(ix) : octave_value(); };
+    try {
+        if (op == "close") {
+            openFolders().erase(dirname);
+            return octave_value_list();
+        }
+        outputFolder &f = getFolder(dirname);
+        if ((op == "column") && (nArgs >= 4))
+            return octave_value(column(f, args(2).string_value(), args(3).string_value(), optArg(4)));
+        if ((op == "strings") && (nArgs == 3))
+            return octave_value(strings(f, args(2).string_value()));
+        if ((op == "heap") && (nArgs >= 3))
+            return octave_value(heap(f, args(2).string_value(), optArg(3)));
+        if ((op == "bits") && (nArgs == 3))
+            return octave_value(bits(f, args(2).string_value()));
+        if (op == "fileIndex")
+            return octave_value(fileIndex(f, optArg(2), false));
+        if (op == "indexInFile")
+            return octave_value(fileIndex(f, optArg(2), true));
+        if ((op == "fileRuns") && (nArgs == 2))
+            return octave_value(fileRuns(f));
+    } catch (const std::exception &e) {
+        error("STDFooOct: %s", e.what());
+    }
+    error("STDFooOct: unknown operation \"%s\" or wrong number of arguments", op.c_str());
+}
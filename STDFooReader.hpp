@@ -0,0 +1,1273 @@
+// Header-only C++ reader for STDFoo output folders. No library dependencies beyond STDFooCodec.hpp (same folder).
+// - outputFolder: memory-maps the column files (or container.stdfoo) and exposes them as typed spans: results per test, bins, site, file index.
+//   Block-encoded (--compress) and 16-bit (--lossy) columns are decoded to memory once, on first use. Columns stay valid while the folder is open.
+//   block() / release() stream any column in ranges of DUTs instead, with bounded memory (STDFoo.exe whatif)
+// - bitmask: one bit per DUT in 64-bit words, least significant bit first (the layout of (num).fail.bits / (num).tested.bits)
+// - kernels: range check, NaN, compare, mask AND / OR / AND NOT and popcount. AVX2 or SSE2 when enabled at compile time (e.g. -mavx2 or
+//   -march=native), scalar otherwise
+// - threadPool, passMask(), failCounts(): multi-column queries in chunks of DUTs, one task per chunk, so that page faults (disk reads) of the
+//   mapped columns overlap
+// Errors throw std::runtime_error. See examples/example1.cpp.
+#ifndef STDFOO_READER_HPP
+#define STDFOO_READER_HPP
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>  // memcpy
+#include <fstream>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "STDFooCodec.hpp"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>  // preadv
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace stdfooReader {
+
+// ===============
+// === kernels ===
+// ===============
+/** bit operations on DUT columns. Masks are arrays of 64-bit words, DUT k is bit k % 64 of word k / 64. Output words are complete: bits
+ * beyond n are zero */
+class kernels {
+   public:
+    //* sets bit k where lo <= v[k] <= hi. NaN sets the bit if nanPasses
+    static void inRange(const float *v, size_t n, float lo, float hi, bool nanPasses, uint64_t *dest) {
+        size_t ix = 0;
+#if defined(__AVX2__)
+        const __m256 vLo = _mm256_set1_ps(lo);
+        const __m256 vHi = _mm256_set1_ps(hi);
+        for (; ix + 64 <= n; ix += 64) {
+            uint64_t w = 0;
+            for (unsigned int k = 0; k < 8; ++k) {
+                __m256 x = _mm256_loadu_ps(v + ix + 8 * k);
+                __m256 m = _mm256_and_ps(_mm256_cmp_ps(vLo, x, _CMP_LE_OQ), _mm256_cmp_ps(x, vHi, _CMP_LE_OQ));
+                if (nanPasses)
+                    m = _mm256_or_ps(m, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+                w |= (uint64_t)(unsigned int)_mm256_movemask_ps(m) << (8 * k);
+            }
+            dest[ix / 64] = w;
+        }
+#elif defined(__SSE2__)
+        const __m128 vLo = _mm_set1_ps(lo);
+        const __m128 vHi = _mm_set1_ps(hi);
+        for (; ix + 64 <= n; ix += 64) {
+            uint64_t w = 0;
+            for (unsigned int k = 0; k < 16; ++k) {
+                __m128 x = _mm_loadu_ps(v + ix + 4 * k);
+                __m128 m = _mm_and_ps(_mm_cmple_ps(vLo, x), _mm_cmple_ps(x, vHi));
+                if (nanPasses)
+                    m = _mm_or_ps(m, _mm_cmpunord_ps(x, x));
+                w |= (uint64_t)(unsigned int)_mm_movemask_ps(m) << (4 * k);
+            }
+            dest[ix / 64] = w;
+        }
+#endif
+        // === remaining values, partial last word ===
+        for (; ix < n; ix += 64) {
+            uint64_t w = 0;
+            for (size_t k = 0; (k < 64) && (ix + k < n); ++k) {
+                float x = v[ix + k];
+                bool isSet = std::isnan(x) ? nanPasses : ((lo <= x) && (x <= hi));
+                w |= (uint64_t)isSet << k;
+            }
+            dest[ix / 64] = w;
+        }
+    }
+
+    //* sets bit k where v[k] is NaN (missing result)
+    static void isNan(const float *v, size_t n, uint64_t *dest) {
+        // empty range: only NaN passes
+        inRange(v, n, INFINITY, -INFINITY, true, dest);
+    }
+
+    //* sets bit k where v[k] == val (e.g. bin or site)
+    template <class T>
+    static void equal(const T *v, size_t n, T val, uint64_t *dest) {
+        size_t ix = 0;
+#if defined(__SSE2__)
+        ix = equalSse2(v, n, val, dest);
+#endif
+        for (; ix < n; ix += 64) {
+            uint64_t w = 0;
+            for (size_t k = 0; (k < 64) && (ix + k < n); ++k)
+                w |= (uint64_t)(v[ix + k] == val) << k;
+            dest[ix / 64] = w;
+        }
+    }
+
+    //* dest &= src
+    static void andInto(uint64_t *dest, const uint64_t *src, size_t nWords) {
+        size_t ix = 0;
+#if defined(__AVX2__)
+        for (; ix + 4 <= nWords; ix += 4)
+            _mm256_storeu_si256((__m256i *)(dest + ix), _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(dest + ix)), _mm256_loadu_si256((const __m256i *)(src + ix))));
+#elif defined(__SSE2__)
+        for (; ix + 2 <= nWords; ix += 2)
+            _mm_storeu_si128((__m128i *)(dest + ix), _mm_and_si128(_mm_loadu_si128((const __m128i *)(dest + ix)), _mm_loadu_si128((const __m128i *)(src + ix))));
+#endif
+        for (; ix < nWords; ++ix)
+            dest[ix] &= src[ix];
+    }
+
+    //* dest |= src
+    static void orInto(uint64_t *dest, const uint64_t *src, size_t nWords) {
+        size_t ix = 0;
+#if defined(__AVX2__)
+        for (; ix + 4 <= nWords; ix += 4)
+            _mm256_storeu_si256((__m256i *)(dest + ix), _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(dest + ix)), _mm256_loadu_si256((const __m256i *)(src + ix))));
+#elif defined(__SSE2__)
+        for (; ix + 2 <= nWords; ix += 2)
+            _mm_storeu_si128((__m128i *)(dest + ix), _mm_or_si128(_mm_loadu_si128((const __m128i *)(dest + ix)), _mm_loadu_si128((const __m128i *)(src + ix))));
+#endif
+        for (; ix < nWords; ++ix)
+            dest[ix] |= src[ix];
+    }
+
+    //* dest &= ~src
+    static void andNotInto(uint64_t *dest, const uint64_t *src, size_t nWords) {
+        size_t ix = 0;
+#if defined(__AVX2__)
+        for (; ix + 4 <= nWords; ix += 4)
+            _mm256_storeu_si256((__m256i *)(dest + ix), _mm256_andnot_si256(_mm256_loadu_si256((const __m256i *)(src + ix)), _mm256_loadu_si256((const __m256i *)(dest + ix))));
+#elif defined(__SSE2__)
+        for (; ix + 2 <= nWords; ix += 2)
+            _mm_storeu_si128((__m128i *)(dest + ix), _mm_andnot_si128(_mm_loadu_si128((const __m128i *)(src + ix)), _mm_loadu_si128((const __m128i *)(dest + ix))));
+#endif
+        for (; ix < nWords; ++ix)
+            dest[ix] &= ~src[ix];
+    }
+
+    //* number of set bits
+    static uint64_t popcount(const uint64_t *src, size_t nWords) {
+        size_t ix = 0;
+        uint64_t retVal = 0;
+#if defined(__AVX2__)
+        // === nibble lookup per byte, summed per 64-bit lane (no popcnt instruction needed) ===
+        const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i acc = zero;
+        for (; ix + 4 <= nWords; ix += 4) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(src + ix));
+            __m256i lo = _mm256_and_si256(v, lowNibble);
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble);
+            __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, zero));
+        }
+        uint64_t lanes[4];
+        _mm256_storeu_si256((__m256i *)lanes, acc);
+        retVal = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+        for (; ix < nWords; ++ix)
+            retVal += popcount64(src[ix]);
+        return retVal;
+    }
+
+    static unsigned int popcount64(uint64_t w) {
+#if defined(__GNUC__)
+        return (unsigned int)__builtin_popcountll(w);
+#else
+        w = w - ((w >> 1) & 0x5555555555555555ULL);
+        w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+        w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (unsigned int)((w * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+   protected:
+#if defined(__SSE2__)
+    //* full words of equal(). Returns the number of values done
+    static size_t equalSse2(const uint8_t *v, size_t n, uint8_t val, uint64_t *dest) {
+        const __m128i x = _mm_set1_epi8((char)val);
+        size_t ix = 0;
+        for (; ix + 64 <= n; ix += 64) {
+            uint64_t w = 0;
+            for (unsigned int k = 0; k < 4; ++k)
+                w |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(v + ix + 16 * k)), x)) << (16 * k);
+            dest[ix / 64] = w;
+        }
+        return ix;
+    }
+    static size_t equalSse2(const uint16_t *v, size_t n, uint16_t val, uint64_t *dest) {
+        const __m128i x = _mm_set1_epi16((short)val);
+        size_t ix = 0;
+        for (; ix + 64 <= n; ix += 64) {
+            uint64_t w = 0;
+            for (unsigned int k = 0; k < 4; ++k) {
+                __m128i a = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)(v + ix + 16 * k)), x);
+                __m128i b = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)(v + ix + 16 * k + 8)), x);
+                w |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_packs_epi16(a, b)) << (16 * k);
+            }
+            dest[ix / 64] = w;
+        }
+        return ix;
+    }
+    //* other types: scalar
+    template <class T>
+    static size_t equalSse2(const T * /*v*/, size_t /*n*/, T /*val*/, uint64_t * /*dest*/) {
+        return 0;
+    }
+#endif
+};
+
+// ===============
+// === bitmask ===
+// ===============
+//* one bit per DUT, see kernels. Bits beyond size() are always zero
+class bitmask {
+   public:
+    bitmask() : words(), nBits(0) {
+    }
+
+    explicit bitmask(size_t nBits, bool val = false) : words((nBits + 63) / 64, val ? ~(uint64_t)0 : 0), nBits(nBits) {
+        this->clearTail();
+    }
+
+    //* from the bytes of a .bits file (STDFoo.exe --bitmaps)
+    static bitmask fromBytes(const unsigned char *src, size_t nBytes, size_t nBits) {
+        bitmask retVal(nBits);
+        memcpy(retVal.words.data(), src, std::min(nBytes, retVal.words.size() * sizeof(uint64_t)));
+        retVal.clearTail();
+        return retVal;
+    }
+
+    size_t size() const {
+        return this->nBits;
+    }
+    size_t nWords() const {
+        return this->words.size();
+    }
+    uint64_t *data() {
+        return this->words.data();
+    }
+    const uint64_t *data() const {
+        return this->words.data();
+    }
+
+    bool get(size_t ix) const {
+        return (this->words[ix / 64] >> (ix % 64)) & 1;
+    }
+
+    void set(size_t ix, bool val = true) {
+        uint64_t bit = (uint64_t)1 << (ix % 64);
+        this->words[ix / 64] = val ? (this->words[ix / 64] | bit) : (this->words[ix / 64] & ~bit);
+    }
+
+    //* sets bits first..first+n-1
+    void setRange(size_t first, size_t n) {
+        for (size_t ix = first; ix < first + n;) {
+            if ((ix % 64 == 0) && (ix + 64 <= first + n)) {
+                this->words[ix / 64] = ~(uint64_t)0;
+                ix += 64;
+            } else {
+                this->set(ix++);
+            }
+        }
+    }
+
+    //* number of set bits
+    uint64_t count() const {
+        return kernels::popcount(this->words.data(), this->words.size());
+    }
+
+    //* positions of the set bits, ascending
+    std::vector<size_t> indices() const {
+        std::vector<size_t> retVal;
+        for (size_t ixWord = 0; ixWord < this->words.size(); ++ixWord)
+            for (uint64_t w = this->words[ixWord]; w; w &= w - 1)
+                retVal.push_back(64 * ixWord + lowestBit(w));
+        return retVal;
+    }
+
+    bitmask &operator&=(const bitmask &other) {
+        this->check(other);
+        kernels::andInto(this->words.data(), other.words.data(), this->words.size());
+        return *this;
+    }
+    bitmask &operator|=(const bitmask &other) {
+        this->check(other);
+        kernels::orInto(this->words.data(), other.words.data(), this->words.size());
+        return *this;
+    }
+    //* clears the bits that are set in other
+    bitmask &andNot(const bitmask &other) {
+        this->check(other);
+        kernels::andNotInto(this->words.data(), other.words.data(), this->words.size());
+        return *this;
+    }
+    //* inverts all bits
+    bitmask &flip() {
+        for (size_t ix = 0; ix < this->words.size(); ++ix)
+            this->words[ix] = ~this->words[ix];
+        this->clearTail();
+        return *this;
+    }
+
+   protected:
+    void clearTail() {
+        if (this->nBits % 64)
+            this->words.back() &= ((uint64_t)1 << (this->nBits % 64)) - 1;
+    }
+    void check(const bitmask &other) const {
+        if (other.nBits != this->nBits)
+            throw std::runtime_error("bitmask: size mismatch");
+    }
+    static unsigned int lowestBit(uint64_t w) {
+#if defined(__GNUC__)
+        return (unsigned int)__builtin_ctzll(w);
+#else
+        return kernels::popcount64((w & (0 - w)) - 1);
+#endif
+    }
+    std::vector<uint64_t> words;
+    size_t nBits;
+};
+
+// ============
+// === span ===
+// ============
+//* read-only view of n elements of T
+template <class T>
+class span {
+   public:
+    span() : p(NULL), n(0) {
+    }
+    span(const T *p, size_t n) : p(p), n(n) {
+    }
+    const T *data() const {
+        return this->p;
+    }
+    size_t size() const {
+        return this->n;
+    }
+    bool empty() const {
+        return this->n == 0;
+    }
+    const T &operator[](size_t ix) const {
+        return this->p[ix];
+    }
+    const T *begin() const {
+        return this->p;
+    }
+    const T *end() const {
+        return this->p + this->n;
+    }
+    //* elements first..first+n-1 (clipped to the end)
+    span subspan(size_t first, size_t n) const {
+        first = std::min(first, this->n);
+        return span(this->p + first, std::min(n, this->n - first));
+    }
+
+   protected:
+    const T *p;
+    size_t n;
+};
+
+// ==================
+// === mappedFile ===
+// ==================
+/** read-only contents of a file: memory-mapped (POSIX), otherwise (Windows, e.g. a pipe, or mmap failed) read into memory. The data is
+ * aligned to at least 8 bytes */
+class mappedFile {
+   public:
+    explicit mappedFile(const std::string &fname) : p(NULL), n(0), isMapped(false), buf() {
+#ifndef _WIN32
+        int fd = open(fname.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("failed to open " + fname);
+        struct stat st;
+        if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0)) {
+            void *m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m != MAP_FAILED) {
+                this->p = (const unsigned char *)m;
+                this->n = (size_t)st.st_size;
+                this->isMapped = true;
+            }
+        }
+        close(fd);  // mapping remains valid
+#endif
+        if (!this->isMapped)
+            this->readAll(fname);
+    }
+
+    ~mappedFile() {
+#ifndef _WIN32
+        if (this->isMapped)
+            munmap((void *)this->p, this->n);
+#endif
+    }
+
+    const unsigned char *data() const {
+        return this->p;
+    }
+    size_t size() const {
+        return this->n;
+    }
+
+    //* drops the mapped pages of nBytes at ptr (inside the file) from memory. They are read again on the next access
+    void release(const unsigned char *ptr, size_t nBytes) const {
+#ifndef _WIN32
+        if (!this->isMapped || (nBytes == 0))
+            return;
+        const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+        uintptr_t start = std::max((uintptr_t)ptr, (uintptr_t)this->p) / pageSize * pageSize;
+        uintptr_t end = std::min((uintptr_t)(ptr + nBytes), (uintptr_t)(this->p + this->n));
+        if (end > start)
+            madvise((void *)start, end - start, MADV_DONTNEED);
+#else
+        (void)ptr;
+        (void)nBytes;
+#endif
+    }
+
+   protected:
+    mappedFile(const mappedFile &) = delete;
+    mappedFile &operator=(const mappedFile &) = delete;
+
+    void readAll(const std::string &fname) {
+        std::ifstream is(fname, std::ifstream::binary);
+        if (!is)
+            throw std::runtime_error("failed to open " + fname);
+        std::ostringstream all;
+        all << is.rdbuf();
+        const std::string s = all.str();
+        this->buf.resize((s.size() + 7) / 8);
+        if (!s.empty())
+            memcpy(this->buf.data(), s.data(), s.size());
+        this->p = (const unsigned char *)this->buf.data();
+        this->n = s.size();
+    }
+
+    const unsigned char *p;
+    size_t n;
+    bool isMapped;
+    //* contents if not mapped (uint64_t for alignment)
+    std::vector<uint64_t> buf;
+};
+
+// ==================
+// === threadPool ===
+// ==================
+//* fixed number of worker threads running submitted tasks in order of submission
+class threadPool {
+   public:
+    //* nThreads == 0: one per CPU core
+    explicit threadPool(unsigned int nThreads = 0) : workers(), tasks(), m(), cv(), isShutdown(false) {
+        if (nThreads == 0)
+            nThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int ix = 0; ix < nThreads; ++ix)
+            this->workers.push_back(std::thread([this] { this->run(); }));
+    }
+
+    ~threadPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            this->isShutdown = true;
+        }
+        this->cv.notify_all();
+        for (auto it = this->workers.begin(); it != this->workers.end(); ++it)
+            it->join();
+    }
+
+    size_t size() const {
+        return this->workers.size();
+    }
+
+    //* queues f(). The future returns its result, or rethrows its exception
+    template <class F>
+    auto submit(F f) -> std::future<decltype(f())> {
+        auto task = std::make_shared<std::packaged_task<decltype(f())()>>(f);
+        std::future<decltype(f())> retVal = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            this->tasks.push([task] { (*task)(); });
+        }
+        this->cv.notify_one();
+        return retVal;
+    }
+
+   protected:
+    threadPool(const threadPool &) = delete;
+    threadPool &operator=(const threadPool &) = delete;
+
+    void run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(this->m);
+                this->cv.wait(lock, [this] { return this->isShutdown || !this->tasks.empty(); });
+                if (this->tasks.empty())
+                    return;  // shutdown, all tasks done
+                task = std::move(this->tasks.front());
+                this->tasks.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex m;
+    std::condition_variable cv;
+    bool isShutdown;
+};
+
+// ====================
+// === outputFolder ===
+// ====================
+/** an output folder of STDFoo.exe (also with --container, --compress, --lossy). Column access is thread-safe. Spans remain valid while the
+ * outputFolder exists */
+class outputFolder {
+   public:
+    explicit outputFolder(const std::string &dirname) : dirname(dirname), container(), manifest(), lossy(), columns(), streams(), m(), nDutsTotal(0) {
+        std::ifstream probe(dirname + "/container.stdfoo", std::ifstream::binary);
+        if (probe.good())
+            this->openContainer();
+        if (this->hasFile("lossy.txt"))
+            this->readLossy();
+        span<uint32_t> duts = this->dutsPerFile();
+        for (size_t ix = 0; ix < duts.size(); ++ix)
+            this->nDutsTotal += duts[ix];
+    }
+
+    const std::string &getDirname() const {
+        return this->dirname;
+    }
+
+    //* number of DUTs (length of all per-DUT columns)
+    uint64_t nDuts() const {
+        return this->nDutsTotal;
+    }
+
+    // === per test, ascending TEST_NUM ===
+    span<uint32_t> testnums() {
+        return this->column<uint32_t>("testnums.uint32");
+    }
+    span<float> lowLim() {
+        return this->column<float>("lowLim.float");
+    }
+    span<float> highLim() {
+        return this->column<float>("highLim.float");
+    }
+    span<uint32_t> mprTestnums() {
+        return this->column<uint32_t>("mprTestnums.uint32");
+    }
+    span<uint32_t> mprPins() {
+        return this->column<uint32_t>("mprPins.uint32");
+    }
+
+    // === per file, command line order ===
+    span<uint32_t> dutsPerFile() {
+        return this->column<uint32_t>("dutsPerFile.uint32");
+    }
+
+    // === per DUT ===
+    //* PTR results of testnum. Empty if the test has no results (e.g. no PRR after its first PTR)
+    span<float> result(uint32_t testnum) {
+        return this->column<float>(std::to_string(testnum) + ".float", true);
+    }
+    //* MPR results of testnum, pin (base 0)
+    span<float> mprResult(uint32_t testnum, uint32_t pin) {
+        return this->column<float>(std::to_string(testnum) + "_" + std::to_string(pin) + ".float", true);
+    }
+    span<uint16_t> hardbin() {
+        return this->column<uint16_t>("hardbin.uint16");
+    }
+    span<uint16_t> softbin() {
+        return this->column<uint16_t>("softbin.uint16");
+    }
+    span<uint8_t> site() {
+        return this->column<uint8_t>("site.uint8");
+    }
+    //* index (base 0) of the input file of each DUT, in the order of files.txt
+    span<uint32_t> fileIndex() {
+        span<uint32_t> duts = this->dutsPerFile();
+        std::lock_guard<std::mutex> lock(this->m);
+        std::shared_ptr<column_t> &c = this->columns["#fileIndex"];
+        if (!c) {
+            c = std::make_shared<column_t>();
+            c->owned.resize((size_t)(this->nDutsTotal + 1) / 2);
+            uint32_t *dest = (uint32_t *)c->owned.data();
+            for (uint32_t ixFile = 0; ixFile < duts.size(); ++ixFile)
+                dest = std::fill_n(dest, duts[ixFile], ixFile);
+            c->p = (const unsigned char *)c->owned.data();
+            c->n = (size_t)this->nDutsTotal * sizeof(uint32_t);
+        }
+        return span<uint32_t>((const uint32_t *)c->p, c->n / sizeof(uint32_t));
+    }
+    //* DUTs of input file ixFile (base 0)
+    bitmask fileMask(size_t ixFile) {
+        span<uint32_t> duts = this->dutsPerFile();
+        uint64_t first = 0;
+        for (size_t ix = 0; ix < ixFile; ++ix)
+            first += duts[ix];
+        bitmask retVal((size_t)this->nDutsTotal);
+        if (ixFile < duts.size())
+            retVal.setRange((size_t)first, duts[ixFile]);
+        return retVal;
+    }
+    //* fail bitmap of testnum (STDFoo.exe --bitmaps): the tester flagged the result as failed
+    bitmask failed(uint32_t testnum) {
+        return this->bits(testnum, "fail");
+    }
+    //* tested bitmap of testnum (STDFoo.exe --bitmaps)
+    bitmask tested(uint32_t testnum) {
+        return this->bits(testnum, "tested");
+    }
+
+    /** values first..first+n-1 of column name, for a pass over all DUTs in blocks with bounded memory (plain, container, .blk and lossy
+     * columns; .blk and lossy columns are decoded block by block). Returns a pointer into the mapped file, or scratch (room for n values) if
+     * decoding is needed. nValid: number of values that exist (less than n at the end of the column, 0 if the column is missing) */
+    template <class T>
+    const T *block(const std::string &name, uint64_t first, size_t n, T *scratch, size_t &nValid) {
+        std::shared_ptr<stream_t> st = this->stream<T>(name);
+        nValid = (first < st->nValues) ? (size_t)std::min((uint64_t)n, st->nValues - first) : 0;
+        if (nValid == 0)
+            return scratch;
+        switch (st->encoding) {
+            case ENC_RAW:
+                return (const T *)st->p + first;
+            case ENC_BLK:
+                this->decodeBlocks(*st, first, nValid, scratch);
+                return scratch;
+            default: {
+                uint16_t q[stdfooCodec::blockLen];
+                for (size_t ix = 0; ix < nValid; ix += stdfooCodec::blockLen) {
+                    size_t nq = std::min(nValid - ix, (size_t)stdfooCodec::blockLen);
+                    memcpy(q, st->p + 2 * (first + ix), nq * sizeof(uint16_t));
+                    for (size_t k = 0; k < nq; ++k)
+                        scratch[ix + k] = (T)((st->encoding == ENC_HALF) ? halfToFloat(q[k]) : (q[k] == 65535) ? NAN : st->offset + st->scale * q[k]);
+                }
+                return scratch;
+            }
+        }
+    }
+
+    /** values of column name at positions ix[0..n-1] (base 0, strictly ascending) into dest[0..n-1]. Positions past the end of the column
+     * (or all, if it is missing) get fill. Plain files and container regions are read with preadv, not mapped: positions less than
+     * gatherGapBytes apart share one call, with the bytes between them read into a discard buffer. .blk and lossy columns decode only the
+     * blocks that hold positions */
+    template <class T>
+    void gather(const std::string &name, const uint64_t *ix, size_t n, T *dest, T fill) {
+        for (size_t k = 1; k < n; ++k)
+            if (ix[k] <= ix[k - 1])
+                throw std::invalid_argument("gather: positions must be strictly ascending");
+        std::string fname;
+        uint64_t offset = 0;
+        uint64_t nBytes = 0;
+        size_t k = 0;
+        if (this->locateRaw(name, fname, offset, nBytes)) {
+            k = (size_t)(std::lower_bound(ix, ix + n, nBytes / sizeof(T)) - ix);
+            gatherRaw(fname, offset, ix, k, dest);
+        } else {
+            T tmp[stdfooCodec::blockLen];
+            const uint64_t nValues = this->stream<T>(name)->nValues;
+            while ((k < n) && (ix[k] < nValues)) {
+                const uint64_t first = ix[k] / stdfooCodec::blockLen * stdfooCodec::blockLen;
+                size_t nValid = 0;
+                const T *b = this->block<T>(name, first, stdfooCodec::blockLen, tmp, nValid);
+                for (; (k < n) && (ix[k] < first + nValid); ++k)
+                    dest[k] = b[ix[k] - first];
+            }
+        }
+        std::fill(dest + k, dest + n, fill);
+    }
+
+    //* drops the data of block(name, first, n) from memory, once processed
+    void release(const std::string &name, uint64_t first, size_t n) {
+        std::shared_ptr<stream_t> st;
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            std::map<std::string, std::shared_ptr<stream_t>>::const_iterator it = this->streams.find(name);
+            if (it != this->streams.end())
+                st = it->second;
+        }
+        if (!st || (first >= st->nValues))
+            return;
+        uint64_t last = std::min(first + n, st->nValues);  // exclusive
+        if (st->encoding == ENC_BLK)
+            st->file->release(st->p + st->offsets[first / stdfooCodec::blockLen], (size_t)(st->offsets[(last + stdfooCodec::blockLen - 1) / stdfooCodec::blockLen] - st->offsets[first / stdfooCodec::blockLen]));
+        else if (st->encoding != ENC_MISSING)
+            st->file->release(st->p + first * st->elemSize, (size_t)((last - first) * st->elemSize));
+    }
+
+    //* whether column name exists (plain file, container region, .blk or lossy column)
+    bool hasColumn(const std::string &name) const {
+        return this->hasFile(name) || this->hasFile(name + ".blk") || this->lossy.count(name);
+    }
+
+    /** any column by file name e.g. "1000.float", "stats.mean.double". Plain files and container regions are mapped, .blk and lossy columns
+     * are decoded. isOptional: returns an empty span if the column does not exist */
+    template <class T>
+    span<T> column(const std::string &name, bool isOptional = false) {
+        std::shared_ptr<column_t> c;
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            std::map<std::string, std::shared_ptr<column_t>>::const_iterator it = this->columns.find(name);
+            if (it != this->columns.end())
+                c = it->second;
+        }
+        if (!c) {
+            // loaded outside the lock, so that several columns are decoded in parallel. The first one stored wins
+            std::shared_ptr<column_t> loaded = this->load<T>(name);
+            std::lock_guard<std::mutex> lock(this->m);
+            std::shared_ptr<column_t> &entry = this->columns[name];
+            if (!entry)
+                entry = loaded;
+            c = entry;
+        }
+        if (!c->p && !isOptional)
+            throw std::runtime_error("missing " + this->dirname + "/" + name);
+        if (c->n % sizeof(T))
+            throw std::runtime_error("partial element in " + this->dirname + "/" + name);
+        return span<T>((const T *)c->p, c->n / sizeof(T));
+    }
+
+   protected:
+    outputFolder(const outputFolder &) = delete;
+    outputFolder &operator=(const outputFolder &) = delete;
+
+    //* one column: p, n point into file, container or owned
+    struct column_t {
+        column_t() : p(NULL), n(0), file(), owned() {
+        }
+        column_t(const column_t &) = delete;
+        column_t &operator=(const column_t &) = delete;
+        const unsigned char *p;
+        size_t n;
+        std::shared_ptr<mappedFile> file;
+        //* decoded contents (uint64_t for alignment)
+        std::vector<uint64_t> owned;
+    };
+
+    //* plain file, container region, .blk or lossy column. p == NULL if none exists
+    template <class T>
+    std::shared_ptr<column_t> load(const std::string &name) {
+        std::shared_ptr<column_t> retVal = std::make_shared<column_t>();
+        std::map<std::string, std::pair<uint64_t, uint64_t>>::const_iterator it = this->manifest.find(name);
+        if (it != this->manifest.end()) {
+            retVal->p = this->container->data() + it->second.first;
+            retVal->n = (size_t)it->second.second;
+            retVal->file = this->container;
+        } else if (this->hasFile(name)) {
+            retVal->file = std::make_shared<mappedFile>(this->dirname + "/" + name);
+            retVal->p = retVal->file->data();
+            retVal->n = retVal->file->size();
+            if (!retVal->p)
+                retVal->p = (const unsigned char *)"";  // empty file: empty span, not missing
+        } else if (this->hasFile(name + ".blk")) {
+            std::vector<T> vals = stdfooCodec::columnReader<T>(this->dirname + "/" + name + ".blk").readAll();
+            this->own(*retVal, vals.data(), vals.size() * sizeof(T));
+        } else {
+            std::map<std::string, lossy_t>::const_iterator itLossy = this->lossy.find(name);
+            if (itLossy != this->lossy.end()) {
+                std::vector<float> vals = this->decodeLossy(name, itLossy->second);
+                this->own(*retVal, vals.data(), vals.size() * sizeof(float));
+            }
+        }
+        return retVal;
+    }
+
+    static void own(column_t &c, const void *src, size_t nBytes) {
+        c.owned.resize(nBytes / 8 + 1);
+        memcpy(c.owned.data(), src, nBytes);
+        c.p = (const unsigned char *)c.owned.data();
+        c.n = nBytes;
+    }
+
+    //* largest gap between two positions of gather() that is read through, not skipped with another call
+    static const size_t gatherGapBytes = 1 << 15;
+    //* iovecs per preadv call (IOV_MAX on Linux)
+    static const size_t gatherMaxIov = 1024;
+
+    //* where the bytes of an uncompressed column are: a plain file, or its region in the container
+    bool locateRaw(const std::string &name, std::string &fname, uint64_t &offset, uint64_t &nBytes) const {
+        std::map<std::string, std::pair<uint64_t, uint64_t>>::const_iterator it = this->manifest.find(name);
+        if (it != this->manifest.end()) {
+            fname = this->dirname + "/container.stdfoo";
+            offset = it->second.first;
+            nBytes = it->second.second;
+            return true;
+        }
+        std::ifstream probe(this->dirname + "/" + name, std::ifstream::binary | std::ifstream::ate);
+        if (!probe.good())
+            return false;
+        fname = this->dirname + "/" + name;
+        offset = 0;
+        nBytes = (uint64_t)probe.tellg();
+        return true;
+    }
+
+    //* gather() from fname, values starting at byte offset. All positions exist
+    template <class T>
+    static void gatherRaw(const std::string &fname, uint64_t offset, const uint64_t *ix, size_t n, T *dest) {
+        if (n == 0)
+            return;
+#ifndef _WIN32
+        int fd = open(fname.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("failed to open " + fname);
+        std::vector<unsigned char> discard(gatherGapBytes);
+        std::vector<struct iovec> iov;
+        size_t k = 0;
+        while (k < n) {
+            // one call: runs of adjacent positions into dest, short gaps into discard
+            const uint64_t start = ix[k];
+            uint64_t end = start;  // exclusive
+            iov.clear();
+            while ((k < n) && (iov.size() + 2 <= gatherMaxIov)) {
+                if (ix[k] > end) {
+                    const uint64_t gap = (ix[k] - end) * sizeof(T);
+                    if (gap > gatherGapBytes)
+                        break;
+                    iov.push_back(iovec{discard.data(), (size_t)gap});
+                }
+                size_t kEnd = k + 1;
+                while ((kEnd < n) && (ix[kEnd] == ix[kEnd - 1] + 1))
+                    ++kEnd;
+                iov.push_back(iovec{dest + k, (kEnd - k) * sizeof(T)});
+                end = ix[kEnd - 1] + 1;
+                k = kEnd;
+            }
+            if (!preadvAll(fd, iov, offset + start * sizeof(T))) {
+                close(fd);
+                throw std::runtime_error("failed to read " + fname);
+            }
+        }
+        close(fd);
+#else
+        // no preadv: the same ranges, read into a buffer
+        std::ifstream is(fname, std::ifstream::binary);
+        if (!is)
+            throw std::runtime_error("failed to open " + fname);
+        std::vector<T> buf;
+        size_t k = 0;
+        while (k < n) {
+            size_t kEnd = k + 1;
+            while ((kEnd < n) && ((ix[kEnd] - ix[kEnd - 1] - 1) * sizeof(T) <= gatherGapBytes))
+                ++kEnd;
+            buf.resize((size_t)(ix[kEnd - 1] - ix[k] + 1));
+            is.seekg((std::streamoff)(offset + ix[k] * sizeof(T)));
+            if (!is.read((char *)buf.data(), (std::streamsize)(buf.size() * sizeof(T))))
+                throw std::runtime_error("failed to read " + fname);
+            for (size_t j = k; j < kEnd; ++j)
+                dest[j] = buf[(size_t)(ix[j] - ix[k])];
+            k = kEnd;
+        }
+#endif
+    }
+
+#ifndef _WIN32
+    //* preadv of all iov bytes at pos, continuing after short reads. false on error or end of file
+    static bool preadvAll(int fd, std::vector<struct iovec> &iov, uint64_t pos) {
+        size_t ixIov = 0;
+        while (ixIov < iov.size()) {
+            ssize_t nRead = preadv(fd, &iov[ixIov], (int)(iov.size() - ixIov), (off_t)pos);
+            if ((nRead < 0) && (errno == EINTR))
+                continue;
+            if (nRead <= 0)
+                return false;
+            pos += (uint64_t)nRead;
+            for (size_t left = (size_t)nRead; left > 0;) {
+                if (left >= iov[ixIov].iov_len) {
+                    left -= iov[ixIov].iov_len;
+                    ++ixIov;
+                } else {
+                    iov[ixIov].iov_base = (unsigned char *)iov[ixIov].iov_base + left;
+                    iov[ixIov].iov_len -= left;
+                    left = 0;
+                }
+            }
+            while ((ixIov < iov.size()) && (iov[ixIov].iov_len == 0))
+                ++ixIov;
+        }
+        return true;
+    }
+#endif
+
+    bool hasFile(const std::string &name) const {
+        if (this->manifest.count(name))
+            return true;
+        std::ifstream probe(this->dirname + "/" + name, std::ifstream::binary);
+        return probe.good();
+    }
+
+    bitmask bits(uint32_t testnum, const char *kind) {
+        span<uint8_t> bytes = this->column<uint8_t>(std::to_string(testnum) + "." + kind + ".bits");
+        return bitmask::fromBytes(bytes.data(), bytes.size(), (size_t)this->nDutsTotal);
+    }
+
+    enum encoding_e {
+        ENC_MISSING,
+        ENC_RAW,
+        //* block-encoded (STDFooCodec.hpp)
+        ENC_BLK,
+        //* lossy.txt "uint16", "half"
+        ENC_UINT16,
+        ENC_HALF
+    };
+
+    //* a column for block(): the mapped bytes and how to decode them
+    struct stream_t {
+        stream_t() : file(), p(NULL), encoding(ENC_MISSING), elemSize(1), nValues(0), offsets(), offset(0), scale(1) {
+        }
+        stream_t(const stream_t &) = delete;
+        stream_t &operator=(const stream_t &) = delete;
+        //* the column file, or the container
+        std::shared_ptr<mappedFile> file;
+        const unsigned char *p;
+        encoding_e encoding;
+        //* bytes per stored value
+        size_t elemSize;
+        uint64_t nValues;
+        //* ENC_BLK: position of each block, then of the index (end of the last block)
+        std::vector<uint64_t> offsets;
+        //* ENC_UINT16: value = offset + scale * q
+        double offset;
+        double scale;
+    };
+
+    template <class T>
+    std::shared_ptr<stream_t> stream(const std::string &name) {
+        {
+            std::lock_guard<std::mutex> lock(this->m);
+            std::map<std::string, std::shared_ptr<stream_t>>::const_iterator it = this->streams.find(name);
+            if (it != this->streams.end())
+                return it->second;
+        }
+        std::shared_ptr<stream_t> loaded = this->openStream<T>(name);
+        std::lock_guard<std::mutex> lock(this->m);
+        std::shared_ptr<stream_t> &entry = this->streams[name];
+        if (!entry)
+            entry = loaded;
+        return entry;
+    }
+
+    //* maps the column. The index of a .blk column is checked as in stdfooCodec::columnReader
+    template <class T>
+    std::shared_ptr<stream_t> openStream(const std::string &name) {
+        std::shared_ptr<stream_t> retVal = std::make_shared<stream_t>();
+        size_t nBytes = 0;
+        std::map<std::string, std::pair<uint64_t, uint64_t>>::const_iterator it = this->manifest.find(name);
+        std::map<std::string, lossy_t>::const_iterator itLossy = this->lossy.find(name);
+        if (it != this->manifest.end()) {
+            retVal->file = this->container;
+            retVal->p = this->container->data() + it->second.first;
+            nBytes = (size_t)it->second.second;
+            retVal->encoding = ENC_RAW;
+        } else if (this->hasFile(name)) {
+            retVal->file = std::make_shared<mappedFile>(this->dirname + "/" + name);
+            nBytes = retVal->file->size();
+            retVal->encoding = ENC_RAW;
+        } else if (this->hasFile(name + ".blk")) {
+            retVal->file = std::make_shared<mappedFile>(this->dirname + "/" + name + ".blk");
+            nBytes = retVal->file->size();
+            retVal->encoding = ENC_BLK;
+        } else if (itLossy != this->lossy.end()) {
+            const std::string stem = name.substr(0, name.size() - std::string(".float").size());
+            retVal->file = std::make_shared<mappedFile>(this->dirname + "/" + stem + "." + itLossy->second.encoding);
+            nBytes = retVal->file->size();
+            if (itLossy->second.encoding == "uint16")
+                retVal->encoding = ENC_UINT16;
+            else if (itLossy->second.encoding == "half")
+                retVal->encoding = ENC_HALF;
+            else
+                throw std::runtime_error("unsupported encoding " + itLossy->second.encoding + " of " + name);
+            retVal->offset = itLossy->second.offset;
+            retVal->scale = itLossy->second.scale;
+        } else {
+            return retVal;  // missing
+        }
+        if (!retVal->p)
+            retVal->p = retVal->file->data();
+
+        switch (retVal->encoding) {
+            case ENC_RAW:
+                retVal->elemSize = sizeof(T);
+                retVal->nValues = nBytes / sizeof(T);
+                break;
+            case ENC_BLK:
+                this->readBlkIndex<T>(*retVal, nBytes, name);
+                break;
+            default:
+                retVal->elemSize = sizeof(uint16_t);
+                retVal->nValues = nBytes / sizeof(uint16_t);
+        }
+        return retVal;
+    }
+
+    template <class T>
+    void readBlkIndex(stream_t &st, size_t nBytes, const std::string &name) {
+        const unsigned char *p = st.p;
+        uint32_t len = 0;
+        uint64_t nBlocks = 0;
+        if (nBytes >= stdfooCodec::headerSize + stdfooCodec::trailerSize) {
+            memcpy(&len, p + 12, sizeof(len));
+            memcpy(&nBlocks, p + nBytes - stdfooCodec::trailerSize, sizeof(nBlocks));
+            memcpy(&st.nValues, p + nBytes - stdfooCodec::trailerSize + 8, sizeof(st.nValues));
+        }
+        if ((nBytes < stdfooCodec::headerSize + stdfooCodec::trailerSize) || memcmp(p, "STDFooBk", 8) || (p[8] != 1) || (p[9] != sizeof(T)) ||
+            (p[10] != (std::is_floating_point<T>::value ? 1 : 0)) || (len != stdfooCodec::blockLen) || memcmp(p + nBytes - 8, "STDFooBi", 8) ||
+            (nBlocks > nBytes / 8) || (st.nValues > nBlocks * stdfooCodec::blockLen))
+            throw std::runtime_error("not a block-encoded column of the expected type: " + this->dirname + "/" + name + ".blk");
+        uint64_t indexPos = nBytes - stdfooCodec::trailerSize - 8 * nBlocks;
+        if (indexPos < stdfooCodec::headerSize)
+            throw std::runtime_error("corrupt block-encoded column: " + this->dirname + "/" + name + ".blk");
+        st.offsets.resize(nBlocks + 1);
+        memcpy(st.offsets.data(), p + indexPos, nBlocks * 8);
+        st.offsets[nBlocks] = indexPos;
+        for (size_t ix = 0; ix < nBlocks; ++ix)
+            if ((st.offsets[ix] < stdfooCodec::headerSize) || (st.offsets[ix] > st.offsets[ix + 1]))
+                throw std::runtime_error("corrupt block index: " + this->dirname + "/" + name + ".blk");
+        st.elemSize = sizeof(T);
+    }
+
+    //* decodes values first..first+n-1 (all exist) of a .blk column into dest
+    template <class T>
+    static void decodeBlocks(const stream_t &st, uint64_t first, size_t n, T *dest) {
+        T tmp[stdfooCodec::blockLen];
+        while (n > 0) {
+            uint64_t ixBlock = first / stdfooCodec::blockLen;
+            size_t ixInBlock = (size_t)(first % stdfooCodec::blockLen);
+            size_t nCopy = std::min(n, (size_t)stdfooCodec::blockLen - ixInBlock);
+            size_t nExpected = (size_t)std::min((uint64_t)stdfooCodec::blockLen, st.nValues - ixBlock * stdfooCodec::blockLen);
+            T *d = ((ixInBlock == 0) && (nCopy == nExpected)) ? dest : tmp;
+            size_t nDecoded = stdfooCodec::blockDecode<T>::decode(st.p + st.offsets[ixBlock], (size_t)(st.offsets[ixBlock + 1] - st.offsets[ixBlock]), d);
+            if (nDecoded != nExpected)
+                throw std::runtime_error("corrupt block-encoded column: unexpected block length");
+            if (d == tmp)
+                memcpy(dest, tmp + ixInBlock, nCopy * sizeof(T));
+            dest += nCopy;
+            first += nCopy;
+            n -= nCopy;
+        }
+    }
+
+    //* header, manifest of container.stdfoo (see STDFoo.cpp commonLogger::writeContainer)
+    void openContainer() {
+        const std::string fname = this->dirname + "/container.stdfoo";
+        this->container = std::make_shared<mappedFile>(fname);
+        const unsigned char *p = this->container->data();
+        const size_t n = this->container->size();
+        uint32_t version = 0;
+        uint64_t manifestPos = 0;
+        uint64_t manifestSize = 0;
+        if (n >= 48) {
+            memcpy(&version, p + 8, sizeof(version));
+            memcpy(&manifestPos, p + 16, sizeof(manifestPos));
+            memcpy(&manifestSize, p + 24, sizeof(manifestSize));
+        }
+        if ((n < 48) || memcmp(p, "STDFooCt", 8) || (version != 1) || (manifestPos > n) || (manifestSize > n - manifestPos))
+            throw std::runtime_error("not a STDFoo container: " + fname);
+        std::istringstream manifestStr(std::string((const char *)p + manifestPos, (size_t)manifestSize));
+        std::string line;
+        while (std::getline(manifestStr, line)) {
+            std::istringstream fields(line);
+            std::string name;
+            uint64_t pos;
+            uint64_t size;
+            if (!std::getline(fields, name, '\t') || !(fields >> pos >> size) || (pos > n) || (size > n - pos))
+                throw std::runtime_error("corrupt manifest in " + fname);
+            this->manifest[name] = std::make_pair(pos, size);
+        }
+    }
+
+    //* one lossy.txt entry (STDFoo.exe --lossy=BOUND)
+    struct lossy_t {
+        lossy_t() : encoding(), offset(0), scale(1) {
+        }
+        std::string encoding;
+        double offset;
+        double scale;
+    };
+
+    void readLossy() {
+        std::ifstream is(this->dirname + "/lossy.txt", std::ifstream::binary);
+        std::string line;
+        while (std::getline(is, line)) {
+            std::istringstream fields(line);
+            std::string name;
+            lossy_t entry;
+            if (!std::getline(fields, name, '\t') || !std::getline(fields, entry.encoding, '\t') || !(fields >> entry.offset >> entry.scale))
+                throw std::runtime_error("corrupt lossy.txt in " + this->dirname);
+            this->lossy[name] = entry;
+        }
+    }
+
+    //* result column (name "(num).float") from (num).uint16 or (num).half
+    std::vector<float> decodeLossy(const std::string &name, const lossy_t &entry) {
+        const std::string stem = name.substr(0, name.size() - std::string(".float").size());
+        mappedFile f(this->dirname + "/" + stem + "." + entry.encoding);
+        std::vector<uint16_t> q(f.size() / sizeof(uint16_t));
+        if (!q.empty())
+            memcpy(q.data(), f.data(), q.size() * sizeof(uint16_t));
+        std::vector<float> retVal(q.size());
+        if (entry.encoding == "uint16") {
+            for (size_t ix = 0; ix < q.size(); ++ix)
+                retVal[ix] = (q[ix] == 65535) ? NAN : (float)(entry.offset + entry.scale * q[ix]);
+        } else if (entry.encoding == "half") {
+            for (size_t ix = 0; ix < q.size(); ++ix)
+                retVal[ix] = halfToFloat(q[ix]);
+        } else {
+            throw std::runtime_error("unsupported encoding " + entry.encoding + " of " + name);
+        }
+        return retVal;
+    }
+
+    static float halfToFloat(uint16_t h) {
+        uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+        uint32_t exp = (h >> 10) & 0x1F;
+        uint32_t mant = h & 0x3FF;
+        if (exp == 0) {
+            float val = std::ldexp((float)mant, -24);
+            return sign ? -val : val;
+        }
+        uint32_t x = sign | ((exp == 31) ? 0x7F800000 | (mant << 13) : ((exp + 112) << 23) | (mant << 13));
+        float val;
+        memcpy(&val, &x, sizeof(val));
+        return val;
+    }
+
+    const std::string dirname;
+    std::shared_ptr<mappedFile> container;
+    //* container region (offset, size) by name
+    std::map<std::string, std::pair<uint64_t, uint64_t>> manifest;
+    std::map<std::string, lossy_t> lossy;
+    std::map<std::string, std::shared_ptr<column_t>> columns;
+    std::map<std::string, std::shared_ptr<stream_t>> streams;
+    //* protects columns, streams
+    std::mutex m;
+    uint64_t nDutsTotal;
+};
+
+// ===============
+// === queries ===
+// ===============
+//* range check of one test: a DUT passes with lo <= result <= hi
+struct limit {
+    uint32_t testnum;
+    float lo;
+    float hi;
+};
+
+//* limits of all PTR tests from lowLim.float / highLim.float
+static inline std::vector<limit> folderLimits(outputFolder &f) {
+    span<uint32_t> testnums = f.testnums();
+    span<float> lo = f.lowLim();
+    span<float> hi = f.highLim();
+    std::vector<limit> retVal;
+    for (size_t ix = 0; (ix < testnums.size()) && (ix < lo.size()) && (ix < hi.size()); ++ix) {
+        limit l = {testnums[ix], lo[ix], hi[ix]};
+        retVal.push_back(l);
+    }
+    return retVal;
+}
+
+//* DUTs per query task (multiple of 64: tasks write whole mask words). 256 kB per float column
+static const size_t chunkLen = 1 << 16;
+
+/** calls fn(first, n) for consecutive chunks of nDuts, one task per chunk on pool, and waits for all. Rethrows the first exception */
+template <class F>
+static void forEachChunk(uint64_t nDuts, threadPool &pool, F fn) {
+    std::vector<std::future<void>> jobs;
+    for (uint64_t first = 0; first < nDuts; first += chunkLen) {
+        size_t n = (size_t)std::min((uint64_t)chunkLen, nDuts - first);
+        jobs.push_back(pool.submit([fn, first, n] { fn((size_t)first, n); }));
+    }
+    for (auto it = jobs.begin(); it != jobs.end(); ++it)
+        it->get();
+}
+
+/** range check of one chunk of a result column into dest (whole words). Results beyond the end of the column (test without results) are
+ * missing */
+static inline void chunkInRange(span<float> col, size_t first, size_t n, const limit &l, bool nanPasses, uint64_t *dest) {
+    span<float> part = col.subspan(first, n);
+    kernels::inRange(part.data(), part.size(), l.lo, l.hi, nanPasses, dest);
+    const size_t nWords = (n + 63) / 64;
+    if (part.size() < n) {
+        // === missing results ===
+        size_t ixWord = part.size() / 64;
+        uint64_t tail = (part.size() % 64) ? dest[ixWord] : 0;
+        for (size_t ix = ixWord; ix < nWords; ++ix)
+            dest[ix] = nanPasses ? ~(uint64_t)0 : 0;
+        if (part.size() % 64)
+            dest[ixWord] = nanPasses ? (tail | (~(uint64_t)0 << (part.size() % 64))) : tail;
+        if (n % 64)
+            dest[nWords - 1] &= ((uint64_t)1 << (n % 64)) - 1;
+    }
+}
+
+//* maps the result columns of all limits, in parallel (decoding of .blk / lossy columns)
+static inline std::vector<span<float>> resultColumns(outputFolder &f, const std::vector<limit> &limits, threadPool &pool) {
+    std::vector<std::future<span<float>>> jobs;
+    for (auto it = limits.begin(); it != limits.end(); ++it) {
+        uint32_t testnum = it->testnum;
+        jobs.push_back(pool.submit([&f, testnum] { return f.result(testnum); }));
+    }
+    std::vector<span<float>> retVal;
+    for (auto it = jobs.begin(); it != jobs.end(); ++it)
+        retVal.push_back(it->get());
+    return retVal;
+}
+
+/** DUTs that pass all limits. A missing result (NaN, or the test does not exist for the DUT) passes if nanPasses. One task per chunk of DUTs
+ * checks all tests, so the mask chunk stays in cache and the columns are read in parallel */
+static inline bitmask passMask(outputFolder &f, const std::vector<limit> &limits, threadPool &pool, bool nanPasses = true) {
+    std::vector<span<float>> cols = resultColumns(f, limits, pool);
+    bitmask retVal((size_t)f.nDuts(), true);
+    uint64_t *dest = retVal.data();
+    forEachChunk(f.nDuts(), pool, [&](size_t first, size_t n) {
+        std::vector<uint64_t> tmp((n + 63) / 64);
+        for (size_t ix = 0; ix < cols.size(); ++ix) {
+            chunkInRange(cols[ix], first, n, limits[ix], nanPasses, tmp.data());
+            kernels::andInto(dest + first / 64, tmp.data(), tmp.size());
+        }
+    });
+    return retVal;
+}
+
+//* number of DUTs that fail each limit (fail Pareto). Missing results do not fail
+static inline std::vector<uint64_t> failCounts(outputFolder &f, const std::vector<limit> &limits, threadPool &pool) {
+    std::vector<span<float>> cols = resultColumns(f, limits, pool);
+    // === counts per chunk, then summed ===
+    std::vector<std::vector<uint64_t>> byChunk((size_t)((f.nDuts() + chunkLen - 1) / chunkLen));
+    forEachChunk(f.nDuts(), pool, [&](size_t first, size_t n) {
+        std::vector<uint64_t> tmp((n + 63) / 64);
+        std::vector<uint64_t> &counts = byChunk[first / chunkLen];
+        counts.resize(cols.size());
+        for (size_t ix = 0; ix < cols.size(); ++ix) {
+            chunkInRange(cols[ix], first, n, limits[ix], true, tmp.data());
+            counts[ix] = n - kernels::popcount(tmp.data(), tmp.size());
+        }
+    });
+    std::vector<uint64_t> retVal(limits.size(), 0);
+    for (auto it = byChunk.begin(); it != byChunk.end(); ++it)
+        for (size_t ix = 0; ix < it->size(); ++ix)
+            retVal[ix] += (*it)[ix];
+    return retVal;
+}
+}  // namespace stdfooReader
+#endif
@@ -0,0 +1,99 @@
+// benchmark: end-to-end conversion throughput, split into inflate-only and parse/write-only runs. See "make bench"
+// usage: benchConvert.exe [STDFoo.exe options] input.stdf input.stdf.gz scratchfolder
+// input.stdf.gz holds the same data as input.stdf (e.g. both written by synthStdf.exe with the same arguments)
+//   inflate:     decodes input.stdf.gz as the reader thread does (--inflate-jobs applies) and discards it (no parsing, no output)
+//   parse/write: converts input.stdf (read once before, so it comes from the page cache)
+//   end-to-end:  converts input.stdf.gz
+#define STDFOO_NO_MAIN
+#include "../STDFoo.cpp"
+
+#include <chrono>
+
+//* records and DUTs (PRR records) of an uncompressed STDF file
+static void countRecords(const string &filename, uint64_t &nBytes, uint64_t &nRecords, uint64_t &nDuts) {
+    std::ifstream is(filename, std::ifstream::binary);
+    if (!is.is_open())
+        fail("failed to open input file");
+    nBytes = 0;
+    nRecords = 0;
+    nDuts = 0;
+    std::vector<char> body(65536);
+    unsigned char hdr[4];
+    while (is.read((char *)hdr, sizeof(hdr))) {
+        unsigned int REC_LEN = hdr[0] | ((unsigned int)hdr[1] << 8);
+        if (!is.read(body.data(), REC_LEN))
+            break;
+        ++nRecords;
+        if ((hdr[2] == 5) && (hdr[3] == 20))
+            ++nDuts;
+        nBytes += 4 + REC_LEN;
+    }
+}
+
+//* seconds for f()
+template <class F>
+static double timed(F f) {
+    auto tStart = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+}
+
+static void report(const char *what, double t, uint64_t nBytesIn, uint64_t nBytes, uint64_t nRecords, uint64_t nDuts) {
+    const double mb = 1 << 20;
+    cout << what << ": " << t << " s, ";
+    if (nBytesIn != nBytes)
+        cout << nBytesIn / mb / t << " MB/s in, ";
+    cout << nBytes / mb / t << " MB/s STDF, " << (uint64_t)(nRecords / t) << " records/s, " << (uint64_t)(nDuts / t) << " DUTs/s" << endl;
+}
+
+int main(int argc, char **argv) {
+    options opt;
+    int ixArg = opt.parse(argc, argv);
+    if (argc != ixArg + 3) {
+        cerr << "usage: " << argv[0] << " [STDFoo.exe options] input.stdf input.stdf.gz scratchfolder" << endl;
+        return EXIT_FAILURE;
+    }
+    const string plainFile(argv[ixArg]);
+    const string gzFile(argv[ixArg + 1]);
+    const string scratchDir(argv[ixArg + 2]);
+
+    uint64_t nBytes;
+    uint64_t nRecords;
+    uint64_t nDuts;
+    countRecords(plainFile, nBytes, nRecords, nDuts);  // also brings input.stdf into the page cache
+    struct stat st;
+    const uint64_t nBytesGz = (stat(gzFile.c_str(), &st) == 0) ? (uint64_t)st.st_size : 0;
+    cout << plainFile << ": " << nRecords << " records, " << nDuts << " DUTs, " << nBytes << " bytes; " << gzFile << ": " << nBytesGz << " bytes" << endl;
+
+    // === inflate only ===
+    uint64_t nInflated = 0;
+    double tInflate = timed([&] {
+        // same dimensions as convertFiles()
+        blockingCircBuf reader(65600 * 128, 65535 + 4);
+        std::thread consumer([&reader, &nInflated] {
+            unsigned int n;
+            unsigned char *ptr;
+            while (!reader.getLargestPossiblePop(1, &n, &ptr)) {
+                nInflated += n;
+                reader.pop(n);
+            }
+        });
+        main_reader(gzFile, reader, opt);
+        reader.setShutdown(true);
+        consumer.join();
+    });
+    if (nInflated != nBytes)
+        fail("input.stdf.gz does not match input.stdf");
+
+    // === parse / write only, then end to end ===
+    createDirectory(scratchDir);
+    createDirectory(scratchDir + "/plain");
+    createDirectory(scratchDir + "/gz");
+    double tParse = timed([&] { convertFiles(scratchDir + "/plain", std::vector<string>(1, plainFile), opt); });
+    double tAll = timed([&] { convertFiles(scratchDir + "/gz", std::vector<string>(1, gzFile), opt); });
+
+    report("inflate", tInflate, nBytesGz, nBytes, nRecords, nDuts);
+    report("parse/write", tParse, nBytes, nBytes, nRecords, nDuts);
+    report("end-to-end", tAll, nBytesGz, nBytes, nRecords, nDuts);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+// benchmark: throughput of blockingCircBuf between reader and parser thread, without inflate and without output
+// build with -DBLOCKINGCIRCBUF_MUTEX for the reference (mutex / condition variable) implementation. See "make bench"
+// usage: benchRing.exe input.stdf(.gz) [MBytes]
+#define STDFOO_NO_MAIN
+#include "../STDFoo.cpp"
+
+#include <chrono>
+
+//* decodes the complete input file into memory
+static std::vector<unsigned char> loadFile(const string &filename) {
+    options opt;
+    inputFile in(filename);
+    std::unique_ptr<stdfSource> source = openSource(in, opt);
+    std::vector<unsigned char> data;
+    std::vector<unsigned char> chunk(1 << 20);
+    while (true) {
+        size_t n = source->read(chunk.data(), chunk.size());
+        if (n == 0)
+            break;
+        data.insert(data.end(), chunk.begin(), chunk.begin() + n);
+    }
+    return data;
+}
+
+//* record loop of main_writer(), counting records instead of parsing them
+static uint64_t countRecords(blockingCircBuf &reader) {
+    uint64_t nRecords = 0;
+    while (true) {
+        unsigned int nBytesAvailable;
+        unsigned char *ptr;
+        if (reader.getLargestPossiblePop(4, &nBytesAvailable, &ptr))
+            break;
+        unsigned char *ptrCopy = ptr;
+        unsigned int recordSizeWithHeader = decode<uint16_t>(ptrCopy) + 4;
+        while (nBytesAvailable < recordSizeWithHeader)
+            if (reader.getLargestPossiblePop(recordSizeWithHeader, &nBytesAvailable, &ptr))
+                return nRecords;
+        ++nRecords;
+        reader.pop(recordSizeWithHeader);
+    }
+    return nRecords;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "usage: " << argv[0] << " input.stdf(.gz) [MBytes]" << endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<unsigned char> data = loadFile(argv[1]);
+    if (data.size() == 0)
+        fail("empty input file");
+    // small files are fed repeatedly (a file is a sequence of complete records)
+    uint64_t nBytesTarget = (uint64_t)(argc > 2 ? atoi(argv[2]) : 512) << 20;
+    unsigned int nRepeat = (unsigned int)std::max((uint64_t)1, nBytesTarget / data.size());
+
+    // same dimensions as convertFiles()
+    blockingCircBuf reader(65600 * 128, 65535 + 4);
+    auto tStart = std::chrono::steady_clock::now();
+    std::thread producer([&data, &reader, nRepeat] {
+        for (unsigned int ix = 0; ix < nRepeat; ++ix) {
+            // chunk size as for a regular file (plainSource fills whatever is available)
+            if (pushAll(reader, data.data(), data.size()))
+                break;
+        }
+        reader.setShutdown(true);
+    });
+    uint64_t nRecords = countRecords(reader);
+    producer.join();
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+#ifdef BLOCKINGCIRCBUF_MUTEX
+    const char *variant = "mutex";
+#else
+    const char *variant = "lock-free";
+#endif
+    double nMBytes = (double)data.size() * nRepeat / (1 << 20);
+    cout << variant << ": " << nRecords << " records, " << nMBytes << " MB in " << t << " s: "
+         << (uint64_t)(nRecords / t) << " records/s, " << nMBytes / t << " MB/s" << endl;
+    return EXIT_SUCCESS;
+}
@@ -4,13 +4,25 @@ function exampleAndSelftest()
   % convert selftest sample file twice into 'out' folder
   system('STDFoo.exe out testcaseSmall.stdf.gz testcaseSmall.stdf.gz');
 
-  % open handle
-  o = STDFoo('out');
+  % plain .m code, then the native backend if built (make STDFooOct.oct): both must give the same results
+  r = exercise(STDFoo('out', 'm'));
+  if (exist('STDFooOct') == 3)
+    rOct = exercise(STDFoo('out', 'oct'));
+    assert(isequaln(r, rOct), 'STDFooOct.oct results differ from the .m code');
+    STDFoo('out', 'm');
+    disp('STDFooOct.oct gives the same results as the .m code');
+  end
 
+  disp('all tests passed');
+ end
+
+% runs all checks on handle o, returns what was read
+function r = exercise(o)
   n = o.getnDUTs();
   
   data11 = o.DUTs.getResultByTestnum(11);
   assert(size(data11) == [n, 1]);
+  assert(isequaln(o.DUTs.getResultByTestnum(11, 2:2:n), data11(2:2:n))); % index: selected DUTs only
   o.DUTs.uncacheResultByTestnum(11); % use only if cache needs too much memory
   
   data12_13_14 = o.DUTs.getResultByTestnum([12, 13, 14]);
@@ -57,13 +69,27 @@ function exampleAndSelftest()
   
   assert(sum(maskFile1 | maskFile2) == n); % both masks must cover every dut
   assert(sum(maskFile1 & maskFile2) == 0);  % both masks may have no duts in common
+
+  dutsFile2 = o.files.getDutsByFileindex(2); % DUT indices of file2 as range, without a mask
+  assert(isequal(find(maskFile2).', dutsFile2));
+  assert(isequaln(o.DUTs.getResultByTestnum(11, dutsFile2), data11(maskFile2)));
   
   fileindex = o.DUTs.getFileindex();
   assert(sum(fileindex == 1) == sum(maskFile1));
   assert(sum(fileindex == 2) == sum(maskFile2));
+  assert(isequal(o.DUTs.getFileindex(maskFile2), fileindex(maskFile2)));
   
   indexInFile = o.DUTs.getIndexInFile()
   assert(prod(indexInFile == [1:n/2, 1:n/2].') == 1);
-  
-  disp('all tests passed');
+
+  partId = o.DUTs.getPartId();
+  assert(size(partId) == [n, 1]);
+  assert(isequal(o.DUTs.getPartId(2:2:n), partId(2:2:n)));
+  partTxt = o.DUTs.getPartTxt();
+  assert(size(partTxt) == [n, 1]);
+
+  r = struct('data11', data11, 'data12_13_14', data12_13_14, 'sbin', sbin, 'hbin', hbin, 'site', site, 'testnums', testnums, ...
+             'testnames', {testnames}, 'units', {units}, 'lowLim', lowLim, 'highLim', highLim, 'files', {files}, 'dutsPerFile', dutsPerFile, ...
+             'maskFile1', maskFile1, 'maskFile2', maskFile2, 'dutsFile2', dutsFile2, 'fileindex', fileindex, 'indexInFile', indexInFile, ...
+             'partId', {partId}, 'partTxt', {partTxt});
  end
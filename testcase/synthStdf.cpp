@@ -0,0 +1,816 @@
+// synthetic STDF V4 test data without external libraries (compare createTestcase.c, which needs a patched freestdf-libstdf). See "make bench"
+// usage: synthStdf.exe [--duts=N] [--tests=N] [--sites=N] [--mpr=PERCENT] [--pins=N] [--text-len=N] [--id-len=N] [--missing=PERCENT]
+//                      [--seed=N] [--fixed] [--bgzf] output.stdf[.gz]
+// --duts: number of PRR records (default 100000), --tests: TEST_NUMs per DUT (default 500), --sites: DUTs per insertion (default 4)
+// --mpr: share of the tests written as MPR with --pins results (default 0 %, 8 pins), all others as PTR
+// --text-len: length of TEST_TXT (default 40), --id-len: length of PART_ID (default 12)
+// --missing: probability that a DUT skips a test (default 0 %), e.g. a test program branching on earlier results
+// A name ending in .gz writes gzip (single member, dynamic Huffman blocks as gzip writes them), otherwise plain STDF.
+// --fixed: fixed Huffman codes only, --bgzf: BGZF (independent members of 64 kB input as bgzip; for --inflate-jobs)
+// Results are normally distributed within the limits, about 1 % of the DUTs fail a test (TEST_FLG bit 7, softbin > 1).
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "../STDFooInflate.hpp"  // crc32
+
+using std::cerr;
+using std::endl;
+using std::string;
+
+static void fail(const string &msg) {
+    cerr << msg << endl;
+    cerr << "exiting" << endl;
+    exit(EXIT_FAILURE);
+}
+
+// ===============
+// === options ===
+// ===============
+class synthOptions {
+   public:
+    unsigned int nDuts = 100000;
+    unsigned int nTests = 500;
+    unsigned int nSites = 4;
+    unsigned int mprPercent = 0;
+    unsigned int nPins = 8;
+    unsigned int textLen = 40;
+    unsigned int idLen = 12;
+    double missingPercent = 0;
+    unsigned int seed = 1;
+    bool isFixed = false;
+    bool isBgzf = false;
+
+    //* consumes leading "--" switches. Returns the index of the first remaining argument (output file) */
+    int parse(int argc, char **argv) {
+        int ix = 1;
+        for (; (ix < argc) && !string(argv[ix]).compare(0, 2, "--"); ++ix) {
+            string arg(argv[ix]);
+            size_t ixEq = arg.find('=');
+            string key = arg.substr(0, ixEq);
+            string val = (ixEq == string::npos) ? string() : arg.substr(ixEq + 1);
+            bool isValid;
+            if (key == "--duts")
+                isValid = parseUnsigned(val, this->nDuts);
+            else if (key == "--tests")
+                isValid = parseUnsigned(val, this->nTests) && (this->nTests > 0);
+            else if (key == "--sites")
+                isValid = parseUnsigned(val, this->nSites) && (this->nSites > 0) && (this->nSites < 256);
+            else if (key == "--mpr")
+                isValid = parseUnsigned(val, this->mprPercent) && (this->mprPercent <= 100);
+            else if (key == "--pins")
+                isValid = parseUnsigned(val, this->nPins) && (this->nPins > 0) && (this->nPins <= 8000);  // MPR record below 64 kB
+            else if (key == "--text-len")
+                isValid = parseUnsigned(val, this->textLen) && (this->textLen <= 255);
+            else if (key == "--id-len")
+                isValid = parseUnsigned(val, this->idLen) && (this->idLen <= 255);
+            else if (key == "--missing")
+                isValid = parseDouble(val, this->missingPercent) && (this->missingPercent >= 0) && (this->missingPercent <= 100);
+            else if (key == "--seed")
+                isValid = parseUnsigned(val, this->seed);
+            else if ((key == "--fixed") && val.empty())
+                isValid = this->isFixed = true;
+            else if ((key == "--bgzf") && val.empty())
+                isValid = this->isBgzf = true;
+            else
+                isValid = false;
+            if (!isValid)
+                fail("invalid option '" + arg + "'");
+        }
+        return ix;
+    }
+
+   protected:
+    static bool parseUnsigned(const string &str, unsigned int &val) {
+        if (str.empty())
+            return false;
+        char *end;
+        unsigned long tmp = strtoul(str.c_str(), &end, 10);
+        if (*end != 0)
+            return false;
+        val = (unsigned int)tmp;
+        return true;
+    }
+    static bool parseDouble(const string &str, double &val) {
+        char *end;
+        val = strtod(str.c_str(), &end);
+        return !str.empty() && (*end == 0);
+    }
+};
+
+// ======================
+// === deflateEncoder ===
+// ======================
+/** raw deflate stream: greedy LZ77 matches (hash chains over a 32 kB window), blocks of up to blockSymbols symbols with dynamic Huffman
+ * codes (as gzip) or fixed codes. Compresses less than gzip -6 but decodes through the same inflate paths. Output is collected in "out" */
+class deflateEncoder {
+   public:
+    explicit deflateEncoder(bool isDynamic) : isDynamic(isDynamic), win(), head(hashSize, -1), prev(windowSize, -1), syms(), bitBuf(0), nBits(0), out() {
+    }
+
+    void write(const unsigned char *p, size_t n) {
+        this->win.insert(this->win.end(), p, p + n);
+        if (this->winStart + this->win.size() - this->pos >= chunkSize)
+            this->compress(false);
+    }
+
+    //* compresses all pending input, ending with the final block, and pads to a byte boundary
+    void finish() {
+        this->compress(true);
+        if (this->nBits > 0)
+            this->putBits(0, 8 - this->nBits);
+    }
+
+    //* after finish(): the following input starts an independent deflate stream (no matches into earlier data, see compress())
+    void restart() {
+        this->win.clear();
+        this->winStart = this->pos;
+    }
+
+    //* compressed data so far (the caller writes and clears it)
+    std::vector<unsigned char> &getOutput() {
+        return this->out;
+    }
+
+   protected:
+    deflateEncoder(const deflateEncoder &) = delete;
+    deflateEncoder &operator=(const deflateEncoder &) = delete;
+
+    static const size_t windowSize = 32768;
+    static const size_t chunkSize = 1 << 20;
+    static const size_t hashSize = 1 << 15;
+    static const unsigned int maxChain = 16;
+    static const unsigned int minMatch = 3;
+    static const unsigned int maxMatch = 258;
+    //* symbols per block (zlib: 16k .. 64k depending on memLevel)
+    static const size_t blockSymbols = 1 << 15;
+
+    //* literal (dist 0) or match
+    struct symbol {
+        uint16_t litOrLen;
+        uint16_t dist;
+    };
+
+    //* LZ77 over the pending input, except maxMatch bytes of lookahead (unless isLast). Writes full blocks, and the final block if isLast
+    void compress(bool isLast) {
+        // win: [history | pending], starting at absolute position winStart. pos: first pending byte (absolute)
+        const uint64_t end = this->winStart + this->win.size() - (isLast ? 0 : std::min(this->win.size(), (size_t)maxMatch));
+        const unsigned char *w = this->win.data();  // w[absolute position - winStart]
+        const uint64_t o = this->winStart;
+        const uint64_t winEnd = this->winStart + this->win.size();
+        while (this->pos < end) {
+            unsigned int bestLen = 0;
+            uint64_t bestDist = 0;
+            if (this->pos + minMatch <= winEnd) {
+                // note: positions before winStart (e.g. a previous stream, see restart()) end the chain
+                int64_t cand = this->head[hash(w + (this->pos - o))];
+                const unsigned int maxLen = (unsigned int)std::min((uint64_t)maxMatch, winEnd - this->pos);
+                for (unsigned int nChain = 0; (cand >= (int64_t)this->winStart) && (nChain < maxChain); ++nChain) {
+                    const uint64_t dist = this->pos - (uint64_t)cand;
+                    if ((dist == 0) || (dist > windowSize))
+                        break;
+                    unsigned int len = 0;
+                    while ((len < maxLen) && (w[(uint64_t)cand - o + len] == w[this->pos - o + len]))
+                        ++len;
+                    if (len > bestLen) {
+                        bestLen = len;
+                        bestDist = dist;
+                        if (len == maxLen)
+                            break;
+                    }
+                    cand = this->prev[(uint64_t)cand % windowSize];
+                }
+            }
+            unsigned int n = 1;
+            symbol s;
+            if (bestLen >= minMatch) {
+                s.litOrLen = (uint16_t)bestLen;
+                s.dist = (uint16_t)bestDist;
+                n = bestLen;
+            } else {
+                s.litOrLen = w[this->pos - o];
+                s.dist = 0;
+            }
+            this->syms.push_back(s);
+            if (this->syms.size() == blockSymbols)
+                this->writeBlock(false);
+            for (unsigned int ix = 0; ix < n; ++ix, ++this->pos)
+                if (this->pos + minMatch <= winEnd)
+                    this->insert(this->pos);
+        }
+        if (isLast)
+            this->writeBlock(true);
+
+        // keep windowSize bytes of history before pos
+        if (this->pos - this->winStart > windowSize) {
+            const size_t nDrop = (size_t)(this->pos - this->winStart - windowSize);
+            this->win.erase(this->win.begin(), this->win.begin() + (ptrdiff_t)nDrop);
+            this->winStart += nDrop;
+        }
+    }
+
+    static size_t hash(const unsigned char *p) {
+        return (((size_t)p[0] << 10) ^ ((size_t)p[1] << 5) ^ p[2]) & (hashSize - 1);
+    }
+
+    //* absolute position p into the hash chains
+    void insert(uint64_t p) {
+        size_t h = hash(this->win.data() + (p - this->winStart));
+        this->prev[p % windowSize] = this->head[h];
+        this->head[h] = (int64_t)p;
+    }
+
+    // ==============
+    // === blocks ===
+    // ==============
+    //* length code index 0..28 (symbol 257 + index, RFC 1951 3.2.5)
+    static unsigned int lengthIndex(unsigned int len) {
+        unsigned int ix = 28;
+        while (lengthBase()[ix] > len)
+            --ix;
+        return ix;
+    }
+    static const uint16_t *lengthBase() {
+        static const uint16_t base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        return base;
+    }
+    static unsigned int lengthExtra(unsigned int ix) {
+        return ((ix < 8) || (ix == 28)) ? 0 : ix / 4 - 1;
+    }
+    //* distance code 0..29
+    static unsigned int distIndex(unsigned int dist) {
+        unsigned int ix = 29;
+        while (distBase()[ix] > dist)
+            --ix;
+        return ix;
+    }
+    static const uint16_t *distBase() {
+        static const uint16_t base[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        return base;
+    }
+    static unsigned int distExtra(unsigned int ix) {
+        return ix < 4 ? 0 : ix / 2 - 1;
+    }
+
+    /** Huffman code lengths of at most maxLen bits for the given symbol frequencies. At least two symbols get a code (a complete code,
+     * as zlib writes it). If the tree is too deep, frequencies are halved until it fits */
+    static void huffmanLengths(const uint32_t *freq, unsigned int nSymbols, unsigned int maxLen, uint8_t *lengths) {
+        std::vector<uint32_t> f(freq, freq + nSymbols);
+        unsigned int nUsed = 0;
+        for (unsigned int ix = 0; ix < nSymbols; ++ix)
+            nUsed += (f[ix] > 0);
+        for (unsigned int ix = 0; (ix < nSymbols) && (nUsed < 2); ++ix)
+            if (f[ix] == 0) {
+                f[ix] = 1;
+                ++nUsed;
+            }
+        while (true) {
+            // === tree: leaves 0 .. nSymbols - 1, then inner nodes in order of creation (parents after children) ===
+            std::vector<unsigned int> parent(2 * nSymbols, 0);
+            typedef std::pair<uint64_t, unsigned int> node_t;  // weight, node
+            std::priority_queue<node_t, std::vector<node_t>, std::greater<node_t>> q;
+            for (unsigned int ix = 0; ix < nSymbols; ++ix)
+                if (f[ix] > 0)
+                    q.push(node_t(f[ix], ix));
+            unsigned int nNodes = nSymbols;
+            while (q.size() > 1) {
+                node_t a = q.top();
+                q.pop();
+                node_t b = q.top();
+                q.pop();
+                parent[a.second] = parent[b.second] = nNodes;
+                q.push(node_t(a.first + b.first, nNodes++));
+            }
+            std::vector<unsigned int> depth(nNodes, 0);
+            for (unsigned int ix = nNodes - 1; ix-- > 0;)
+                if ((ix >= nSymbols) || (f[ix] > 0))
+                    depth[ix] = depth[parent[ix]] + 1;
+            unsigned int maxDepth = 0;
+            for (unsigned int ix = 0; ix < nSymbols; ++ix) {
+                lengths[ix] = (f[ix] > 0) ? (uint8_t)depth[ix] : 0;
+                maxDepth = std::max(maxDepth, (unsigned int)lengths[ix]);
+            }
+            if (maxDepth <= maxLen)
+                return;
+            for (unsigned int ix = 0; ix < nSymbols; ++ix)
+                if (f[ix] > 0)
+                    f[ix] = (f[ix] + 1) / 2;
+        }
+    }
+
+    //* canonical codes (RFC 1951 3.2.2) from code lengths
+    static void canonicalCodes(const uint8_t *lengths, unsigned int nSymbols, uint16_t *codes) {
+        unsigned int count[16] = {0};
+        for (unsigned int ix = 0; ix < nSymbols; ++ix)
+            ++count[lengths[ix]];
+        count[0] = 0;
+        unsigned int next[16] = {0};
+        unsigned int code = 0;
+        for (unsigned int len = 1; len < 16; ++len) {
+            code = (code + count[len - 1]) << 1;
+            next[len] = code;
+        }
+        for (unsigned int ix = 0; ix < nSymbols; ++ix)
+            codes[ix] = lengths[ix] ? (uint16_t)next[lengths[ix]]++ : 0;
+    }
+
+    //* writes the collected symbols as one block
+    void writeBlock(bool isFinal) {
+        this->putBits(isFinal ? 1 : 0, 1);  // BFINAL
+        uint8_t litLen[288];
+        uint8_t distLen[30];
+        if (!this->isDynamic) {
+            this->putBits(1, 2);  // BTYPE fixed Huffman
+            for (unsigned int ix = 0; ix < 288; ++ix)
+                litLen[ix] = (ix < 144) ? 8 : (ix < 256) ? 9 : (ix < 280) ? 7 : 8;
+            for (unsigned int ix = 0; ix < 30; ++ix)
+                distLen[ix] = 5;
+        } else {
+            this->putBits(2, 2);  // BTYPE dynamic Huffman
+            uint32_t litFreq[286] = {0};
+            uint32_t distFreq[30] = {0};
+            for (auto it = this->syms.begin(); it != this->syms.end(); ++it) {
+                if (it->dist == 0) {
+                    ++litFreq[it->litOrLen];
+                } else {
+                    ++litFreq[257 + lengthIndex(it->litOrLen)];
+                    ++distFreq[distIndex(it->dist)];
+                }
+            }
+            litFreq[256] = 1;  // end of block
+            huffmanLengths(litFreq, 286, 15, litLen);
+            huffmanLengths(distFreq, 30, 15, distLen);
+            this->writeCodeLengths(litLen, distLen);
+        }
+        uint16_t litCode[288];
+        uint16_t distCode[30];
+        canonicalCodes(litLen, this->isDynamic ? 286 : 288, litCode);
+        canonicalCodes(distLen, 30, distCode);
+
+        for (auto it = this->syms.begin(); it != this->syms.end(); ++it) {
+            if (it->dist == 0) {
+                this->putCode(litCode[it->litOrLen], litLen[it->litOrLen]);
+                continue;
+            }
+            unsigned int ixLen = lengthIndex(it->litOrLen);
+            this->putCode(litCode[257 + ixLen], litLen[257 + ixLen]);
+            this->putBits(it->litOrLen - lengthBase()[ixLen], lengthExtra(ixLen));
+            unsigned int ixDist = distIndex(it->dist);
+            this->putCode(distCode[ixDist], distLen[ixDist]);
+            this->putBits(it->dist - distBase()[ixDist], distExtra(ixDist));
+        }
+        this->putCode(litCode[256], litLen[256]);  // end of block
+        this->syms.clear();
+    }
+
+    //* dynamic block header: HLIT, HDIST, HCLEN, code length code, run-length coded code lengths (RFC 1951 3.2.7)
+    void writeCodeLengths(const uint8_t *litLen, const uint8_t *distLen) {
+        static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        unsigned int nLit = 286;
+        while (litLen[nLit - 1] == 0)
+            --nLit;  // stops at end of block (256)
+        unsigned int nDist = 30;
+        while ((nDist > 1) && (distLen[nDist - 1] == 0))
+            --nDist;
+        std::vector<uint8_t> lengths(litLen, litLen + nLit);
+        lengths.insert(lengths.end(), distLen, distLen + nDist);
+
+        // === run-length code: 16 repeats the previous length 3..6 times, 17 / 18 give 3..10 / 11..138 zeros ===
+        std::vector<std::pair<uint8_t, uint8_t>> rle;  // symbol, extra bits value
+        for (size_t ix = 0; ix < lengths.size();) {
+            const uint8_t len = lengths[ix];
+            size_t run = 1;
+            while ((ix + run < lengths.size()) && (lengths[ix + run] == len))
+                ++run;
+            if ((len == 0) && (run >= 3)) {
+                size_t n = std::min(run, (size_t)138);
+                rle.push_back(n >= 11 ? std::make_pair((uint8_t)18, (uint8_t)(n - 11)) : std::make_pair((uint8_t)17, (uint8_t)(n - 3)));
+                ix += n;
+            } else if ((len != 0) && (run >= 4)) {
+                size_t n = std::min(run - 1, (size_t)6);
+                rle.push_back(std::make_pair(len, (uint8_t)0));
+                rle.push_back(std::make_pair((uint8_t)16, (uint8_t)(n - 3)));
+                ix += 1 + n;
+            } else {
+                rle.push_back(std::make_pair(len, (uint8_t)0));
+                ++ix;
+            }
+        }
+        uint32_t clFreq[19] = {0};
+        for (auto it = rle.begin(); it != rle.end(); ++it)
+            ++clFreq[it->first];
+        uint8_t clLen[19];
+        uint16_t clCode[19];
+        huffmanLengths(clFreq, 19, 7, clLen);
+        canonicalCodes(clLen, 19, clCode);
+        unsigned int nCl = 19;
+        while ((nCl > 4) && (clLen[order[nCl - 1]] == 0))
+            --nCl;
+
+        this->putBits(nLit - 257, 5);
+        this->putBits(nDist - 1, 5);
+        this->putBits(nCl - 4, 4);
+        for (unsigned int ix = 0; ix < nCl; ++ix)
+            this->putBits(clLen[order[ix]], 3);
+        static const uint8_t extraBits[19] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 7};
+        for (auto it = rle.begin(); it != rle.end(); ++it) {
+            this->putCode(clCode[it->first], clLen[it->first]);
+            this->putBits(it->second, extraBits[it->first]);
+        }
+    }
+
+    //* code (MSB first, as Huffman codes are defined) of nBits
+    void putCode(unsigned int code, unsigned int n) {
+        unsigned int rev = 0;
+        for (unsigned int ix = 0; ix < n; ++ix)
+            rev |= ((code >> ix) & 1) << (n - 1 - ix);
+        this->putBits(rev, n);
+    }
+
+    //* value (LSB first) of nBits
+    void putBits(uint32_t val, unsigned int n) {
+        this->bitBuf |= (uint64_t)val << this->nBits;
+        this->nBits += n;
+        while (this->nBits >= 8) {
+            this->out.push_back((unsigned char)this->bitBuf);
+            this->bitBuf >>= 8;
+            this->nBits -= 8;
+        }
+    }
+
+    bool isDynamic;
+    //* history and pending input
+    std::vector<unsigned char> win;
+    //* absolute position (bytes since start) of win[0]
+    uint64_t winStart = 0;
+    //* first pending byte, absolute
+    uint64_t pos = 0;
+    //* latest absolute position per hash, -1: none
+    std::vector<int64_t> head;
+    //* previous absolute position with the same hash, by position % windowSize
+    std::vector<int64_t> prev;
+    //* symbols of the current block
+    std::vector<symbol> syms;
+    uint64_t bitBuf;
+    unsigned int nBits;
+    std::vector<unsigned char> out;
+};
+
+// ==================
+// === gzipWriter ===
+// ==================
+/** gzip file: a single member (as gzip), or BGZF (as bgzip): independent members of up to bgzfBlockSize bytes input, each stating its
+ * compressed size (BSIZE in the "BC" extra field), followed by the empty end-of-file member */
+class gzipWriter {
+   public:
+    gzipWriter(FILE *f, bool isDynamic, bool isBgzf) : f(f), isBgzf(isBgzf), enc(isDynamic), pending(), crc(0), isize(0) {
+        if (!isBgzf) {
+            static const unsigned char hdr[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};  // deflate, no name, no mtime, OS unknown
+            this->put(hdr, sizeof(hdr));
+        }
+    }
+
+    void write(const unsigned char *p, size_t n) {
+        if (this->isBgzf) {
+            this->pending.insert(this->pending.end(), p, p + n);
+            size_t done = 0;
+            for (; this->pending.size() - done >= bgzfBlockSize; done += bgzfBlockSize)
+                this->writeMember(this->pending.data() + done, bgzfBlockSize);
+            this->pending.erase(this->pending.begin(), this->pending.begin() + (ptrdiff_t)done);
+            return;
+        }
+        this->crc = stdfooInflate::crc32::update(this->crc, p, n);
+        this->isize += (uint32_t)n;
+        this->enc.write(p, n);
+        this->flushOut();
+    }
+
+    void close() {
+        if (this->isBgzf) {
+            if (!this->pending.empty())
+                this->writeMember(this->pending.data(), this->pending.size());
+            static const unsigned char eofMember[28] = {0x1F, 0x8B, 8, 4, 0, 0, 0, 0, 0, 0xFF, 6, 0, 'B', 'C', 2, 0, 0x1B, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+            this->put(eofMember, sizeof(eofMember));
+            return;
+        }
+        this->enc.finish();
+        this->flushOut();
+        this->putTrailer(this->crc, this->isize);
+    }
+
+   protected:
+    gzipWriter(const gzipWriter &) = delete;
+    gzipWriter &operator=(const gzipWriter &) = delete;
+
+    //* input bytes per BGZF member (as bgzip)
+    static const size_t bgzfBlockSize = 0xFF00;
+
+    void writeMember(const unsigned char *p, size_t n) {
+        this->enc.write(p, n);
+        this->enc.finish();
+        this->enc.restart();
+        std::vector<unsigned char> &data = this->enc.getOutput();
+        if (data.size() > n + 5) {
+            // === incompressible: one stored block ===
+            data.assign(5, 0);
+            data[0] = 1;  // BFINAL, BTYPE stored
+            data[1] = (unsigned char)n;
+            data[2] = (unsigned char)(n >> 8);
+            data[3] = (unsigned char)~n;
+            data[4] = (unsigned char)(~n >> 8);
+            data.insert(data.end(), p, p + n);
+        }
+        const size_t bsize = 18 + data.size() + 8;  // header, deflate data, trailer
+        if (bsize > 65536)
+            fail("BGZF member too large");
+        const unsigned char hdr[18] = {0x1F, 0x8B, 8, 4, 0, 0, 0, 0, 0, 0xFF, 6, 0, 'B', 'C', 2, 0, (unsigned char)(bsize - 1), (unsigned char)((bsize - 1) >> 8)};
+        this->put(hdr, sizeof(hdr));
+        this->flushOut();
+        this->putTrailer(stdfooInflate::crc32::update(0, p, n), (uint32_t)n);
+    }
+
+    //* CRC32 and ISIZE (little endian)
+    void putTrailer(uint32_t crc, uint32_t isize) {
+        unsigned char t[8];
+        for (int ix = 0; ix < 4; ++ix) {
+            t[ix] = (unsigned char)(crc >> (8 * ix));
+            t[4 + ix] = (unsigned char)(isize >> (8 * ix));
+        }
+        this->put(t, sizeof(t));
+    }
+
+    //* writes the encoder's output so far
+    void flushOut() {
+        std::vector<unsigned char> &data = this->enc.getOutput();
+        this->put(data.data(), data.size());
+        data.clear();
+    }
+
+    void put(const unsigned char *p, size_t n) {
+        if ((n > 0) && (fwrite(p, 1, n, this->f) != n))
+            fail("failed to write output file");
+    }
+
+    FILE *f;
+    bool isBgzf;
+    deflateEncoder enc;
+    //* BGZF: input of the next member
+    std::vector<unsigned char> pending;
+    //* single member: CRC32 and ISIZE of all input
+    uint32_t crc;
+    uint32_t isize;
+};
+
+// ==================
+// === stdfWriter ===
+// ==================
+//* builds one record at a time and writes it (plain or gzip)
+class synthRecord {
+   public:
+    synthRecord(FILE *f, bool isGzip, const synthOptions &opt) : f(f), gz(isGzip ? new gzipWriter(f, !opt.isFixed, opt.isBgzf) : NULL), buf(), nRecords(0), nBytes(0) {
+    }
+    ~synthRecord() {
+        delete this->gz;
+    }
+
+    void begin(uint8_t REC_TYP, uint8_t REC_SUB) {
+        this->buf.assign(4, 0);
+        this->buf[2] = REC_TYP;
+        this->buf[3] = REC_SUB;
+    }
+    void u1(uint8_t v) {
+        this->buf.push_back(v);
+    }
+    void u2(uint16_t v) {
+        this->append(&v, sizeof(v));
+    }
+    void u4(uint32_t v) {
+        this->append(&v, sizeof(v));
+    }
+    void r4(float v) {
+        this->append(&v, sizeof(v));
+    }
+    //* STDF string (length byte, characters)
+    void cn(const string &s) {
+        this->u1((uint8_t)s.size());
+        this->append(s.data(), s.size());
+    }
+    void end() {
+        const size_t len = this->buf.size() - 4;
+        if (len > 65535)
+            fail("record too long");
+        this->buf[0] = (unsigned char)len;  // REC_LEN little endian (CPU_TYPE 2)
+        this->buf[1] = (unsigned char)(len >> 8);
+        if (this->gz)
+            this->gz->write(this->buf.data(), this->buf.size());
+        else if (fwrite(this->buf.data(), 1, this->buf.size(), this->f) != this->buf.size())
+            fail("failed to write output file");
+        ++this->nRecords;
+        this->nBytes += this->buf.size();
+    }
+    void close() {
+        if (this->gz)
+            this->gz->close();
+    }
+
+    uint64_t getnRecords() const {
+        return this->nRecords;
+    }
+    uint64_t getnBytes() const {
+        return this->nBytes;
+    }
+
+   protected:
+    synthRecord(const synthRecord &) = delete;
+    synthRecord &operator=(const synthRecord &) = delete;
+
+    void append(const void *p, size_t n) {
+        const unsigned char *c = (const unsigned char *)p;
+        this->buf.insert(this->buf.end(), c, c + n);  // little endian host (as STDFoo.cpp decode())
+    }
+
+    FILE *f;
+    gzipWriter *gz;
+    std::vector<unsigned char> buf;
+    uint64_t nRecords;
+    uint64_t nBytes;
+};
+
+//* xorshift64*, reproducible for a given --seed on every platform
+class synthRandom {
+   public:
+    explicit synthRandom(uint64_t seed) : s(seed * 0x9E3779B97F4A7C15ull + 1) {
+    }
+    uint64_t next() {
+        this->s ^= this->s >> 12;
+        this->s ^= this->s << 25;
+        this->s ^= this->s >> 27;
+        return this->s * 2685821657736338717ull;
+    }
+    //* uniform in [0, 1)
+    double uniform() {
+        return (double)(this->next() >> 11) / 9007199254740992.0;
+    }
+    //* approximately standard normal (sum of 4 uniforms)
+    double normal() {
+        return (this->uniform() + this->uniform() + this->uniform() + this->uniform() - 2.0) * 1.7320508;
+    }
+
+   protected:
+    uint64_t s;
+};
+
+//* string of len characters: prefix, then filled with 'x'
+static string padded(const string &prefix, unsigned int len) {
+    string s = prefix.substr(0, len);
+    s.resize(len, 'x');
+    return s;
+}
+
+int main(int argc, char **argv) {
+    synthOptions opt;
+    int ixArg = opt.parse(argc, argv);
+    if (ixArg + 1 != argc) {
+        cerr << "usage: " << argv[0]
+             << " [--duts=N] [--tests=N] [--sites=N] [--mpr=PERCENT] [--pins=N] [--text-len=N] [--id-len=N] [--missing=PERCENT] [--seed=N] [--fixed] [--bgzf] output.stdf[.gz]" << endl;
+        fail("");
+    }
+    const string fname(argv[ixArg]);
+    const bool isGzip = (fname.size() > 3) && !fname.compare(fname.size() - 3, 3, ".gz");
+    if ((opt.isFixed || opt.isBgzf) && !isGzip)
+        fail("--fixed and --bgzf need an output name ending in .gz");
+    FILE *f = fopen(fname.c_str(), "wb");
+    if (!f)
+        fail("failed to open '" + fname + "' for writing");
+    synthRecord rec(f, isGzip, opt);
+    synthRandom rnd(opt.seed);
+
+    // === per test: TEST_NUM, PTR or MPR (spread evenly), limits ===
+    std::vector<uint32_t> testnums(opt.nTests);
+    std::vector<bool> isMpr(opt.nTests);
+    std::vector<string> texts(opt.nTests);
+    for (unsigned int ix = 0; ix < opt.nTests; ++ix) {
+        testnums[ix] = 1000 + 10 * ix;
+        isMpr[ix] = (ix * opt.mprPercent) / 100 != ((ix + 1) * opt.mprPercent) / 100;
+        texts[ix] = padded("synthetic test " + std::to_string(testnums[ix]) + " ", opt.textLen);
+    }
+    // failing with probability 1 % per DUT across all tests: per test pFail / nTests, as z beyond the limits
+    const double pFailTest = 0.01 / opt.nTests;
+    const double missing = opt.missingPercent / 100.0;
+
+    // === FAR, MIR ===
+    rec.begin(0, 10);
+    rec.u1(2);  // CPU_TYPE
+    rec.u1(4);  // STDF_VER
+    rec.end();
+    rec.begin(1, 10);
+    rec.u4(0);                    // SETUP_T
+    rec.u4(0);                    // START_T
+    rec.u1(1);                    // STAT_NUM
+    rec.u1('P');                  // MODE_COD
+    rec.u1(' ');                  // RTST_COD
+    rec.u1(' ');                  // PROT_COD
+    rec.u2(65535);                // BURN_TIM
+    rec.u1(' ');                  // CMOD_COD
+    rec.cn("SYNTHLOT");           // LOT_ID
+    rec.cn("SYNTHPART");          // PART_TYP
+    rec.cn("synthStdf");          // NODE_NAM
+    rec.cn("synthetic");          // TSTR_TYP
+    rec.cn("synthJob");           // JOB_NAM
+    for (int ix = 0; ix < 19; ++ix)  // JOB_REV ... PROC_ID
+        rec.cn("");
+    rec.end();
+
+    // === insertions of nSites DUTs: PIRs, results site by site, PRRs ===
+    std::vector<uint16_t> softbin(opt.nSites);
+    std::vector<uint16_t> nTested(opt.nSites);
+    uint64_t nDutsDone = 0;
+    while (nDutsDone < opt.nDuts) {
+        const unsigned int nSites = (unsigned int)std::min((uint64_t)opt.nSites, opt.nDuts - nDutsDone);
+        for (unsigned int site = 1; site <= nSites; ++site) {
+            rec.begin(5, 10);
+            rec.u1(1);  // HEAD_NUM
+            rec.u1((uint8_t)site);
+            rec.end();
+            softbin[site - 1] = 1;
+            nTested[site - 1] = 0;
+        }
+        for (unsigned int site = 1; site <= nSites; ++site) {
+            for (unsigned int ixTest = 0; ixTest < opt.nTests; ++ixTest) {
+                if ((missing > 0) && (rnd.uniform() < missing))
+                    continue;
+                ++nTested[site - 1];
+                const float lo = (float)(ixTest % 7);
+                const float hi = lo + 1.0f;
+                // mean in the middle, 6 sigma to the limits, plus rare outliers
+                bool isFail = rnd.uniform() < pFailTest;
+                rec.begin(15, isMpr[ixTest] ? 15 : 10);
+                rec.u4(testnums[ixTest]);
+                rec.u1(1);  // HEAD_NUM
+                rec.u1((uint8_t)site);
+                rec.u1(isFail ? 0x80 : 0);  // TEST_FLG
+                rec.u1(0);                  // PARM_FLG
+                if (isMpr[ixTest]) {
+                    rec.u2(0);  // RTN_ICNT
+                    rec.u2((uint16_t)opt.nPins);
+                    for (unsigned int pin = 0; pin < opt.nPins; ++pin)
+                        rec.r4(lo + 0.5f + (float)(rnd.normal() / 12.0) + (isFail ? 1.0f : 0.0f));
+                } else {
+                    rec.r4(lo + 0.5f + (float)(rnd.normal() / 12.0) + (isFail ? 1.0f : 0.0f));
+                }
+                rec.cn(texts[ixTest]);  // TEST_TXT
+                rec.cn("");             // ALARM_ID
+                rec.u1(0);              // OPT_FLAG
+                rec.u1(0);              // RES_SCAL
+                rec.u1(0);              // LLM_SCAL
+                rec.u1(0);              // HLM_SCAL
+                rec.r4(lo);
+                rec.r4(hi);
+                if (isMpr[ixTest]) {
+                    rec.r4(0);  // START_IN
+                    rec.r4(0);  // INCR_IN
+                }
+                rec.cn("V");  // UNITS
+                rec.end();
+                if (isFail && (softbin[site - 1] == 1))
+                    softbin[site - 1] = (uint16_t)(2 + ixTest % 8);
+            }
+        }
+        for (unsigned int site = 1; site <= nSites; ++site) {
+            rec.begin(5, 20);
+            rec.u1(1);  // HEAD_NUM
+            rec.u1((uint8_t)site);
+            rec.u1(softbin[site - 1] == 1 ? 0 : 8);  // PART_FLG: bit 3 failed
+            rec.u2(nTested[site - 1]);
+            rec.u2(softbin[site - 1] == 1 ? 1 : 2);  // HARD_BIN
+            rec.u2(softbin[site - 1]);
+            rec.u2(65535);  // X_COORD (invalid)
+            rec.u2(65535);  // Y_COORD
+            rec.u4(0);      // TEST_T
+            rec.cn(padded("ID" + std::to_string(nDutsDone + site) + "_", opt.idLen));
+            rec.cn("");  // PART_TXT
+            rec.u1(0);   // PART_FIX
+            rec.end();
+        }
+        nDutsDone += nSites;
+    }
+
+    // === MRR ===
+    rec.begin(1, 20);
+    rec.u4(0);  // FINISH_T
+    rec.end();
+    rec.close();
+    if (fclose(f) != 0)
+        fail("failed to write '" + fname + "'");
+    cerr << fname << ": " << nDutsDone << " DUTs, " << rec.getnRecords() << " records, " << rec.getnBytes() << " bytes STDF" << endl;
+    return EXIT_SUCCESS;
+}